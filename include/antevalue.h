@@ -5,6 +5,7 @@
 #include <vector>
 #include <nodevisitor.h>
 #include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/DenseSet.h>
 #include "typedvalue.h"
 #include "error.h"
 #include "parser.h"
@@ -119,7 +120,7 @@ namespace ante {
 
         /** Pseudo var table used for tracking which variables are declared inside and
          * which are declared outisde the given expression. */
-        std::vector<std::unordered_set<std::string>> varTable;
+        std::vector<llvm::DenseSet<Symbol>> varTable;
 
         /** External bindings (the minimal environment) the expression needs to run */
         std::vector<std::tuple<std::string, AnType*, parser::Node*>> dependencies;
@@ -143,12 +144,12 @@ namespace ante {
             n->accept(v);
         }
 
-        bool isDeclaredInternally(std::string const& var) const;
+        bool isDeclaredInternally(Symbol var) const;
 
         /** Visit a declaration external to the ante expression. */
         void visitExternalDecl(std::string const& name, AnType *type, parser::Node *decl);
 
-        void declare(std::string const& var);
+        void declare(Symbol var);
 
         void newScope();
 
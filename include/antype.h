@@ -6,9 +6,15 @@
 #include <memory>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <mutex>
 
 #include <llvm/IR/Module.h>
 #include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/Support/Allocator.h>
 
 #include "tokens.h"
 #include "parser.h"
@@ -33,6 +39,14 @@ namespace ante {
 
     struct TraitImpl;
 
+    /** Which generation of the AnTypeContainer a type belongs to.
+     *  See AnTypeContainer::openNursery */
+    enum TypeGeneration : unsigned char {
+        TG_Persistent,
+        TG_Nursery,
+        TG_Promoted,
+    };
+
     /** A primitive type
      *
      *  All AnTypes are uniqued and immutable.  Instances are created via
@@ -54,6 +68,26 @@ namespace ante {
         AnType(TypeTag id, bool ig) :
             typeTag(id), isGeneric(ig){}
 
+        /** Hash of this type's structure, computed once when it is interned.
+         *  Types which are not interned by the AnTypeContainer leave this as 0. */
+        size_t structuralHash = 0;
+
+        /** Types created while the AnTypeContainer's nursery is open
+         *  start in TG_Nursery and are freed when it is collected
+         *  unless they were promoted first. */
+        TypeGeneration generation = TG_Persistent;
+
+        /** Every distinct typevar contained within this type, ordered by id.
+         *  Data types are summarized by the typevars within their typeArgs. */
+        llvm::SmallVector<AnTypeVarType*, 2> containedTypeVars;
+
+        /** Bloom filter of the typevars in containedTypeVars with bit (id % 64) set for each */
+        uint64_t typeVarMask = 0;
+
+        /** Add each typevar contained within t to this type's summary */
+        void addContainedTypeVars(const AnType *t);
+        void addContainedTypeVars(std::vector<AnType*> const& types);
+
     public:
 
         virtual ~AnType() = default;
@@ -105,6 +139,15 @@ namespace ante {
         /** Shortcut for casting to an AnTypeVarType and calling AnTypeVarType::isRhoVar */
         bool isRhoVar() const;
 
+        /** Every distinct typevar contained within this type, computed once when it is created. */
+        llvm::ArrayRef<AnTypeVarType*> getContainedTypeVars() const {
+            return containedTypeVars;
+        }
+
+        /** True if tv is contained within this type.  Types which do not
+         *  contain tv are usually rejected by the bloom filter alone. */
+        bool containsTypeVar(const AnTypeVarType *tv) const;
+
         static AnType* getPrimitive(TypeTag tag);
         static AnType* getI8();
         static AnType* getI16();
@@ -348,20 +391,41 @@ namespace ante {
     };
 
     /** A Typevar type.
-     *  Typevar types are always generic. */
+     *  Typevar types are always generic.
+     *
+     *  Each typevar is identified by a dense integer id which indexes into
+     *  the AnTypeContainer.  Typevars created via nextTypeVar are unnamed
+     *  until getName is called, which is usually only needed when the
+     *  typevar is shown in a diagnostic. */
     class AnTypeVarType : public AnType {
+        friend AnTypeContainer;
+
         protected:
-        AnTypeVarType(std::string const& n) :
-            AnType(TT_TypeVar, true), name(n){}
+        AnTypeVarType(size_t id, std::string const& n, bool isRho) :
+            AnType(TT_TypeVar, true), name(n), id(id), rho(isRho){}
+
+        /** The name of this typevar, or "" if it is an unnamed typevar whose name was never requested */
+        mutable std::string name;
 
         public:
 
         ~AnTypeVarType() = default;
 
-        std::string name;
+        /** This typevar's index within the AnTypeContainer */
+        const size_t id;
+
+        /** True if this is a rho (row) variable, eg. 'a... */
+        const bool rho;
+
+        /** Returns the name of this typevar, creating one from its id if it does not have one. */
+        std::string const& getName() const;
 
+        /** Returns the typevar with the given name, creating it if it does not exist. */
         static AnTypeVarType* get(std::string const& name);
 
+        /** Create a new unnamed typevar */
+        static AnTypeVarType* getFresh(bool isRhoVar = false);
+
         /** Returns a version of the current type with an additional modifier m. */
         const AnType* addModifier(TokenType m) const override;
 
@@ -370,9 +434,7 @@ namespace ante {
         }
 
         bool isRhoVar() const noexcept {
-            size_t len = name.size();
-            // Using string::find would be more terse but would needlessly check the whole string
-            return len > 3 && name[len-3] == '.' && name[len-2] == '.' && name[len-1] == '.';
+            return rho;
         }
 
         static bool istype(const AnType *t){
@@ -534,7 +596,7 @@ namespace ante {
         * @param field Name of the field to search for
         * @return The index of the field on success, -1 on failure
         */
-        int getFieldIndex(std::string const& field) const {
+        int getFieldIndex(llvm::StringRef field) const {
             for(unsigned int i = 0; i < fields.size(); i++)
                 if(field == fieldNames[i])
                     return i;
@@ -628,7 +690,8 @@ namespace ante {
         }
 
         /** Search for a data type generic variant by name.
-         * Returns it if found, or creates it otherwise. */
+         * Returns it if found, or creates it otherwise.
+         * Any of elems without a parentUnionType are bound to the returned variant. */
         static AnSumType* createVariant(AnSumType *parent,
                 std::vector<AnProductType*> const& elems, TypeArgs const& generics);
 
@@ -691,9 +754,17 @@ namespace ante {
      *  of this class would be meaningless as the AnTypeContainer
      *  referenced by each AnType is unable to be swapped out.
      *
-     *  Use of hashing to unique each AnType can also be quite inefficient
-     *  since most AnTypes will have short lifetimes in practice.  Future
-     *  optimizations can likely be made on the allocation patterns here.
+     *  Interned types and typevars are bump-allocated from a single arena
+     *  and are only freed when the container itself is destroyed.  Every
+     *  structural type is uniqued through one open-addressing table keyed
+     *  by the structuralHash stored in each node, so looking up a type
+     *  which already exists costs one probe and never allocates.
+     *
+     *  Most types only live for the inference of a single module or REPL
+     *  line though.  Long-running clients may open a nursery before such
+     *  a unit of work: every type created while it is open is allocated
+     *  separately and freed by collectNursery unless it was promoted to
+     *  the persistent generation first.
      */
     class AnTypeContainer {
         friend AnType;
@@ -704,22 +775,205 @@ namespace ante {
         friend AnPtrType;
         friend AnTypeVarType;
         friend AnFunctionType;
-
-        using FnTypeKey = std::pair<AnType*, std::pair<std::vector<AnType*>, std::pair<std::vector<TraitImpl*>, bool>>>;
-        using AggTypeKey = std::vector<AnType*>;
+        friend AnProductType;
+        friend AnSumType;
+
+        /** Which get function interned a type.  This is needed in addition to
+         *  the typeTag since modifiers share the typeTag of the type they modify. */
+        enum InternKind : unsigned char {
+            IK_BasicModifier = 1,
+            IK_DirectiveModifier,
+            IK_Ptr,
+            IK_Array,
+            IK_Tuple,
+            IK_Function,
+        };
+
+        /** An entry in the intern table.  Empty slots have a null type. */
+        struct InternSlot {
+            AnType *type;
+            InternKind kind;
+        };
 
         std::unordered_map<TypeTag, std::unique_ptr<AnType>> primitiveTypes;
-        std::unordered_map<std::pair<AnType*, TokenType>, std::unique_ptr<AnModifier>> basicModifiers;
-        std::unordered_map<std::pair<AnType*, size_t>, std::unique_ptr<AnModifier>> cdModifiers;
-        std::unordered_map<AnType*, std::unique_ptr<AnPtrType>> ptrTypes;
-        std::unordered_map<std::pair<AnType*, size_t>, std::unique_ptr<AnArrayType>> arrayTypes;
-        std::unordered_map<std::string, std::unique_ptr<AnTypeVarType>> typeVarTypes;
-        std::unordered_map<AggTypeKey, std::unique_ptr<AnTupleType>> aggregateTypes;
-        std::unordered_map<FnTypeKey, std::unique_ptr<AnFunctionType>> functionTypes;
+
+        /**
+         * One stripe of the intern table.  Each type is stored in the shard
+         * selected by its structuralHash and every access to a shard holds
+         * its mutex, so unrelated types can be interned from several threads.
+         */
+        struct InternShard {
+            std::mutex mutex;
+
+            /** Backing memory for the types of this shard and for some typevars */
+            llvm::BumpPtrAllocator allocator;
+
+            /** Linearly-probed table of every type in this shard.  Its size is always a power of 2. */
+            std::vector<InternSlot> table;
+            size_t count = 0;
+
+            /** Every type of this shard created while the nursery was open */
+            std::vector<AnType*> nursery;
+        };
+
+        static const size_t internShardCount = 16;
+
+        std::array<InternShard, internShardCount> shards;
+
+        /** Guards typeVarTypes and typeVarNames */
+        std::mutex typeVarMutex;
+
+        /** Guards the genericVariants of every data type */
+        std::mutex variantMutex;
+
+        /** Every typevar, indexed by AnTypeVarType::id.  While concurrent, each
+         *  thread reserves a block of ids at a time and fills in its block
+         *  when flushTypeVars is called. */
+        std::vector<AnTypeVarType*> typeVarTypes;
+
+        /** Each named typevar.  Unnamed typevars are added once they are given a name. */
+        std::unordered_map<std::string, AnTypeVarType*> typeVarNames;
+
+        /** True between calls to beginConcurrent and endConcurrent */
+        bool concurrent;
+
+        /** Incremented by each call to beginConcurrent so threads can tell
+         *  their reserved typevar ids are from an earlier concurrent section. */
+        size_t concurrentSection;
+
+        /** True between calls to openNursery and collectNursery */
+        bool nurseryOpen;
+
+        /** The first id of any typevar created while the nursery was open */
+        size_t nurseryTypeVarStart;
+
+        /** Data types already traversed by promote since the last collection.
+         *  Data types are never freed by the container but may still refer to
+         *  nursery types since they are mutated after their creation. */
+        std::unordered_set<AnDataType*> promotedDataTypes;
+
+        /** Returns uninitialized memory for a T from the given shard, whose
+         *  mutex must be held.  The caller is expected to placement-new the
+         *  type into it and then pass it to adopt.
+         *  Nursery types are allocated individually so they can be freed. */
+        template<typename T>
+        void* allocate(InternShard &shard){
+            if(nurseryOpen)
+                return ::operator new(sizeof(T));
+            return shard.allocator.Allocate<T>();
+        }
+
+        /** Assign a newly-allocated type to the current generation */
+        void adopt(AnType *type){
+            if(nurseryOpen)
+                type->generation = TG_Nursery;
+        }
+
+        /** Destroy the given type and free it if it was not arena-allocated */
+        void release(AnType *type);
+
+        /** Remove the given type from the intern table */
+        void erase(AnType *type);
+
+        /** Most hashes are derived from pointers whose low bits are always 0
+         *  so they are mixed before selecting a shard or slot to avoid clustering. */
+        static size_t mix(size_t hash){
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdULL;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        /** The shard a type with the given structuralHash is interned in.  The top 4 bits
+         *  of the mixed hash select one of the 16 shards and the low bits select its slot. */
+        InternShard& shardOf(size_t hash){
+            return shards[mix(hash) >> (sizeof(size_t) * 8 - 4)];
+        }
+
+        /** Maps a structuralHash to its preferred slot in the shard's table */
+        static size_t slotOf(InternShard const& shard, size_t hash){
+            return mix(hash) & (shard.table.size() - 1);
+        }
+
+        /** Doubles the size of the shard's table, rehashing every type using
+         *  the structuralHash already stored within it. */
+        void grow(InternShard &shard);
+
+        /** Searches the shard for a type of the given kind and hash
+         *  for which isEqual returns true.  If none is found nullptr is
+         *  returned and slot is set to the index the new type should be
+         *  inserted at via insert.  The shard's mutex must be held until
+         *  the new type is inserted. */
+        template<typename T, typename Eq>
+        T* lookup(InternShard &shard, InternKind kind, size_t hash, Eq isEqual, size_t &slot){
+            if((shard.count + 1) * 4 > shard.table.size() * 3)
+                grow(shard);
+
+            size_t mask = shard.table.size() - 1;
+            for(size_t i = slotOf(shard, hash);; i = (i + 1) & mask){
+                InternSlot &entry = shard.table[i];
+                if(!entry.type){
+                    slot = i;
+                    return nullptr;
+                }
+                if(entry.kind == kind && entry.type->structuralHash == hash
+                        && isEqual(static_cast<T*>(entry.type)))
+                    return static_cast<T*>(entry.type);
+            }
+        }
+
+        /** Stores a newly created type in the slot returned by a failed lookup */
+        template<typename T>
+        T* insert(InternShard &shard, size_t slot, InternKind kind, size_t hash, T *type){
+            type->structuralHash = hash;
+            shard.table[slot] = {type, kind};
+            shard.count++;
+            adopt(type);
+            if(nurseryOpen)
+                shard.nursery.push_back(type);
+            return type;
+        }
+
+        /** Returns the id for a new unnamed typevar.  While concurrent the id
+         *  comes from a block reserved by the current thread, otherwise the
+         *  typevar is expected to be pushed onto typeVarTypes directly. */
+        size_t nextTypeVarId();
+
+        /** Store a newly created unnamed typevar under its id */
+        void registerTypeVar(AnTypeVarType *tvar);
 
     public:
         AnTypeContainer();
-        ~AnTypeContainer() = default;
+        ~AnTypeContainer();
+
+        /** Begin allocating every new type in the nursery */
+        void openNursery();
+
+        /** Move the given type and any nursery types reachable from it
+         *  into the persistent generation so they survive collectNursery.
+         *  Does nothing while the nursery is closed. */
+        void promote(AnType *type);
+
+        /** Promote the type arguments of the given trait */
+        void promote(TraitImpl *trait);
+
+        /** Free every nursery type which was not promoted and close the nursery. */
+        void collectNursery();
+
+        bool isNurseryOpen() const noexcept {
+            return nurseryOpen;
+        }
+
+        /** Allow types to be created from several threads at once until endConcurrent.
+         *  The nursery must not be open while concurrent. */
+        void beginConcurrent();
+
+        /** Store each typevar the current thread created since it last flushed
+         *  into typeVarTypes.  Each thread must flush before the concurrent
+         *  section ends. */
+        void flushTypeVars();
+
+        void endConcurrent();
     };
 }
 
@@ -17,6 +17,7 @@ namespace ante {
         EmitLLVM,
         Eval,
         Help,
+        Jobs,
         Lib,
         NoColor,
         OptLvl,
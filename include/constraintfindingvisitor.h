@@ -45,7 +45,7 @@ namespace ante {
              *  as a separate constraint.  Returns a new type with type classes removed. */
             AnType* handleTypeClassConstraints(AnType *t, LOC_TY const& loc);
 
-            bool findFieldInTypeList(llvm::StringMap<TypeDecl> const& m, parser::BinOpNode *op, parser::VarNode *rval);
+            bool findFieldInTypeList(llvm::DenseMap<Symbol, TypeDecl> const& m, parser::BinOpNode *op, parser::VarNode *rval);
 
             void searchForField(parser::BinOpNode *op);
 
@@ -7,7 +7,9 @@ namespace ante { namespace parser { struct Node; } }
 #endif
 
 #include "yyparser.h"
+#include "sourcelocation.h"
 #include "lazystr.h"
+#include <sstream>
 
 namespace ante {
 
@@ -24,18 +26,32 @@ namespace ante {
     struct TypeVarError : public CtError {};
 
     /** General error function.  Show an error and the line it is on, and throw an exception. */
-    void error(const char* msg, const yy::location& loc, ErrorType t = ErrorType::Error);
+    void error(const char* msg, const SourceRange& loc, ErrorType t = ErrorType::Error);
 
-    void error(lazy_printer msg, const yy::location& loc, ErrorType t = ErrorType::Error);
+    void error(lazy_printer msg, const SourceRange& loc, ErrorType t = ErrorType::Error);
 
     /** Show an error and the line it is on, but do not throw an exception. */
-    void showError(lazy_printer msg, const yy::location& loc, ErrorType t = ErrorType::Error);
+    void showError(lazy_printer msg, const SourceRange& loc, ErrorType t = ErrorType::Error);
+
+    /** Holds the diagnostics issued by one task so they can be shown later
+     *  in a deterministic order, e.g. while type checking in parallel. */
+    struct DiagnosticBuffer {
+        std::ostringstream out;
+    };
+
+    /** Write every diagnostic issued on the current thread into the given
+     *  buffer, or directly to stdout if it is null. */
+    void setDiagnosticBuffer(DiagnosticBuffer *buffer);
+
+    /** Print the contents of the buffer to the current thread's
+     *  diagnostics (see setDiagnosticBuffer) and empty it */
+    void flushDiagnosticBuffer(DiagnosticBuffer &buffer);
 
     /** Return the number of errors issued, omitting warnings and notes */
     size_t errorCount();
 
-    /** Return an empty yy::location for when the error location is unknown or internal */
-    yy::location unknownLoc();
+    /** Return an empty SourceRange for when the error location is unknown or internal */
+    SourceRange unknownLoc();
 }
 
 #endif
@@ -0,0 +1,97 @@
+#ifndef AN_FLATAST_H
+#define AN_FLATAST_H
+
+#include "parser.h"
+#include <llvm/ADT/BitVector.h>
+#include <cstdint>
+#include <vector>
+
+namespace ante {
+    namespace parser {
+
+        /** The index of a Node within a FlatAst */
+        using NodeId = uint32_t;
+
+        /**
+         * A flattened view of the expressions of an AST, for passes which
+         * only need to look at each node once rather than in tree order.
+         *
+         * Nodes are numbered breadth first from the root, so the children
+         * of each node have consecutive ids and every array below can be
+         * walked linearly instead of chasing pointers through the tree.
+         * The tree itself is left untouched and still owns its nodes.
+         *
+         * Only the edges to expressions whose types are inferred are followed:
+         * declarations within a DataDeclNode, TraitNode, or ImportNode and the
+         * parameters of a TypeNode are left out.  Functions and extensions
+         * are type checked separately from the rest of their module, so
+         * a RootNode's funcs and extensions are left out as well.
+         *
+         * The type of each node is copied into a dense array when flattened.
+         * Changes to it are only visible to the tree after storeTypes.
+         */
+        class FlatAst {
+        public:
+            /** The parent of the root */
+            static const NodeId noParent = UINT32_MAX;
+
+            explicit FlatAst(Node *root);
+
+            /** The number of nodes flattened */
+            NodeId size() const noexcept {
+                return nodes.size();
+            }
+
+            NodeKind getKind(NodeId id) const noexcept {
+                return kinds[id];
+            }
+
+            Node* getNode(NodeId id) const noexcept {
+                return nodes[id];
+            }
+
+            NodeId getParent(NodeId id) const noexcept {
+                return parents[id];
+            }
+
+            /** The id of the first child of the given node */
+            NodeId childrenBegin(NodeId id) const noexcept {
+                return firstChild[id];
+            }
+
+            /** One past the id of the last child of the given node */
+            NodeId childrenEnd(NodeId id) const noexcept {
+                return firstChild[id + 1];
+            }
+
+            AnType* getType(NodeId id) const noexcept {
+                return types[id];
+            }
+
+            void setType(NodeId id, AnType *type){
+                if(type != types[id]){
+                    types[id] = type;
+                    modified.set(id);
+                }
+            }
+
+            /** Copy each type changed through setType back to its Node */
+            void storeTypes();
+
+        private:
+            std::vector<NodeKind> kinds;
+            std::vector<Node*> nodes;
+            std::vector<NodeId> parents;
+
+            /** Children of node i are in [firstChild[i], firstChild[i+1]) */
+            std::vector<NodeId> firstChild;
+
+            std::vector<AnType*> types;
+
+            /** The nodes whose type was changed since flattening */
+            llvm::BitVector modified;
+        };
+    }
+}
+
+#endif /* end of include guard: AN_FLATAST_H */
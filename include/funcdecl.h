@@ -29,6 +29,11 @@ namespace ante {
         /** True if this is a decl from a trait, used as a flag to swap with impl later */
         bool traitFuncDecl = false;
 
+        /** Each function referenced within this function's body, including within
+         *  any lambdas it contains.  Filled in during name resolution and used to
+         *  infer functions in the order of the call graph.  May contain duplicates. */
+        std::vector<FuncDecl*> callees;
+
         parser::FuncDeclNode* getFDN() const noexcept {
             return static_cast<parser::FuncDeclNode*>(this->definition);
         }
@@ -48,7 +53,7 @@ namespace ante {
          * This indicates the function is extern and (usually) C FFI.
          */
         bool isDecl() const noexcept {
-            return getFDN()->name.back() == ';' || this->name == getFDN()->name;
+            return getFDN()->name.ref().back() == ';' || getFDN()->name.ref() == this->name;
         }
 
         virtual bool isFuncDecl() const override {
@@ -22,38 +22,43 @@ namespace ante { namespace parser { struct Node; } }
 namespace ante{
     extern bool colored_output;
 
+    class SourceBuffer;
+
     class Lexer{
     public:
-        std::string *fileName;
+        /* Lex the named file, or stdin if fileName is null */
+        Lexer(const std::string* fileName);
+
+        /* Lex an already loaded buffer */
+        Lexer(SourceBuffer *source, bool printInput = false);
 
-        Lexer(std::string* fileName);
-        Lexer(std::string* fileName, std::string& pseudoFile,
-                unsigned int rowOffset, unsigned int colOffset,
-                bool printInput = false);
+        /* Lex a string which is never parsed, eg. REPL input that is only
+         * being highlighted.  Its tokens are all given unknown locations. */
+        Lexer(std::string& pseudoFile, bool printInput = false);
         ~Lexer();
         int next(yy::parser::location_type* yyloc);
         char peek() const;
 
+        /* The buffer being lexed, or null for a pseudo-file */
+        SourceBuffer* getSource() const;
+
+        /* Text of the last identifier, type, or literal token lexed */
+        char* getText() const;
+
         static void printTok(int t);
         static std::string getTokStr(int t);
 
         unsigned int getManualScopeLevel() const;
 
     private:
-        /* the ifstream to take from */
-        std::istream *in;
-
-        /* If this is set to true then the psuedoFile string should be parsed
-         * as a string containing ante src code.  Used for Str interpolation */
-        bool isPseudoFile;
-        char* pseudoFile;
-
-        /* Row and column number */
-        unsigned int row, col;
+        /* The buffer being lexed, used to give each token its SourceLoc.
+         * This is null when lexing a pseudo-file. */
+        SourceBuffer *source;
 
-        /* Offset given if lexer starts in the middle of a file */
-        /* Used when lexing string interpolations */
-        const unsigned int rowOffset, colOffset;
+        /* The next character to be read into nxt.  Points into either
+         * the SourceBuffer being lexed or a null-terminated pseudo-file
+         * string.  Scanning stops at the null terminator. */
+        const char *pos;
 
         /* Current and next characters */
         char cur, nxt;
@@ -90,13 +95,27 @@ namespace ante{
          */
         bool printInput;
 
+        /* Raw text to store identifiers and usertypes in */
+        char *lextxt = nullptr;
+
         void lexErr(const char *msg, yy::parser::location_type* loc);
 
         void incPos(void);
         void incPos(int end);
-        yy::position getPos(bool inclusiveEnd = true) const;
+
+        /* Returns the position of cur within the buffer.  Only valid while cur != '\0' */
+        const char* curPos() const;
+
+        /* Advance until cur is at the given position, which must be on the
+         * same line and no further than the terminator.  If print is set the
+         * skipped characters are printed when printInput is. */
+        void skipTo(const char *end, bool print = true);
+
+        /* The location of cur, or of the character before it if !inclusiveEnd */
+        SourceLoc getPos(bool inclusiveEnd = true) const;
 
         void setlextxt(std::string &str);
+        void setlextxt(const char *begin, const char *end);
         int handleComment(yy::parser::location_type* loc);
         int handlePossibleScopeChange();
         int genEndOfInputTok();
@@ -111,8 +130,4 @@ namespace ante{
     };
 }
 
-
-extern ante::Lexer *yylexer;
-void setLexer(ante::Lexer *l);
-
 #endif
@@ -0,0 +1,46 @@
+#ifndef AN_LEXERKERNELS_H
+#define AN_LEXERKERNELS_H
+
+#include <vector>
+
+namespace ante {
+
+    /**
+     * Routines the Lexer uses to skip over runs of characters it would
+     * otherwise classify one at a time.  Each takes a pointer into a
+     * null-terminated buffer and returns a pointer to the first character
+     * that ends the run, which may be the terminator itself.
+     *
+     * The SSE2 and AVX2 versions test 16 or 32 characters at a time.  They
+     * only ever load whole aligned blocks so they never read past the page
+     * holding the terminator.
+     */
+    struct LexerKernels {
+        const char *name;
+
+        /** Returns the first character not in [A-Za-z0-9_] */
+        const char* (*scanIdentifier)(const char *p);
+
+        /** Returns the first character that is not a space */
+        const char* (*scanSpaces)(const char *p);
+
+        /** Returns the first '\n' or '\0' */
+        const char* (*scanLineEnd)(const char *p);
+
+        /** Returns the first '"', '\\', '\n', or '\0' */
+        const char* (*scanStrLit)(const char *p);
+
+        static const LexerKernels scalar;
+
+        /** The widest kernels supported by the current cpu */
+        static const LexerKernels& native();
+
+        /** Every set of kernels supported by the current cpu, narrowest first */
+        static std::vector<const LexerKernels*> supported();
+    };
+
+    /** The kernels used by every Lexer, LexerKernels::native() by default */
+    extern const LexerKernels *lexerKernels;
+}
+
+#endif /* end of include guard: AN_LEXERKERNELS_H */
@@ -3,13 +3,18 @@
 
 #include <string>
 #include <memory>
+#include <unordered_map>
 #include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/DenseMap.h>
 #include "funcdecl.h"
+#include "symbol.h"
+#include "traitimplindex.h"
 
 namespace ante {
     struct TraitDecl;
     struct TraitImpl;
     class AnType;
+    struct PromotingVisitor;
 
     using TypeArgs = std::vector<AnType*>;
 
@@ -48,27 +53,93 @@ namespace ante {
         /**
          * @brief Each declared function in the module
          */
-        llvm::StringMap<FuncDecl*> fnDecls;
+        llvm::DenseMap<Symbol, FuncDecl*> fnDecls;
 
         /**
          * @brief Each declared DataType in the module
          */
-        llvm::StringMap<TypeDecl> userTypes;
+        llvm::DenseMap<Symbol, TypeDecl> userTypes;
 
         /**
          * @brief Map of all declared traits; not including their implementations for a given type
          */
-        llvm::StringMap<TraitDecl*> traitDecls;
+        llvm::DenseMap<Symbol, TraitDecl*> traitDecls;
 
         /**
          * @brief Map of all trait implementations keyed by name.
+         *
+         * Impls should be added through addTraitImpl so they are indexed as well.
          */
-        llvm::StringMap<std::vector<TraitImpl*>> traitImpls;
+        llvm::DenseMap<Symbol, TraitImplIndex> traitImpls;
+
+        /**
+         * Every declaration visible through the module's imports, merged
+         * into one table per kind as each import is added by addImport.
+         * A name is then found with one probe rather than one per import.
+         *
+         * If several imports declare the same name the one imported first
+         * is kept, and the module's own declarations shadow all of them.
+         * Trait impls are instead merged in the order imported.
+         */
+        struct ImportIndex {
+            llvm::DenseMap<Symbol, FuncDecl*> fnDecls;
+            llvm::DenseMap<Symbol, TypeDecl> userTypes;
+            llvm::DenseMap<Symbol, TraitDecl*> traitDecls;
+            llvm::DenseMap<Symbol, TraitImplIndex> traitImpls;
+
+            /** The index within imports of the first import declaring each
+             *  function, type, and trait, used to report conflicting imports. */
+            llvm::DenseMap<Symbol, size_t> fnProviders;
+            llvm::DenseMap<Symbol, size_t> typeProviders;
+            llvm::DenseMap<Symbol, size_t> traitProviders;
+
+            /** The index within imports of the first import with each module name */
+            llvm::StringMap<size_t> moduleNames;
+
+            /** The first submodule with each name among the imports' direct children */
+            llvm::StringMap<Module*> submodules;
+        };
+
+        /** An impl found by resolveTraitImpl, along with each of its methods found so far */
+        struct ResolvedImpl {
+            TraitImpl *impl = nullptr;
+            llvm::DenseMap<Symbol, Declaration*> methods;
+
+            /** Return the method named fnName within impl, or null if there is none */
+            Declaration* findMethod(Symbol fnName);
+        };
 
         private:
+        ImportIndex imported;
+
+        struct ResolvedImplKey {
+            Symbol traitName;
+            TypeArgs typeArgs;
+
+            bool operator==(ResolvedImplKey const& other) const {
+                return traitName == other.traitName && typeArgs == other.typeArgs;
+            }
+        };
+
+        struct ResolvedImplKeyHash {
+            size_t operator()(ResolvedImplKey const& key) const;
+        };
+
+        /**
+         * Each impl resolved for concrete type args, since the same impls
+         * are otherwise looked up again at every call site during codegen.
+         * Types are interned so the args can be compared by pointer.
+         * This is cleared whenever an impl or import is added to the module,
+         * and PromotingVisitor::promoteModule promotes each key's args so a
+         * collected nursery type's address is never reused for a stale key.
+         */
+        mutable std::unordered_map<ResolvedImplKey, ResolvedImpl, ResolvedImplKeyHash> resolvedImpls;
+
         /** The submodules of the current node */
         llvm::StringMap<Module> children;
 
+        friend PromotingVisitor;
+
         public:
             Module(std::string const& name) : name{name} {}
             ~Module() = default;
@@ -76,30 +147,96 @@ namespace ante {
             /** Return the root of the virtual file/module system. */
             static Module& getRoot();
 
+            /** Add the given module to imports and make each of its declarations visible */
+            void addImport(Module *import);
+
+            /** Return the index within imports of the first module imported with the given name,
+             *  or imports.size() if there is none. */
+            size_t findImport(llvm::StringRef moduleName) const;
+
+            /** Return the first direct child of an import with the given name, or null if there is none */
+            Module* findImportedSubmodule(llvm::StringRef name) const;
+
+            /** Return every type visible through the module's imports */
+            llvm::DenseMap<Symbol, TypeDecl> const& getImportedTypes() const {
+                return imported.userTypes;
+            }
+
+            /**
+             * Return the index within imports of the first module declaring a function,
+             * type, or trait that is also declared by the given module, or imports.size()
+             * if there is none.  name is set to the first such declaration of the given
+             * module, checking its types, then traits, then functions.
+             */
+            size_t findImportConflict(Module const *import, Symbol &name) const;
+
+            /** Declare an implementation of the named trait within this module */
+            void addTraitImpl(Symbol traitName, TraitImpl *impl);
+
+            /** Return a declared function if it is visible to the current module */
+            FuncDecl* lookupFunction(Symbol name) const;
+
             /** Return a declared type if it is visible to the current module.
              *  This is usually an AnDataType, but may be any type if the
              *  named type is an alias to a primitive type. */
-            AnType* lookupType(std::string const& name) const;
+            AnType* lookupType(Symbol name) const;
 
             /** Lookup the given type and return it and its location. */
-            TypeDecl* lookupTypeDecl(std::string const& name) const;
+            TypeDecl* lookupTypeDecl(Symbol name) const;
 
             /** Lookup the given TraitDecl* and return it if found, null otherwise */
-            TraitDecl* lookupTraitDecl(std::string const& name) const;
+            TraitDecl* lookupTraitDecl(Symbol name) const;
 
             /** Lookup the given TraitInstance* and return it if found, null otherwise */
-            TraitImpl* lookupTraitImpl(std::string const& name, TypeArgs const& typeArgs) const;
+            TraitImpl* lookupTraitImpl(Symbol name, TypeArgs const& typeArgs) const;
+
+            /** Return the memoized impl for the given args, or nullptr if they are generic.
+             *  The result is valid until the next impl or import is added to the module. */
+            ResolvedImpl* resolveTraitImpl(Symbol name, TypeArgs const& typeArgs) const;
+
+            /** Lookup the method named fnName within the impl of the given trait,
+             *  returning null if the impl or method is not found. */
+            Declaration* lookupTraitMethod(Symbol traitName, TypeArgs const& typeArgs, Symbol fnName) const;
 
             /** Lookup the TraitDecl and return a new, unimplemented instance of it */
-            TraitImpl* freshTraitImpl(std::string const& name) const;
+            TraitImpl* freshTraitImpl(Symbol name) const;
 
             /** For some TraitDecl  D 'a 'b  create a TraitImpl exactly matching it with no fresh typevars */
-            TraitImpl* createTraitImplFromDecl(std::string const& traitName) const;
+            TraitImpl* createTraitImplFromDecl(Symbol traitName) const;
+
+            // Convenience overloads which intern the given name first
+
+            AnType* lookupType(llvm::StringRef name) const {
+                return lookupType(Symbol::get(name));
+            }
+
+            TypeDecl* lookupTypeDecl(llvm::StringRef name) const {
+                return lookupTypeDecl(Symbol::get(name));
+            }
+
+            TraitDecl* lookupTraitDecl(llvm::StringRef name) const {
+                return lookupTraitDecl(Symbol::get(name));
+            }
+
+            TraitImpl* lookupTraitImpl(llvm::StringRef name, TypeArgs const& typeArgs) const {
+                return lookupTraitImpl(Symbol::get(name), typeArgs);
+            }
+
+            TraitImpl* freshTraitImpl(llvm::StringRef name) const {
+                return freshTraitImpl(Symbol::get(name));
+            }
+
+            TraitImpl* createTraitImplFromDecl(llvm::StringRef traitName) const {
+                return createTraitImplFromDecl(Symbol::get(traitName));
+            }
 
             /** Find a single direct child with the given name */
             llvm::StringMap<Module>::iterator findChild(std::string const& name);
 
 
+            /** Return children.begin(), used to iterate over every direct child. */
+            llvm::StringMap<Module>::iterator childrenBegin();
+
             /**
              * Return children.end().
              *
@@ -1,7 +1,8 @@
 #ifndef AN_NAMERESOLUTION_H
 #define AN_NAMERESOLUTION_H
 
-#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
 #include "parser.h"
 #include "variable.h"
 #include "module.h"
@@ -15,13 +16,27 @@ namespace ante {
      * Annotates all VarNodes with their Variable* or their FuncDecl*.
      */
     struct NameResolutionVisitor : public NodeVisitor {
-        /** The varTable is a stack of a set of scopes visible to each function.
-         *  The current function is only allowed to see its own contained scopes
-         *  which are all contained within the top of the stack. */
-        std::stack<std::vector<llvm::StringMap<Variable*>>> varTable;
+        /** A local variable along with the index of the scope declaring it */
+        struct Binding {
+            Variable *var;
+            size_t scope;
+        };
+
+        /** Each name bound in an open scope mapped to a stack of its bindings,
+         *  innermost last, so finding the visible one takes a single probe. */
+        llvm::DenseMap<Symbol, llvm::SmallVector<Binding, 1>> bindings;
+
+        /** The undo log of each open scope: every name bound within it,
+         *  whose binding is popped again when the scope is exited. */
+        std::vector<std::vector<Symbol>> scopes;
+
+        /** The index of the first scope of each function entered.  The current
+         *  function is only allowed to see its own scopes, which start at the
+         *  last index here. */
+        std::vector<size_t> functionScopes;
 
         /** Globals may be accessed from any scope but can be shadowed by any scope as well. */
-        llvm::StringMap<std::unique_ptr<Variable>> globals;
+        llvm::DenseMap<Symbol, std::unique_ptr<Variable>> globals;
 
         /** When this is set to true all VarNodes will be automatically declared as new variables.
          * This is used inside of match patterns. */
@@ -30,6 +45,10 @@ namespace ante {
         /** @brief functions and type definitions of current module */
         Module *compUnit;
 
+        /** The outermost function whose body is currently being resolved, or null
+         *  at the top level.  Any function referenced is added to its callees. */
+        FuncDecl *currentFunction = nullptr;
+
         /** Construct a new NameResolutionVisitor */
         NameResolutionVisitor(std::string const& moduleName){
             compUnit = new Module(moduleName);
@@ -40,28 +59,31 @@ namespace ante {
 
         private:
             /** Declare a variable with its type unknown */
-            void declare(std::string const& name, parser::VarNode *decl);
-            void declare(std::string const& name, parser::NamedValNode *decl);
+            void declare(Symbol name, parser::VarNode *decl);
+            void declare(Symbol name, parser::NamedValNode *decl);
 
             /** Declare functions but do not define them */
             void declare(parser::FuncDeclNode *decl);
             void declare(parser::ExtNode *decl);
 
             /** Declare/Register a trait declaration */
-            void declare(TraitDecl *decl, LOC_TY &loc);
+            void declare(Symbol name, TraitDecl *decl, LOC_TY &loc);
 
             /** Declare a type with its contents unknown */
             void declareProductType(parser::DataDeclNode *n);
             void declareSumType(parser::DataDeclNode *n);
 
             /** Define a type with the given contents. */
-            void define(std::string const& name, AnDataType *type, LOC_TY &loc);
+            void define(Symbol name, AnDataType *type, LOC_TY &loc);
+
+            /** Bind name to var in the innermost scope, erroring if it is already bound there */
+            void bind(Symbol name, Variable *var, LOC_TY &loc, std::string const& kind);
 
             /** Lookup the variable name and return it if found or null otherwise */
-            Variable* lookupVar(std::string const& name) const;
+            Variable* lookupVar(Symbol name) const;
 
             /** Lookup the type by name and return it if found or null otherwise */
-            TypeDecl* lookupType(std::string const& name) const;
+            TypeDecl* lookupType(Symbol name) const;
 
             void validateType(const AnType *tn, const parser::DataDeclNode *decl);
 
@@ -86,10 +108,18 @@ namespace ante {
              * the next phase. */
             AnType* tryToAnType(parser::TypeNode *tn);
 
-            FuncDecl* getFunction(std::string const& name) const;
+            FuncDecl* getFunction(Symbol name) const;
 
             Declaration* findCandidate(parser::Node *n) const;
     };
+
+    /**
+     * Find the path of each file imported by the given source without
+     * parsing it by checking each line that begins with an import.  The
+     * result is only used to start parsing imports early, so imports this
+     * misses, or lines it mistakes for imports, only cost time.
+     */
+    std::vector<std::string> scanImports(const char *begin, const char *end);
 }
 
 #endif
@@ -0,0 +1,38 @@
+#ifndef AN_NODEARENA_H
+#define AN_NODEARENA_H
+
+#include <llvm/Support/Allocator.h>
+
+namespace ante {
+    namespace parser {
+
+        /**
+         * A bump allocator holding the memory of every Node created while
+         * it is the currentNodeArena.  Nodes are still owned and destroyed
+         * through their parent as usual, but deleting a Node in an arena
+         * only runs its destructor.  Its memory is freed along with the
+         * rest of the arena when the arena is destroyed.
+         *
+         * Each parsed file gets its own arena, which is then owned by
+         * the file's RootNode.
+         */
+        class NodeArena {
+        public:
+            void* allocate(size_t size){
+                return allocator.Allocate(size, alignof(void*));
+            }
+
+            size_t getBytesAllocated() const {
+                return allocator.getBytesAllocated();
+            }
+
+        private:
+            llvm::BumpPtrAllocator allocator;
+        };
+
+        /** The arena new Nodes on this thread are allocated in, or null to allocate them on the heap */
+        extern thread_local NodeArena *currentNodeArena;
+    }
+}
+
+#endif /* end of include guard: AN_NODEARENA_H */
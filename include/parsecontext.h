@@ -0,0 +1,68 @@
+#ifndef AN_PARSECONTEXT_H
+#define AN_PARSECONTEXT_H
+
+#include "parser.h"
+#include <stack>
+#include <memory>
+
+namespace ante {
+    namespace parser {
+
+        /**
+         * Holds all the state needed to parse a single file.
+         *
+         * Each ParseContext owns its own Lexer and parse tree so
+         * separate files may be parsed concurrently, one context
+         * per thread.  The parser creates typevars for parameters
+         * without type annotations, so the typeArena must be
+         * concurrent while doing so.
+         */
+        struct ParseContext {
+            std::unique_ptr<Lexer> lexer;
+
+            /**
+             * Stack of relative roots, eg. a FuncDeclNode's first statement would be set as the
+             * relative root, where the last would be returned by the parser.  Relative roots are
+             * returned through getRoot() which also pops the stack.
+             */
+            std::stack<Node*> roots;
+
+            /** The single true-root of the parsed file. */
+            RootNode *root = nullptr;
+
+            /** Number of syntax errors reported so far */
+            size_t errCount = 0;
+
+            /** Holds every Node created while parsing.  Given to root once parsing finishes. */
+            std::unique_ptr<NodeArena> arena;
+
+            /** Takes ownership of the given lexer */
+            explicit ParseContext(Lexer *lexer) : lexer{lexer}, arena{new NodeArena()}{}
+
+            /**
+             * Parse the whole input.  On a syntax error the parser
+             * continues from the next line to report any remaining
+             * errors and the first error's code is returned.
+             */
+            int parse();
+
+            /** Saves the root of a new block and returns it. */
+            Node* setRoot(Node *node);
+
+            /** Pops and returns the root of the current block */
+            Node* getRoot();
+
+            void createRoot();
+            void createRoot(LOC_TY &loc);
+
+            Node* append_main(Node *n);
+            Node* append_fn(Node *n);
+            Node* append_type(Node *n);
+            Node* append_extension(Node *n);
+            Node* append_trait(Node *n);
+            Node* append_import(Node *n);
+        };
+    }
+}
+
+#endif /* end of include guard: AN_PARSECONTEXT_H */
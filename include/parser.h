@@ -5,12 +5,15 @@
 #include <memory>
 #include "lexer.h"
 #include "tokens.h"
-#include "location.hh"
+#include "sourcelocation.h"
 #include "nodevisitor.h"
 #include "declaration.h"
+#include "nodearena.h"
+#include "symbol.h"
+#include <llvm/Support/Casting.h>
 
 #ifndef LOC_TY
-#  define LOC_TY yy::location
+#  define LOC_TY ante::SourceRange
 #endif
 
 namespace ante {
@@ -22,12 +25,12 @@ namespace ante {
     struct TraitImpl;
     class AnType;
 
-    namespace parser {
-
-        /* Needed for compliancy with several versions of bison */
-        yy::position mkPos(std::string *f, unsigned int line, unsigned int col);
-        LOC_TY mkLoc(yy::position begin, yy::position end);
+    using llvm::isa;
+    using llvm::cast;
+    using llvm::dyn_cast;
+    using llvm::dyn_cast_or_null;
 
+    namespace parser {
 
         enum ParseErr{
             PE_OK,
@@ -39,6 +42,19 @@ namespace ante {
 
         struct Node;
 
+        /**
+         * The concrete class of a Node, used by isa, cast, and dyn_cast.
+         * Every kind from FirstModifiable onward is a ModifiableNode.
+         */
+        enum class NodeKind : uint8_t {
+            Root, IntLit, FltLit, BoolLit, CharLit, StrLit, Array, Tuple, UnOp, BinOp,
+            Seq, Block, Mod, TypeCast, Ret, NamedVal, Var, Import, Jump, While, For,
+            MatchBranch, Match, If,
+
+            Type, VarAssign, Ext, FuncDecl, DataDecl, Trait,
+            FirstModifiable = Type
+        };
+
         template<typename T>
         struct NodeIterator {
             T *cur;
@@ -78,10 +94,23 @@ namespace ante {
 
             LOC_TY& getLoc() noexcept { return loc; }
 
-            Node(LOC_TY& l) : next{nullptr}, loc{l}, type{nullptr}{}
-            virtual ~Node(){}
+            NodeKind getKind() const noexcept { return kind; }
+
+            Node(NodeKind kind, LOC_TY& l) : next{nullptr}, loc{l}, kind{kind}, type{nullptr}{}
+
+            virtual ~Node(){
+                //Free the rest of the list iteratively so long lists cannot overflow the stack
+                auto n = std::move(next);
+                while(n)
+                    n = std::move(n->next);
+            }
+
+            /** Nodes are allocated in the currentNodeArena if there is one and on the heap otherwise */
+            static void* operator new(size_t size);
+            static void operator delete(void *node);
 
             private:
+                const NodeKind kind;
                 AnType *type;
         };
 
@@ -99,9 +128,13 @@ namespace ante {
              * parent node is initialized, so it is required
              * in the constructor (unlike next and prev)
              */
-            ModifiableNode(LOC_TY& loc) : Node(loc){}
+            ModifiableNode(NodeKind kind, LOC_TY& loc) : Node(kind, loc){}
             ~ModifiableNode(){}
 
+            static bool classof(const Node *n){
+                return n->getKind() >= NodeKind::FirstModifiable;
+            }
+
             bool hasModifier(int mod) const;
         };
 
@@ -118,13 +151,20 @@ namespace ante {
         *   into the 'main' or "init_${module}" function
         */
         struct RootNode : public Node{
+            /** The arena holding the rest of this tree.  Declared first so it is freed last. */
+            std::unique_ptr<NodeArena> arena;
+
             std::vector<std::unique_ptr<Node>> funcs, traits, extensions, types, imports, main;
 
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Root; }
+
+            /** RootNodes are always allocated on the heap since they own the arena of their tree */
+            static void* operator new(size_t size);
 
             /** Merge all contents of rn into this RootNode */
             void merge(const RootNode *rn);
-            RootNode(LOC_TY& loc) : Node(loc){}
+            RootNode(LOC_TY& loc) : Node(NodeKind::Root, loc){}
             ~RootNode(){}
         };
 
@@ -133,7 +173,8 @@ namespace ante {
             std::string val;
             TypeTag typeTag;
             void accept(NodeVisitor& v){ v.visit(this); }
-            IntLitNode(LOC_TY& loc, std::string s, TypeTag ty) : Node(loc), val(s), typeTag(ty){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::IntLit; }
+            IntLitNode(LOC_TY& loc, std::string s, TypeTag ty) : Node(NodeKind::IntLit, loc), val(s), typeTag(ty){}
             ~IntLitNode(){}
         };
 
@@ -141,37 +182,42 @@ namespace ante {
             std::string val;
             TypeTag typeTag;
             void accept(NodeVisitor& v){ v.visit(this); }
-            FltLitNode(LOC_TY& loc, std::string s, TypeTag ty) : Node(loc), val(s), typeTag(ty){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::FltLit; }
+            FltLitNode(LOC_TY& loc, std::string s, TypeTag ty) : Node(NodeKind::FltLit, loc), val(s), typeTag(ty){}
             ~FltLitNode(){}
         };
 
         struct BoolLitNode : public Node{
             bool val;
             void accept(NodeVisitor& v){ v.visit(this); }
-            BoolLitNode(LOC_TY& loc, char b) : Node(loc), val((bool) b){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::BoolLit; }
+            BoolLitNode(LOC_TY& loc, char b) : Node(NodeKind::BoolLit, loc), val((bool) b){}
             ~BoolLitNode(){}
         };
 
         struct CharLitNode : public Node{
             char val;
             void accept(NodeVisitor& v){ v.visit(this); }
-            CharLitNode(LOC_TY& loc, char c) : Node(loc), val(c){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::CharLit; }
+            CharLitNode(LOC_TY& loc, char c) : Node(NodeKind::CharLit, loc), val(c){}
             ~CharLitNode(){}
         };
 
         struct ArrayNode : public Node{
             std::vector<std::unique_ptr<Node>> exprs;
             void accept(NodeVisitor& v){ v.visit(this); }
-            ArrayNode(LOC_TY& loc, std::vector<std::unique_ptr<Node>>& e) : Node(loc), exprs(move(e)){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Array; }
+            ArrayNode(LOC_TY& loc, std::vector<std::unique_ptr<Node>>& e) : Node(NodeKind::Array, loc), exprs(move(e)){}
             ~ArrayNode(){}
         };
 
         struct TupleNode : public Node{
             std::vector<std::unique_ptr<Node>> exprs;
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Tuple; }
 
             std::vector<TypedValue> unpack(Compiler*);
-            TupleNode(LOC_TY& loc, std::vector<std::unique_ptr<Node>>& e) : Node(loc), exprs(move(e)){}
+            TupleNode(LOC_TY& loc, std::vector<std::unique_ptr<Node>>& e) : Node(NodeKind::Tuple, loc), exprs(move(e)){}
             ~TupleNode(){}
         };
 
@@ -179,7 +225,8 @@ namespace ante {
             int op;
             std::unique_ptr<Node> rval;
             void accept(NodeVisitor& v){ v.visit(this); }
-            UnOpNode(LOC_TY& loc, int s, Node *rv) : Node(loc), op(s), rval(rv){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::UnOp; }
+            UnOpNode(LOC_TY& loc, int s, Node *rv) : Node(NodeKind::UnOp, loc), op(s), rval(rv){}
             ~UnOpNode(){}
         };
 
@@ -189,21 +236,24 @@ namespace ante {
             Declaration* decl;
 
             void accept(NodeVisitor& v){ v.visit(this); }
-            BinOpNode(LOC_TY& loc, int s, Node *lv, Node *rv) : Node(loc), op(s), lval(lv), rval(rv), decl(0){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::BinOp; }
+            BinOpNode(LOC_TY& loc, int s, Node *lv, Node *rv) : Node(NodeKind::BinOp, loc), op(s), lval(lv), rval(rv), decl(0){}
             ~BinOpNode(){}
         };
 
         struct SeqNode : public Node{
             std::vector<std::unique_ptr<Node>> sequence;
             void accept(NodeVisitor& v){ v.visit(this); }
-            SeqNode(LOC_TY& loc) : Node(loc), sequence(){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Seq; }
+            SeqNode(LOC_TY& loc) : Node(NodeKind::Seq, loc), sequence(){}
             ~SeqNode(){}
         };
 
         struct BlockNode : public Node{
             std::unique_ptr<Node> block;
             void accept(NodeVisitor& v){ v.visit(this); }
-            BlockNode(LOC_TY& loc, Node *b) : Node(loc), block(b){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Block; }
+            BlockNode(LOC_TY& loc, Node *b) : Node(NodeKind::Block, loc), block(b){}
             ~BlockNode(){}
         };
 
@@ -223,16 +273,17 @@ namespace ante {
             static const int CD_ID = 1;
 
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Mod; }
 
             bool isCompilerDirective() const {
                 return mod == CD_ID;
             }
 
             /** Constructor for normal modifiers */
-            ModNode(LOC_TY& loc, int m, Node *e) : Node(loc), mod(m), expr(e){}
+            ModNode(LOC_TY& loc, int m, Node *e) : Node(NodeKind::Mod, loc), mod(m), expr(e){}
 
             /** Constructor for compiler directives */
-            ModNode(LOC_TY& loc, Node *d, Node *e) : Node(loc), mod(CD_ID), directive(d), expr(e){}
+            ModNode(LOC_TY& loc, Node *d, Node *e) : Node(NodeKind::Mod, loc), mod(CD_ID), directive(d), expr(e){}
             ~ModNode(){}
         };
 
@@ -243,8 +294,9 @@ namespace ante {
             std::vector<std::unique_ptr<TypeNode>> params; //type parameters for generic types
 
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Type; }
             TypeNode(LOC_TY& loc, TypeTag ty, std::string tName, TypeNode* eTy)
-                : ModifiableNode(loc), typeTag(ty), typeName(tName), extTy(eTy), params(){}
+                : ModifiableNode(NodeKind::Type, loc), typeTag(ty), typeName(tName), extTy(eTy), params(){}
             ~TypeNode(){}
         };
 
@@ -252,23 +304,27 @@ namespace ante {
             std::unique_ptr<TypeNode> typeExpr;
             std::unique_ptr<Node> rval;
             void accept(NodeVisitor& v){ v.visit(this); }
-            TypeCastNode(LOC_TY& loc, TypeNode *ty, Node *rv) : Node(loc), typeExpr(ty), rval(rv){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::TypeCast; }
+            TypeCastNode(LOC_TY& loc, TypeNode *ty, Node *rv) : Node(NodeKind::TypeCast, loc), typeExpr(ty), rval(rv){}
             ~TypeCastNode(){}
         };
 
         struct RetNode : public Node{
             std::unique_ptr<Node> expr;
             void accept(NodeVisitor& v){ v.visit(this); }
-            RetNode(LOC_TY& loc, Node* e) : Node(loc), expr(e){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Ret; }
+            RetNode(LOC_TY& loc, Node* e) : Node(NodeKind::Ret, loc), expr(e){}
             ~RetNode(){}
         };
 
         struct NamedValNode : public Node{
-            std::string name;
+            Symbol name;
             std::unique_ptr<Node> typeExpr;
             Declaration* decl = 0;
             void accept(NodeVisitor& v){ v.visit(this); }
-            NamedValNode(LOC_TY& loc, std::string s, Node* t) : Node(loc), name(s), typeExpr(t), decl(0){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::NamedVal; }
+            NamedValNode(LOC_TY& loc, Symbol s, Node* t) : Node(NodeKind::NamedVal, loc), name(s), typeExpr(t), decl(0){}
+            NamedValNode(LOC_TY& loc, llvm::StringRef s, Node* t) : NamedValNode(loc, Symbol::get(s), t){}
             ~NamedValNode(){}
 
             virtual AnType* getType() const {
@@ -283,10 +339,12 @@ namespace ante {
         };
 
         struct VarNode : public Node{
-            std::string name;
+            Symbol name;
             Declaration* decl;
             void accept(NodeVisitor& v){ v.visit(this); }
-            VarNode(LOC_TY& loc, std::string s) : Node(loc), name(s), decl(0){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Var; }
+            VarNode(LOC_TY& loc, Symbol s) : Node(NodeKind::Var, loc), name(s), decl(0){}
+            VarNode(LOC_TY& loc, llvm::StringRef s) : VarNode(loc, Symbol::get(s)){}
             ~VarNode(){}
 
             AnType* getType() const;
@@ -296,7 +354,8 @@ namespace ante {
         struct StrLitNode : public Node{
             std::string val;
             void accept(NodeVisitor& v){ v.visit(this); }
-            StrLitNode(LOC_TY& loc, std::string s) : Node(loc), val(s){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::StrLit; }
+            StrLitNode(LOC_TY& loc, std::string s) : Node(NodeKind::StrLit, loc), val(s){}
             ~StrLitNode(){}
         };
 
@@ -305,8 +364,9 @@ namespace ante {
             std::unique_ptr<Node> expr;
             bool freeLval;
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::VarAssign; }
             VarAssignNode(LOC_TY& loc, Node* v, Node* exp, bool b)
-                : ModifiableNode(loc), ref_expr(v), expr(exp), freeLval(b){}
+                : ModifiableNode(NodeKind::VarAssign, loc), ref_expr(v), expr(exp), freeLval(b){}
             ~VarAssignNode(){ if(freeLval) delete ref_expr; }
         };
 
@@ -319,15 +379,17 @@ namespace ante {
             TraitImpl *traitType;
 
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Ext; }
             ExtNode(LOC_TY& loc, TypeNode *ty, Node *m, TypeNode *tr)
-                : ModifiableNode(loc), typeExpr(ty), trait(tr), methods(m), traitType(0){}
+                : ModifiableNode(NodeKind::Ext, loc), typeExpr(ty), trait(tr), methods(m), traitType(0){}
             ~ExtNode(){}
         };
 
         struct ImportNode : public Node{
             std::unique_ptr<Node> expr;
             void accept(NodeVisitor& v){ v.visit(this); }
-            ImportNode(LOC_TY& loc, Node* e) : Node(loc), expr(e){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Import; }
+            ImportNode(LOC_TY& loc, Node* e) : Node(NodeKind::Import, loc), expr(e){}
             ~ImportNode(){}
         };
 
@@ -335,15 +397,17 @@ namespace ante {
             std::unique_ptr<Node> expr;
             int jumpType;
             void accept(NodeVisitor& v){ v.visit(this); }
-            JumpNode(LOC_TY& loc, int jt, Node* e) : Node(loc), expr(e), jumpType(jt){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Jump; }
+            JumpNode(LOC_TY& loc, int jt, Node* e) : Node(NodeKind::Jump, loc), expr(e), jumpType(jt){}
             ~JumpNode(){}
         };
 
         struct WhileNode : public Node{
             std::unique_ptr<Node> condition, child;
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::While; }
             WhileNode(LOC_TY& loc, Node *cond, Node *body)
-                : Node(loc), condition(cond), child(body){}
+                : Node(NodeKind::While, loc), condition(cond), child(body){}
             ~WhileNode(){}
         };
 
@@ -352,15 +416,17 @@ namespace ante {
             TraitImpl *iterableInstance = 0;
 
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::For; }
             ForNode(LOC_TY& loc, Node *v, Node *r, Node *body) :
-                Node(loc), pattern(v), range(r), child(body){}
+                Node(NodeKind::For, loc), pattern(v), range(r), child(body){}
             ~ForNode(){}
         };
 
         struct MatchBranchNode : public Node{
             std::unique_ptr<Node> pattern, branch;
             void accept(NodeVisitor& v){ v.visit(this); }
-            MatchBranchNode(LOC_TY& loc, Node *p, Node *b) : Node(loc), pattern(p), branch(b){}
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::MatchBranch; }
+            MatchBranchNode(LOC_TY& loc, Node *p, Node *b) : Node(NodeKind::MatchBranch, loc), pattern(p), branch(b){}
             ~MatchBranchNode(){}
         };
 
@@ -369,21 +435,23 @@ namespace ante {
             std::vector<std::unique_ptr<MatchBranchNode>> branches;
 
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Match; }
             MatchNode(LOC_TY& loc, Node *e, std::vector<std::unique_ptr<MatchBranchNode>> &b)
-                : Node(loc), expr(e), branches(move(b)){}
+                : Node(NodeKind::Match, loc), expr(e), branches(move(b)){}
             ~MatchNode(){}
         };
 
         struct IfNode : public Node{
             std::unique_ptr<Node> condition, thenN, elseN;
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::If; }
             IfNode(LOC_TY& loc, Node* c, Node* then, Node* els)
-                : Node(loc), condition(c), thenN(then), elseN(els){}
+                : Node(NodeKind::If, loc), condition(c), thenN(then), elseN(els){}
             ~IfNode(){}
         };
 
         struct FuncDeclNode : public ModifiableNode{
-            std::string name;
+            Symbol name;
             std::unique_ptr<Node> child;
             std::unique_ptr<TypeNode> returnType;
             std::unique_ptr<NamedValNode> params;
@@ -392,10 +460,11 @@ namespace ante {
             Declaration* decl;
 
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::FuncDecl; }
 
-            FuncDeclNode(LOC_TY& loc, std::string s, TypeNode *t, NamedValNode *p,
+            FuncDeclNode(LOC_TY& loc, Symbol s, TypeNode *t, NamedValNode *p,
                 TypeNode *tcc, Node* b, bool va=false)
-                : ModifiableNode(loc), name(s), child(b), returnType(t), params(p),
+                : ModifiableNode(NodeKind::FuncDecl, loc), name(s), child(b), returnType(t), params(p),
                   typeClassConstraints(tcc), varargs(va), decl(0){}
             ~FuncDeclNode(){}
 
@@ -416,28 +485,29 @@ namespace ante {
             bool isAlias;
 
             void accept(NodeVisitor& v){ v.visit(this); }
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::DataDecl; }
             DataDeclNode(LOC_TY& loc, std::string s, Node* b, size_t f, bool a)
-                : ModifiableNode(loc), child(b), name(s), fields(f), isAlias(a){}
+                : ModifiableNode(NodeKind::DataDecl, loc), child(b), name(s), fields(f), isAlias(a){}
 
             DataDeclNode(LOC_TY& loc, std::string s, Node* b, size_t f,
                     std::vector<std::unique_ptr<TypeNode>> &&g, bool a)
-                : ModifiableNode(loc), child(b), name(s), fields(f), generics(move(g)), isAlias(a){}
+                : ModifiableNode(NodeKind::DataDecl, loc), child(b), name(s), fields(f), generics(move(g)), isAlias(a){}
             ~DataDeclNode(){}
         };
 
         struct TraitNode : public ModifiableNode{
             std::unique_ptr<Node> child;
-            std::string name;
+            Symbol name;
             std::vector<std::unique_ptr<TypeNode>> generics;
 
             void accept(NodeVisitor& v){ v.visit(this); }
-            TraitNode(LOC_TY& loc, std::string s,
+            static bool classof(const Node *n){ return n->getKind() == NodeKind::Trait; }
+            TraitNode(LOC_TY& loc, Symbol s,
                     std::vector<std::unique_ptr<TypeNode>> &&g, Node* b)
-                : ModifiableNode(loc), child(b), name(s), generics(move(g)){}
+                : ModifiableNode(NodeKind::Trait, loc), child(b), name(s), generics(move(g)){}
             ~TraitNode(){}
         };
 
-        RootNode* getRootNode();
         void printBlock(Node *block, size_t indent_level);
         void parseErr(ParseErr e, std::string s, bool showTok);
     } // end of ante::parser
@@ -0,0 +1,30 @@
+#ifndef AN_PROMOTINGVISITOR_H
+#define AN_PROMOTINGVISITOR_H
+
+#include "parser.h"
+#include "module.h"
+
+namespace ante {
+
+    /**
+     * Promotes every type reachable from an AST or module out of the
+     * typeArena's nursery so that it survives AnTypeContainer::collectNursery.
+     */
+    struct PromotingVisitor : public NodeVisitor {
+        DECLARE_NODE_VISIT_METHODS();
+
+        static void promoteAst(parser::Node *ast){
+            PromotingVisitor v;
+            ast->accept(v);
+        }
+
+        /** Promote every type declared in the given module, its AST, and each of its submodules. */
+        static void promoteModule(Module &module);
+
+        private:
+        /** Promote the type of this node if it has one */
+        void promoteNodeType(parser::Node *n);
+    };
+}
+
+#endif /* end of include guard: AN_PROMOTINGVISITOR_H */
@@ -2,33 +2,20 @@
 #define PTREE_H
 
 #include "parser.h"
+#include "parsecontext.h"
 
 #ifndef LOC_TY
-#define LOC_TY yy::location
+#define LOC_TY ante::SourceRange
 #endif
 
-//defined in lexer.cpp
-extern char* lextxt;
-
 namespace ante {
     namespace parser {
 
-        Node* setRoot(Node* root);
-        Node* getRoot();
         Node* setNext(Node* cur, Node* nxt);
         Node* setElse(Node *ifn, Node *elseN);
         Node* addMatch(Node *matchExpr, Node *newMatch);
         Node* applyMods(Node *mods, Node *decls);
 
-        void createRoot();
-        void createRoot(LOC_TY& loc);
-
-        Node* append_main(Node *n);
-        Node* append_fn(Node *n);
-        Node* append_type(Node *n);
-        Node* append_extension(Node *n);
-        Node* append_trait(Node *n);
-        Node* append_import(Node *n);
         Node* append_modifiers(Node *modifiers, Node *modifiableNode);
 
         char* nextVarArgsTVName();
@@ -57,6 +44,9 @@ namespace ante {
         Node* mkBlockNode(LOC_TY loc, Node* b);
         Node* mkNamedValNode(LOC_TY loc, Node* nodes, Node* tExpr);
         Node* mkVarNode(LOC_TY loc, char* s);
+
+        /** Make a VarNode named by the lexer's text for an identifier, which is already interned */
+        Node* mkVarNode(LOC_TY loc, Symbol s);
         Node* mkRetNode(LOC_TY loc, Node* expr);
         Node* mkImportNode(LOC_TY loc, Node* expr);
         Node* mkVarAssignNode(LOC_TY loc, Node* var, Node* expr, bool shouldFreeLval = true);
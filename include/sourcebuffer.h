@@ -0,0 +1,100 @@
+#ifndef AN_SOURCEBUFFER_H
+#define AN_SOURCEBUFFER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include "sourcelocation.h"
+
+namespace ante {
+
+    /** A 1-based line and column within a SourceBuffer */
+    struct LineAndColumn {
+        unsigned int line, column;
+    };
+
+    /**
+     * The contents of a source file held in one contiguous, read-only and
+     * null-terminated buffer.  Files are memory-mapped when possible and
+     * read in whole otherwise.
+     *
+     * Each file is loaded once and kept for the rest of compilation so
+     * the Lexer and error reporting share the same copy of it.  Only
+     * buffers made by create, such as a line of REPL input, are freed.
+     *
+     * Together the loaded buffers also act as the compilation's source
+     * manager.  Each is assigned the next free range of SourceLoc offsets,
+     * one per character plus one for the end of the buffer, so a SourceLoc
+     * can later be traced back to its buffer, line, and column.
+     */
+    class SourceBuffer {
+    public:
+        /** Load the named file or return its buffer if it was already loaded.
+         *  Returns nullptr if the file cannot be read. */
+        static SourceBuffer* get(std::string const& fileName);
+
+        /** Read the whole of stdin into a buffer named "stdin" */
+        static SourceBuffer* getStdin();
+
+        /** Copy the given text into a new buffer, eg. for a line of REPL input.
+         *  The name is only used when printing locations within the buffer
+         *  and need not be unique. */
+        static SourceBuffer* create(std::string const& name, llvm::StringRef text);
+
+        /** Free a buffer made by create once nothing refers to it or to any location
+         *  within it.  Its locations are not reused, so stale ones are simply not found. */
+        static void release(SourceBuffer *buffer);
+
+        /** Return the buffer the given location is in, or nullptr if it is invalid */
+        static SourceBuffer* find(SourceLoc loc);
+
+        /** The name of the file or pseudo-file this buffer was loaded from */
+        std::string const& getName() const noexcept {
+            return name;
+        }
+
+        /** The first character of the file.  The buffer is followed by a '\0' */
+        const char* begin() const noexcept {
+            return buffer->getBufferStart();
+        }
+
+        const char* end() const noexcept {
+            return buffer->getBufferEnd();
+        }
+
+        /** Returns the given 1-based line without its trailing newline,
+         *  or an empty string if the file has fewer lines. */
+        llvm::StringRef getLine(unsigned int row) const;
+
+        /** The location of the given character, which must be within the
+         *  buffer or be its terminating '\0' */
+        SourceLoc getLoc(const char *c) const noexcept {
+            return SourceLoc(startOffset + (c - begin()));
+        }
+
+        /** The line and column of a location within this buffer */
+        LineAndColumn getLineAndColumn(SourceLoc loc) const;
+
+    private:
+        SourceBuffer(std::string const& name, std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+        /** Compute lineStarts if it has not been already */
+        void computeLineStarts() const;
+
+        std::string name;
+
+        std::unique_ptr<llvm::MemoryBuffer> buffer;
+
+        /** The offset of the first character's SourceLoc */
+        uint32_t startOffset;
+
+        /** Offset of the first character of each line, computed on the first call to getLine */
+        mutable std::vector<size_t> lineStarts;
+        mutable std::once_flag lineStartsComputed;
+    };
+}
+
+#endif /* end of include guard: AN_SOURCEBUFFER_H */
@@ -0,0 +1,52 @@
+#ifndef AN_SOURCELOCATION_H
+#define AN_SOURCELOCATION_H
+
+#include <cstdint>
+
+namespace ante {
+
+    /**
+     * A position within some SourceBuffer, encoded as a single 32-bit offset.
+     *
+     * Each SourceBuffer is given its own range of offsets when it is loaded
+     * so the offset alone identifies both the file and the character within
+     * it.  The file name, line, and column are only looked up through
+     * SourceBuffer::find when they are needed, eg. to print an error.
+     * Offset 0 is never given out and marks an unknown location.
+     */
+    class SourceLoc {
+    public:
+        SourceLoc() : offset{0}{}
+        explicit SourceLoc(uint32_t offset) : offset{offset}{}
+
+        uint32_t getOffset() const noexcept {
+            return offset;
+        }
+
+        bool isValid() const noexcept {
+            return offset != 0;
+        }
+
+        bool operator==(SourceLoc other) const noexcept { return offset == other.offset; }
+        bool operator!=(SourceLoc other) const noexcept { return offset != other.offset; }
+
+    private:
+        uint32_t offset;
+    };
+
+    /**
+     * The span of source text a token or Node covers.
+     * Both ends are inclusive, so a single character has begin == end.
+     *
+     * This is also the location type used by the parser, which only
+     * requires a begin and end member it can copy between locations.
+     */
+    struct SourceRange {
+        SourceLoc begin, end;
+
+        SourceRange(){}
+        SourceRange(SourceLoc begin, SourceLoc end) : begin{begin}, end{end}{}
+    };
+}
+
+#endif /* end of include guard: AN_SOURCELOCATION_H */
@@ -6,21 +6,32 @@
 #include "unification.h"
 
 namespace ante {
-    
+    namespace parser {
+        class FlatAst;
+    }
+
     struct SubstitutingVisitor : public NodeVisitor {
         DECLARE_NODE_VISIT_METHODS();
 
-        SubstitutingVisitor(Substitutions const& s, Module *module)
-            : substitutions{s}, module{module}{}
+        SubstitutingVisitor(Substitutions const& s) : substitutions{s}{}
+
+        /**
+         * Substitute into the types of every node of an already flattened AST.
+         * Each type is substituted independently of the others, so rather than
+         * visiting the tree this walks the FlatAst from front to back.  Only
+         * worthwhile for passes which reuse the FlatAst, since building
+         * one costs as much as visiting the tree.
+         */
+        void substitute(parser::FlatAst &flat);
 
-        static void substituteIntoAst(parser::Node *ast, Substitutions const& subs, Module *module){
-            SubstitutingVisitor v{subs, module};
+        static void substituteIntoAst(parser::Node *ast, Substitutions const& subs){
+            SubstitutingVisitor v{subs};
             ast->accept(v);
         }
 
         private:
-        Substitutions const& substitutions;
-        Module *module;
+        /** Every node shares one memo so each distinct type is only substituted into once */
+        SubstitutionMemo substitutions;
     };
 }
 
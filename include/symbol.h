@@ -0,0 +1,102 @@
+#ifndef AN_SYMBOL_H
+#define AN_SYMBOL_H
+
+#include <cstdint>
+#include <string>
+#include <ostream>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/DenseMapInfo.h>
+
+namespace ante {
+
+    /**
+     * An interned identifier.
+     *
+     * Each distinct string is assigned a single 32-bit id the first time
+     * it is interned and keeps it for the rest of compilation.  Symbols
+     * can then be compared and hashed as integers, and each shares one
+     * null-terminated copy of its string which is never freed.
+     *
+     * Interning is thread safe.
+     */
+    class Symbol {
+    public:
+        Symbol() : id{invalidId}{}
+
+        /** Return the symbol for the given string, interning it if needed */
+        static Symbol get(llvm::StringRef str);
+
+        /**
+         * Return the symbol whose c_str() is the given string, such as the
+         * lexer's text for an identifier.  This does not hash or lock, but
+         * the string must be one returned by c_str, not merely equal to one.
+         */
+        static Symbol fromInterned(const char *interned);
+
+        uint32_t getId() const noexcept {
+            return id;
+        }
+
+        bool isValid() const noexcept {
+            return id != invalidId;
+        }
+
+        /** The interned string.  Only valid for valid symbols. */
+        llvm::StringRef ref() const;
+
+        /** The interned string, which is always null-terminated */
+        const char* c_str() const;
+
+        /** Copy the interned string into a std::string */
+        std::string str() const {
+            return ref().str();
+        }
+
+        operator llvm::StringRef() const {
+            return ref();
+        }
+
+        bool operator==(Symbol other) const noexcept { return id == other.id; }
+        bool operator!=(Symbol other) const noexcept { return id != other.id; }
+        bool operator<(Symbol other) const noexcept { return id < other.id; }
+
+        /** The number of distinct symbols interned so far */
+        static size_t count();
+
+    private:
+        explicit Symbol(uint32_t id) : id{id}{}
+
+        static const uint32_t invalidId = ~0u;
+
+        uint32_t id;
+
+        friend struct llvm::DenseMapInfo<Symbol>;
+    };
+
+    inline std::ostream& operator<<(std::ostream &out, Symbol symbol){
+        llvm::StringRef str = symbol.ref();
+        return out.write(str.data(), str.size());
+    }
+}
+
+namespace llvm {
+    template<> struct DenseMapInfo<ante::Symbol> {
+        static inline ante::Symbol getEmptyKey(){
+            return ante::Symbol{~0u};
+        }
+
+        static inline ante::Symbol getTombstoneKey(){
+            return ante::Symbol{~0u - 1};
+        }
+
+        static unsigned getHashValue(ante::Symbol symbol){
+            return DenseMapInfo<uint32_t>::getHashValue(symbol.getId());
+        }
+
+        static bool isEqual(ante::Symbol l, ante::Symbol r){
+            return l == r;
+        }
+    };
+}
+
+#endif /* end of include guard: AN_SYMBOL_H */
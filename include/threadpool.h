@@ -0,0 +1,78 @@
+#ifndef AN_THREADPOOL_H
+#define AN_THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+namespace ante {
+
+    /**
+     * A fixed number of worker threads which each own a deque of tasks.
+     *
+     * A task queued from within a worker is pushed onto that worker's own
+     * deque and each worker runs its newest task first.  Workers with an
+     * empty deque steal the oldest task of another worker.  Tasks queued
+     * from outside the pool are distributed between workers round-robin.
+     */
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
+
+        explicit ThreadPool(size_t threadCount);
+
+        /** Waits for every queued task to finish before joining each worker */
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const&) = delete;
+        ThreadPool& operator=(ThreadPool const&) = delete;
+
+        /** Queue a task to be run by any worker.  Safe to call from within
+         *  a task.  Tasks must not let any exception escape. */
+        void async(Task task);
+
+        /** Block until every task queued so far, including any
+         *  tasks they queue themselves, has finished running. */
+        void wait();
+
+        size_t size() const noexcept {
+            return workers.size();
+        }
+
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+
+        /** Guards every member below */
+        std::mutex stateMutex;
+        std::condition_variable workAvailable;
+        std::condition_variable allDone;
+
+        /** Tasks sitting in a worker's deque which have not yet been taken */
+        size_t queuedTasks = 0;
+
+        /** Tasks which were queued and have not finished running */
+        size_t unfinishedTasks = 0;
+
+        /** The worker the next task queued from outside the pool is given to */
+        size_t nextWorker = 0;
+
+        bool stopping = false;
+
+        /** Pop the newest task of the given worker or steal the oldest task of another */
+        bool takeTask(size_t worker, Task &task);
+
+        void run(size_t worker);
+    };
+}
+
+#endif /* end of include guard: AN_THREADPOOL_H */
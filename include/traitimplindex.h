@@ -0,0 +1,88 @@
+#ifndef AN_TRAITIMPLINDEX_H
+#define AN_TRAITIMPLINDEX_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <llvm/ADT/StringRef.h>
+#include "tokens.h"
+
+namespace ante {
+    class AnType;
+    struct TraitImpl;
+
+    using TypeArgs = std::vector<AnType*>;
+
+    /**
+     * The impls of a single trait, indexed by the type constructors
+     * of their type arguments in a discrimination tree.
+     *
+     * Each impl's type arguments are flattened in preorder into a path
+     * of keys (a TypeTag plus the name and arity of the type).  A type
+     * variable within an impl matches any type, so it becomes a wildcard
+     * edge which skips the whole subtree of the type being looked up.
+     * Looking up impls then takes time proportional to the size of the
+     * type arguments rather than to the number of impls.
+     */
+    class TraitImplIndex {
+    public:
+        TraitImplIndex();
+        TraitImplIndex(TraitImplIndex&&);
+        TraitImplIndex& operator=(TraitImplIndex&&);
+        ~TraitImplIndex();
+
+        void add(TraitImpl *impl);
+
+        /**
+         * Return the first impl added whose type arguments are approxEq
+         * to the given ones, or nullptr if there is none.  This is the
+         * same impl a linear search through each impl would find.
+         */
+        TraitImpl* find(TypeArgs const& typeArgs) const;
+
+        /** Every impl added, in the order they were added */
+        std::vector<TraitImpl*> const& getImpls() const noexcept {
+            return impls;
+        }
+
+    private:
+        struct Key {
+            TypeTag tag;
+            size_t arity;
+
+            /** The name of a data type, or empty for other types */
+            llvm::StringRef name;
+
+            bool operator<(Key const& other) const;
+        };
+
+        /** One token of a flattened type.  Its subtree ends at token end. */
+        struct Token {
+            Key key;
+            bool isTypeVar;
+            size_t end;
+        };
+
+        struct Node {
+            std::map<Key, std::unique_ptr<Node>> children;
+
+            /** The edge taken by impls with a type variable at this position */
+            std::unique_ptr<Node> anyType;
+
+            /** Indices into impls of each impl whose path ends here */
+            std::vector<size_t> implsHere;
+        };
+
+        static void flatten(TypeArgs const& typeArgs, std::vector<Token> &tokens);
+        static void flatten(const AnType *type, std::vector<Token> &tokens);
+
+        /** Add the index of each impl matching tokens[i..] from the given node */
+        static void collect(const Node *node, std::vector<Token> const& tokens, size_t i,
+                std::vector<size_t> &matches);
+
+        std::unique_ptr<Node> root;
+        std::vector<TraitImpl*> impls;
+    };
+}
+
+#endif /* end of include guard: AN_TRAITIMPLINDEX_H */
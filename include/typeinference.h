@@ -2,6 +2,7 @@
 #define AN_TYPEINFERENCEVISITOR_H
 
 #include <chrono>
+#include <llvm/ADT/DenseSet.h>
 
 #include "parser.h"
 #include "antype.h"
@@ -13,6 +14,11 @@
 namespace ante {
     AnType* applySubstitutions(Substitutions const& substitutions, AnType *t);
 
+    /** Split the given functions into the strongly connected components of their call
+     *  graph, returned in dependency order so each component only calls functions
+     *  within itself or an earlier component. */
+    std::vector<std::vector<parser::FuncDeclNode*>> findCallGraphComponents(std::vector<parser::FuncDeclNode*> const& fns);
+
     /**
      * Perform type inference on a parse tree.
      * This consists of several steps:
@@ -43,7 +49,7 @@ namespace ante {
             auto substitutions = unify(constraints);
 
             auto substart = high_resolution_clock::now();
-            SubstitutingVisitor::substituteIntoAst(n, substitutions, module);
+            SubstitutingVisitor::substituteIntoAst(n, substitutions);
             auto end = high_resolution_clock::now();
 
             if(showTimingInformation()){
@@ -66,6 +72,26 @@ namespace ante {
         }
 
         DECLARE_NODE_VISIT_METHODS();
+
+        private:
+        /** The declarations of the strongly connected component of the call graph
+         *  currently being inferred.  References to functions within it are not
+         *  generalized until the whole component is solved. */
+        llvm::DenseSet<Declaration*> *component = nullptr;
+
+        /** Infer the types of each top-level function and method of the given module
+         *  one call graph component at a time, callees before their callers.
+         *  Components are inferred serially while the typeArena's nursery is open. */
+        void inferFunctions(parser::RootNode *n);
+
+        /** Infer and generalize the types of a set of mutually recursive functions
+         *  using only the constraints found within their bodies. */
+        void inferComponent(std::vector<parser::FuncDeclNode*> const& functions);
+
+        /** Infer each component on compilerJobs() threads, starting each once
+         *  every component it calls is finished.  The components must be in
+         *  dependency order and diagnostics are shown in that same order. */
+        void inferInParallel(std::vector<std::vector<parser::FuncDeclNode*>> const& components);
     };
 }
 
@@ -4,10 +4,16 @@
 #include "antype.h"
 #include "typeerror.h"
 #include <tuple>
+#include <unordered_set>
 
 namespace ante {
     using Substitutions = std::list<std::pair<AnType*, AnType*>>;
 
+    /** A mapping from old to fresh typevars, used when instantiating generic types */
+    using TypeVarMap = std::unordered_map<const AnTypeVarType*, AnTypeVarType*>;
+
+    using TypeVarSet = std::unordered_set<const AnTypeVarType*>;
+
     class UnificationConstraint {
         using EqConstraint = std::pair<AnType*, AnType*>;
         using TypeClassConstraint = TraitImpl*;
@@ -49,29 +55,128 @@ namespace ante {
 
     using UnificationList = std::list<UnificationConstraint>;
 
+    /**
+     * The bindings found while solving a UnificationList.
+     *
+     * Type variables are kept in a union-find structure with path compression.
+     * Each variable is either a root or points to another variable it has been
+     * unified with, and each root may additionally hold a mutable binding slot
+     * containing the non-typevar type it has been unified with.  This lets each
+     * constraint be solved without re-applying every previous substitution to it.
+     */
+    class TypeBindings {
+        struct Node {
+            /** The variable this variable was unified with, or nullptr if it is a root */
+            AnTypeVarType *parent;
+
+            /** The type this variable is bound to.  Only set for roots. */
+            AnType *binding;
+        };
+
+        std::unordered_map<AnTypeVarType*, Node> nodes;
+
+        /** Each variable in nodes in the order it was bound, used to keep getSubstitutions deterministic. */
+        std::vector<AnTypeVarType*> boundVars;
+
+        Node& getNode(AnTypeVarType *tv);
+
+        AnTypeVarType* findRoot(AnTypeVarType *tv);
+
+        bool occurs(AnTypeVarType *root, AnType *t);
+
+        void bind(AnTypeVarType *root, AnType *t);
+
+        AnType* resolveHelper(AnType *t);
+
+    public:
+        /**
+         * Return the type t is currently bound to, looking through
+         * type variables one level deep.  The contained types of the
+         * result are not resolved.
+         */
+        AnType* find(AnType *t);
+
+        /** Return t with every bound type variable within it replaced by its binding. */
+        AnType* resolve(AnType *t);
+
+        TraitImpl* resolve(TraitImpl *t);
+
+        /**
+         * Enforce t1 = t2, updating the current bindings.
+         * Throws a TypeErrorContext if the types cannot be unified.
+         */
+        void unify(AnType *t1, AnType *t2);
+
+        /**
+         * Return the current bindings as a list of substitutions.
+         * Each substitution is fully resolved, so the order they
+         * are applied in does not matter.
+         */
+        Substitutions getSubstitutions();
+    };
+
     /** Substitute all instances of a given type subType in t with u.
      * Returns a new substituted type or t if subType was not contained within */
     AnType* substitute(AnType *u, AnType *subType, AnType *t, int recursionLimit = 10000);
 
     Substitutions unify(UnificationList const& list);
-    Substitutions unifyOne(AnType *t1, AnType *t2, TypeError const& errMsg);
+
+    /**
+     * Unify a single pair of types, issuing err and throwing a
+     * CtError if they cannot be unified.
+     */
+    Substitutions unifyOne(AnType *t1, AnType *t2, TypeError const& err);
 
     AnType* applySubstitutions(Substitutions const& substitutions, AnType *t);
     TraitImpl* applySubstitutions(Substitutions const& substitutions, TraitImpl *t);
 
-    AnTypeVarType* nextTypeVar();
+    /**
+     * Applies a single list of substitutions, eg. the result of one call
+     * to unify, to many types.  The result for each generic subtree is
+     * memoized so identical subtrees are only rewritten once and subtrees
+     * containing no substituted typevars are returned as-is.
+     *
+     * Each typevar is replaced simultaneously, so this matches
+     * applySubstitutions only if no replacement contains a typevar that
+     * is substituted elsewhere in the list.  This is always the case
+     * for the fully-resolved substitutions returned by unify.
+     */
+    class SubstitutionMemo {
+        std::unordered_map<const AnTypeVarType*, AnType*> replacements;
+        std::unordered_map<AnType*, AnType*> results;
+
+        AnType* applyHelper(AnType *t, int recursionLimit);
+
+    public:
+        SubstitutionMemo(Substitutions const& substitutions);
+
+        AnType* apply(AnType *t){
+            return applyHelper(t, 10000);
+        }
+
+        TraitImpl* apply(TraitImpl *t);
+
+        /** True if substituting into t would have no effect */
+        bool isUnchanged(const AnType *t) const;
+    };
+
+    /** Create a new, unnamed typevar */
+    AnTypeVarType* nextTypeVar(bool isRhoVar = false);
 
-    bool hasTypeVarNotInMap(const AnType *t, llvm::StringMap<const AnTypeVarType*> &map);
+    bool hasTypeVarNotInSet(const AnType *t, TypeVarSet &set);
 
-    AnType* copyWithNewTypeVars(AnType *t, std::unordered_map<std::string, AnTypeVarType*> &map);
+    AnType* copyWithNewTypeVars(AnType *t, TypeVarMap &map);
 
-    llvm::StringMap<const AnTypeVarType*> getAllContainedTypeVars(const AnType *t);
+    TypeVarSet getAllContainedTypeVars(const AnType *t);
 
-    void getAllContainedTypeVarsHelper(const AnType *t, llvm::StringMap<const AnTypeVarType*> &map);
+    void getAllContainedTypeVarsHelper(const AnType *t, TypeVarSet &set);
 
     template<typename T>
-    std::vector<T*> copyWithNewTypeVars(std::vector<T*> tys, std::unordered_map<std::string, AnTypeVarType*> &map);
+    std::vector<T*> copyWithNewTypeVars(std::vector<T*> tys, TypeVarMap &map);
 
+    /** Instantiate t by replacing every typevar within it with a fresh one.
+     *  Unlike the overload taking a TypeVarMap this needs no map since each
+     *  typevar is found by its index within t's typevar summary. */
     AnType* copyWithNewTypeVars(AnType *t);
 
     /** Remove any duplicate type class constraints and any constraints that are known to exist. */
@@ -25,6 +25,10 @@ namespace ante {
 
     bool showTimingInformation();
 
+    /** The number of threads imports may be parsed and types inferred on.  Defaults to 1 */
+    size_t compilerJobs();
+    void setCompilerJobs(size_t jobs);
+
     /** @brief Create a vector with a capacity of at least cap elements. */
     template<typename T> std::vector<T> vecOf(size_t cap){
         std::vector<T> vec;
@@ -44,6 +44,7 @@ void printHelp(){
     puts("\t-o <filename>\tspecify output name");
     puts("\t-p\t\tprint parse tree");
     puts("\t-O <number>\tSet optimization level. Arg of 0 = none, 3 = all");
+    puts("\t-j <number>\tParse imports and type check independent functions on up to this many threads");
     puts("\t-r\t\tcompile and run");
     puts("\t-help\t\tprint this message");
     puts("\t-lib\t\tcompile as library (include all functions in binary and compile to object file)");
@@ -74,6 +75,10 @@ int main(int argc, const char **argv){
     if(args->hasArg(Args::Help)) printHelp();
     if(args->hasArg(Args::NoColor)) colored_output = false;
 
+    // Type inference runs when each Compiler is constructed so this must be set beforehand
+    if(auto *arg = args->getArg(Args::Jobs))
+        setCompilerJobs(max(atoi(arg->arg.c_str()), 1));
+
     for(auto input : args->inputFiles){
         Compiler ante{input.c_str()};
         if(args->hasArg(Args::Parse)){
@@ -83,8 +88,6 @@ int main(int argc, const char **argv){
     }
     if(args->hasArg(Args::Eval) || (args->args.empty() && args->inputFiles.empty()))
         Compiler(0).eval();
-    if(yylexer)
-        delete yylexer;
     //delete args;
 
     auto end = high_resolution_clock::now();
@@ -4,9 +4,9 @@
 
 namespace ante {
     
-    bool AnteVisitor::isDeclaredInternally(std::string const& var) const {
+    bool AnteVisitor::isDeclaredInternally(Symbol var) const {
         for(auto &scope : varTable)
-            if(scope.find(var) != scope.end())
+            if(scope.count(var))
                 return true;
         return false;
     }
@@ -18,7 +18,7 @@ namespace ante {
         inAnteExpr = true;
     }
 
-    void AnteVisitor::declare(std::string const& var){
+    void AnteVisitor::declare(Symbol var){
         if(inAnteExpr)
             varTable.back().insert(var);
     }
@@ -146,7 +146,7 @@ namespace ante {
                     if(v->tval.type->hasModifier(Tok_Mut) && !v->tval.type->hasModifier(Tok_Ante)){
                         error("Cannot evaluate a mutable variable during compile-time.  Use 'ante mut' in its declaration instead if you wish to evaluate it.", n->loc);
                     }else if(v->assignments.back().assignmentExpr){
-                        visitExternalDecl(n->name, v->tval.type, v->assignments.back().assignmentExpr);
+                        visitExternalDecl(n->name.str(), v->tval.type, v->assignments.back().assignmentExpr);
                     }else{
                         error("Cannot find last assignment to variable used in ante expression.", n->loc);
                     }
@@ -167,7 +167,7 @@ namespace ante {
             n->ref_expr->accept(*this);
         }else{
             //declaration
-            if(parser::VarNode *vn = dynamic_cast<parser::VarNode*>(n->ref_expr)){
+            if(parser::VarNode *vn = dyn_cast<parser::VarNode>(n->ref_expr)){
                 declare(vn->name);
             }else{
                 error("Pattern-declarations currently unimplemented in ante expressions", n->ref_expr->loc);
@@ -45,6 +45,42 @@ namespace ante {
         return tvt && tvt->isRhoVar();
     }
 
+    uint64_t typeVarBit(const AnTypeVarType *tv){
+        return uint64_t(1) << (tv->id % 64);
+    }
+
+    bool typeVarIdLess(const AnTypeVarType *l, const AnTypeVarType *r){
+        return l->id < r->id;
+    }
+
+    bool AnType::containsTypeVar(const AnTypeVarType *tv) const {
+        if(!(typeVarMask & typeVarBit(tv)))
+            return false;
+        return std::binary_search(containedTypeVars.begin(), containedTypeVars.end(), tv, typeVarIdLess);
+    }
+
+    void AnType::addContainedTypeVars(const AnType *t){
+        if(t->containedTypeVars.empty())
+            return;
+
+        typeVarMask |= t->typeVarMask;
+        if(containedTypeVars.empty()){
+            containedTypeVars = t->containedTypeVars;
+            return;
+        }
+
+        llvm::SmallVector<AnTypeVarType*, 2> merged;
+        std::set_union(containedTypeVars.begin(), containedTypeVars.end(),
+                t->containedTypeVars.begin(), t->containedTypeVars.end(),
+                std::back_inserter(merged), typeVarIdLess);
+        containedTypeVars.swap(merged);
+    }
+
+    void AnType::addContainedTypeVars(vector<AnType*> const& types){
+        for(auto *t : types)
+            addContainedTypeVars(t);
+    }
+
     bool isGeneric(vector<AnType*> const& vec){
         for(auto *t : vec)
             if(t->isGeneric)
@@ -96,21 +132,13 @@ namespace ante {
         return CompilerDirectiveModifier::get(extTy->addModifiersTo(t), directive);
     }
 
-    template<typename Key, typename Val>
-    Val* search(unordered_map<Key, unique_ptr<Val>> &map, Key const& key){
-        auto it = map.find(key);
-        if(it != map.end())
-            return it->second.get();
-        return nullptr;
-    }
-
-    template<typename Key, typename Val>
-    void addKVPair(unordered_map<Key, unique_ptr<Val>> &map, Key const& key, Val* val){
-        if(map[key]){
-            cerr << lazy_str("WARNING", AN_WARN_COLOR) << ": Hash collision between "
-                << anTypeToColoredStr(map[key].get()) << " and " << anTypeToColoredStr(val) << endl;
+    template<typename T>
+    size_t hashAll(size_t seed, vector<T*> const& elems){
+        size_t ret = hashCombine(seed, elems.size());
+        for(auto *e : elems){
+            ret = hashCombine(ret, (size_t)e);
         }
-        map[key] = unique_ptr<Val>(val);
+        return ret;
     }
 
     AnType* AnType::getPrimitive(TypeTag tag){
@@ -201,14 +229,20 @@ namespace ante {
     }
 
     BasicModifier* BasicModifier::get(const AnType *modifiedType, TokenType mod){
-        auto key = make_pair((AnType*)modifiedType, mod);
-
-        auto *existing_ty = search(typeArena.basicModifiers, key);
-        if(existing_ty) return static_cast<BasicModifier*>(existing_ty);
+        auto kind = AnTypeContainer::IK_BasicModifier;
+        size_t hash = hashCombine(hashCombine(kind, (size_t)modifiedType), mod);
+        size_t slot;
+
+        auto &shard = typeArena.shardOf(hash);
+        lock_guard<mutex> lock{shard.mutex};
+        auto *existing_ty = typeArena.lookup<BasicModifier>(shard, kind, hash, [&](BasicModifier *t){
+            return t->extTy == modifiedType && t->mod == mod;
+        }, slot);
+        if(existing_ty) return existing_ty;
 
-        auto ret = new BasicModifier(modifiedType, mod);
-        addKVPair(typeArena.basicModifiers, key, (AnModifier*)ret);
-        return ret;
+        auto ret = new (typeArena.allocate<BasicModifier>(shard)) BasicModifier(modifiedType, mod);
+        ret->addContainedTypeVars(modifiedType);
+        return typeArena.insert(shard, slot, kind, hash, ret);
     }
 
     /** NOTE: this treats all directives as different and will break
@@ -216,59 +250,80 @@ namespace ante {
      * problematic as it is impossible to compare the arbitrary expressions
      * anyways. */
     CompilerDirectiveModifier* CompilerDirectiveModifier::get(const AnType *modifiedType, Node *directive){
-        auto key = make_pair((AnType*)modifiedType, (size_t)directive);
-
-        auto *existing_ty = search(typeArena.cdModifiers, key);
-        if(existing_ty) return static_cast<CompilerDirectiveModifier*>(existing_ty);
+        auto kind = AnTypeContainer::IK_DirectiveModifier;
+        size_t hash = hashCombine(hashCombine(kind, (size_t)modifiedType), (size_t)directive);
+        size_t slot;
+
+        auto &shard = typeArena.shardOf(hash);
+        lock_guard<mutex> lock{shard.mutex};
+        auto *existing_ty = typeArena.lookup<CompilerDirectiveModifier>(shard, kind, hash, [&](CompilerDirectiveModifier *t){
+            return t->extTy == modifiedType && t->directive == directive;
+        }, slot);
+        if(existing_ty) return existing_ty;
 
-        auto ret = new CompilerDirectiveModifier(modifiedType, directive);
-        addKVPair(typeArena.cdModifiers, key, (AnModifier*)ret);
-        return ret;
+        auto ret = new (typeArena.allocate<CompilerDirectiveModifier>(shard)) CompilerDirectiveModifier(modifiedType, directive);
+        ret->addContainedTypeVars(modifiedType);
+        return typeArena.insert(shard, slot, kind, hash, ret);
     }
 
     AnPtrType* AnType::getPtr(AnType* ext){ return AnPtrType::get(ext); }
     AnPtrType* AnPtrType::get(AnType* ext){
-        try{
-            auto *ptr = typeArena.ptrTypes.at(ext).get();
-            return ptr;
-        }catch(out_of_range &r){
-            auto ptr = new AnPtrType(ext);
-            typeArena.ptrTypes.emplace(ext, unique_ptr<AnPtrType>(ptr));
-            return ptr;
-        }
+        auto kind = AnTypeContainer::IK_Ptr;
+        size_t hash = hashCombine(kind, (size_t)ext);
+        size_t slot;
+
+        auto &shard = typeArena.shardOf(hash);
+        lock_guard<mutex> lock{shard.mutex};
+        auto *existing_ty = typeArena.lookup<AnPtrType>(shard, kind, hash, [&](AnPtrType *t){
+            return t->extTy == ext;
+        }, slot);
+        if(existing_ty) return existing_ty;
+
+        auto ptr = new (typeArena.allocate<AnPtrType>(shard)) AnPtrType(ext);
+        ptr->addContainedTypeVars(ext);
+        return typeArena.insert(shard, slot, kind, hash, ptr);
     }
 
     AnArrayType* AnType::getArray(AnType* t, size_t len){ return AnArrayType::get(t,len); }
     AnArrayType* AnArrayType::get(AnType* t, size_t len){
-        auto key = make_pair(t, len);
-
-        auto existing_ty = search(typeArena.arrayTypes, key);
+        auto kind = AnTypeContainer::IK_Array;
+        size_t hash = hashCombine(hashCombine(kind, (size_t)t), len);
+        size_t slot;
+
+        auto &shard = typeArena.shardOf(hash);
+        lock_guard<mutex> lock{shard.mutex};
+        auto *existing_ty = typeArena.lookup<AnArrayType>(shard, kind, hash, [&](AnArrayType *arr){
+            return arr->extTy == t && arr->len == len;
+        }, slot);
         if(existing_ty) return existing_ty;
 
-        auto arr = new AnArrayType(t, len);
-        addKVPair(typeArena.arrayTypes, key, arr);
-        return arr;
+        auto arr = new (typeArena.allocate<AnArrayType>(shard)) AnArrayType(t, len);
+        arr->addContainedTypeVars(t);
+        return typeArena.insert(shard, slot, kind, hash, arr);
     }
 
     AnTupleType* AnTupleType::get(vector<AnType*> const& fields){
-
-        auto existing_ty = search(typeArena.aggregateTypes, fields);
-        if(existing_ty) return existing_ty;
-
-        auto agg = new AnTupleType(fields, {});
-        addKVPair(typeArena.aggregateTypes, fields, agg);
-        return agg;
+        return AnTupleType::getAnonRecord(fields, {});
     }
 
+    /** Tuples and anonymous records are both uniqued by their field types alone,
+     *  so a record's field names are those of the first record created with its fields. */
     AnTupleType* AnTupleType::getAnonRecord(vector<AnType*> const& fields,
             vector<string> const& fieldNames){
-
-        auto existing_ty = search(typeArena.aggregateTypes, fields);
+        auto kind = AnTypeContainer::IK_Tuple;
+        size_t hash = hashAll(kind, fields);
+        size_t slot;
+
+        auto &shard = typeArena.shardOf(hash);
+        lock_guard<mutex> lock{shard.mutex};
+        auto *existing_ty = typeArena.lookup<AnTupleType>(shard, kind, hash, [&](AnTupleType *t){
+            return t->fields == fields;
+        }, slot);
         if(existing_ty) return existing_ty;
 
-        auto agg = new AnTupleType(fields, fieldNames);
-        addKVPair(typeArena.aggregateTypes, fields, agg);
-        return agg;
+        auto agg = new (typeArena.allocate<AnTupleType>(shard)) AnTupleType(fields, fieldNames);
+        agg->addContainedTypeVars(fields);
+        return typeArena.insert(shard, slot, kind, hash, agg);
     }
 
     AnFunctionType* AnFunctionType::get(AnType* retty,
@@ -288,17 +343,32 @@ namespace ante {
     AnFunctionType* AnFunctionType::get(AnType *retTy, vector<AnType*> const& elems,
             vector<TraitImpl*> const& tcConstrains, bool isMetaFunction){
 
-        auto const& params = elems.empty() ? vector<AnType*>{AnType::getUnit()} : elems;
+        vector<AnType*> unitParam;
+        if(elems.empty())
+            unitParam.push_back(AnType::getUnit());
 
-        auto key = make_pair(retTy, make_pair(params, make_pair(tcConstrains, isMetaFunction)));
+        auto const& params = elems.empty() ? unitParam : elems;
 
-        auto existing_ty = search(typeArena.functionTypes, key);
-        if(existing_ty) return existing_ty;
+        auto kind = AnTypeContainer::IK_Function;
+        size_t hash = hashAll(hashAll(hashCombine(kind, (size_t)retTy), params), tcConstrains);
+        hash = hashCombine(hash, isMetaFunction);
+        size_t slot;
 
-        auto f = new AnFunctionType(retTy, params, tcConstrains, isMetaFunction);
+        TypeTag tag = isMetaFunction ? TT_MetaFunction : TT_Function;
+        auto &shard = typeArena.shardOf(hash);
+        lock_guard<mutex> lock{shard.mutex};
+        auto *existing_ty = typeArena.lookup<AnFunctionType>(shard, kind, hash, [&](AnFunctionType *f){
+            return f->typeTag == tag && f->retTy == retTy && f->paramTys == params
+                && f->typeClassConstraints == tcConstrains;
+        }, slot);
+        if(existing_ty) return existing_ty;
 
-        addKVPair(typeArena.functionTypes, key, f);
-        return f;
+        auto f = new (typeArena.allocate<AnFunctionType>(shard)) AnFunctionType(retTy, params, tcConstrains, isMetaFunction);
+        f->addContainedTypeVars(retTy);
+        f->addContainedTypeVars(params);
+        for(auto *tc : tcConstrains)
+            f->addContainedTypeVars(tc->typeArgs);
+        return typeArena.insert(shard, slot, kind, hash, f);
     }
 
 
@@ -307,21 +377,63 @@ namespace ante {
     }
 
     AnTypeVarType* AnTypeVarType::get(string const& name){
-        auto key = name;
-
-        auto existing_ty = search(typeArena.typeVarTypes, key);
-        if(existing_ty) return existing_ty;
+        lock_guard<mutex> lock{typeArena.typeVarMutex};
+        auto it = typeArena.typeVarNames.find(name);
+        if(it != typeArena.typeVarNames.end())
+            return it->second;
+
+        size_t len = name.size();
+        bool isRho = len > 3 && name[len-3] == '.' && name[len-2] == '.' && name[len-1] == '.';
+
+        size_t id = typeArena.typeVarTypes.size();
+        auto &shard = typeArena.shards[id % AnTypeContainer::internShardCount];
+        AnTypeVarType *tvar;
+        {
+            lock_guard<mutex> shardLock{shard.mutex};
+            tvar = new (typeArena.allocate<AnTypeVarType>(shard)) AnTypeVarType(id, name, isRho);
+        }
+        tvar->containedTypeVars.push_back(tvar);
+        tvar->typeVarMask = typeVarBit(tvar);
+        typeArena.adopt(tvar);
+        typeArena.typeVarTypes.push_back(tvar);
+        typeArena.typeVarNames[name] = tvar;
+        return tvar;
+    }
 
-        auto tvar = new AnTypeVarType(name);
-        addKVPair(typeArena.typeVarTypes, key, tvar);
+    AnTypeVarType* AnTypeVarType::getFresh(bool isRhoVar){
+        size_t id = typeArena.nextTypeVarId();
+        auto &shard = typeArena.shards[id % AnTypeContainer::internShardCount];
+        AnTypeVarType *tvar;
+        {
+            lock_guard<mutex> lock{shard.mutex};
+            tvar = new (typeArena.allocate<AnTypeVarType>(shard)) AnTypeVarType(id, "", isRhoVar);
+        }
+        tvar->containedTypeVars.push_back(tvar);
+        tvar->typeVarMask = typeVarBit(tvar);
+        typeArena.adopt(tvar);
+        typeArena.registerTypeVar(tvar);
         return tvar;
     }
 
+    std::string const& AnTypeVarType::getName() const {
+        lock_guard<mutex> lock{typeArena.typeVarMutex};
+        if(name.empty()){
+            //Never take the name of another typevar, e.g. one the user wrote as 'id
+            string base = '\'' + to_string(id);
+            string suffix = rho ? "..." : "";
+            string candidate = base + suffix;
+            for(size_t i = 1; !typeArena.typeVarNames.emplace(candidate, const_cast<AnTypeVarType*>(this)).second; i++)
+                candidate = base + '_' + to_string(i) + suffix;
+            name = move(candidate);
+        }
+        return name;
+    }
+
 
     bool AnProductType::isTypeFamily() const noexcept {
         if(!isAlias || fields.size() != 1) return false;
-        auto tv = try_cast<AnTypeVarType>(fields[0]);
-        return tv->name[1] >= 'A' && tv->name[1] <= 'Z';
+        auto &name = try_cast<AnTypeVarType>(fields[0])->getName();
+        return name[1] >= 'A' && name[1] <= 'Z';
     }
 
 
@@ -338,9 +450,11 @@ namespace ante {
         if(parent->unboundType)
             parent = static_cast<AnProductType*>(parent->unboundType);
 
+        lock_guard<mutex> lock{typeArena.variantMutex};
         auto ret = new AnProductType(parent->name, {parent->fields[0]});
         ret->typeArgs = typeArgs;
         ret->isGeneric = ante::isGeneric(typeArgs);
+        ret->addContainedTypeVars(typeArgs);
         ret->isAlias = true;
         addVariant(parent, ret);
         return ret;
@@ -352,6 +466,7 @@ namespace ante {
         auto family = new AnProductType(name, {typeFamilyTypeVar});
         family->typeArgs = typeArgs;
         family->isGeneric = ante::isGeneric(typeArgs);
+        family->addContainedTypeVars(typeArgs);
         family->isAlias = true;
         return family;
     }
@@ -384,6 +499,7 @@ namespace ante {
         AnProductType* decl = new AnProductType(name, elems);
         decl->typeArgs = typeArgs;
         decl->isGeneric = !typeArgs.empty();
+        decl->addContainedTypeVars(typeArgs);
         return decl;
     }
 
@@ -393,6 +509,7 @@ namespace ante {
         AnSumType* decl = new AnSumType(name, unionMembers);
         decl->typeArgs = typeArgs;
         decl->isGeneric = !typeArgs.empty();
+        decl->addContainedTypeVars(typeArgs);
         return decl;
     }
 
@@ -417,6 +534,7 @@ namespace ante {
         if(parent->unboundType)
             parent = static_cast<AnProductType*>(parent->unboundType);
 
+        lock_guard<mutex> lock{typeArena.variantMutex};
         auto it = findVariant(parent, typeArgs);
         if(it != parent->genericVariants.end()){
             return *it;
@@ -425,6 +543,7 @@ namespace ante {
         auto ret = new AnProductType(parent->name, elems);
         ret->typeArgs = typeArgs;
         ret->isGeneric = ante::isGeneric(typeArgs);
+        ret->addContainedTypeVars(typeArgs);
         ret->fieldNames = parent->fieldNames;
         ret->parentUnionType = nullptr; //parentUnionType needs to be bound separately
         addVariant(parent, ret);
@@ -441,15 +560,26 @@ namespace ante {
         if(parent->unboundType)
             parent = static_cast<AnSumType*>(parent->unboundType);
 
+        lock_guard<mutex> lock{typeArena.variantMutex};
         auto it = findVariant(parent, typeArgs);
+        AnSumType *ret;
         if(it != parent->genericVariants.end()){
-            return *it;
+            ret = *it;
+        }else{
+            ret = new AnSumType(parent->name, elems);
+            ret->typeArgs = typeArgs;
+            ret->isGeneric = ante::isGeneric(typeArgs);
+            ret->addContainedTypeVars(typeArgs);
+            addVariant(parent, ret);
         }
 
-        auto ret = new AnSumType(parent->name, elems);
-        ret->typeArgs = typeArgs;
-        ret->isGeneric = ante::isGeneric(typeArgs);
-        addVariant(parent, ret);
+        //Bind the tags' parentUnionType while still holding variantMutex, other
+        //components may find these variants and read it as soon as the lock is released
+        for(auto *tag : elems){
+            if(!tag->parentUnionType){
+                tag->parentUnionType = ret;
+            }
+        }
         return ret;
     }
 
@@ -465,7 +595,11 @@ namespace ante {
     }
 
     //Constructor for AnTypeContainer, initializes all primitive types beforehand
-    AnTypeContainer::AnTypeContainer(){
+    AnTypeContainer::AnTypeContainer() : concurrent(false), concurrentSection(0),
+            nurseryOpen(false), nurseryTypeVarStart(0){
+        for(auto &shard : shards)
+            shard.table.resize(64, InternSlot{nullptr, IK_Ptr});
+
         primitiveTypes[TT_I8].reset(new AnType(TT_I8, false));
         primitiveTypes[TT_I16].reset(new AnType(TT_I16, false));
         primitiveTypes[TT_I32].reset(new AnType(TT_I32, false));
@@ -487,6 +621,163 @@ namespace ante {
     }
 
 
+    //The arena's memory is freed all at once, but the types within it still own
+    //vectors and strings so their destructors must be run manually.
+    AnTypeContainer::~AnTypeContainer(){
+        for(auto &shard : shards){
+            for(auto &entry : shard.table){
+                if(entry.type)
+                    release(entry.type);
+            }
+        }
+        for(auto *tvar : typeVarTypes){
+            if(tvar)
+                release(tvar);
+        }
+    }
+
+
+    void AnTypeContainer::release(AnType *type){
+        bool ownsMemory = type->generation != TG_Persistent;
+        type->~AnType();
+        if(ownsMemory)
+            ::operator delete(type);
+    }
+
+
+    void AnTypeContainer::grow(InternShard &shard){
+        vector<InternSlot> oldTable(shard.table.size() * 2, InternSlot{nullptr, IK_Ptr});
+        oldTable.swap(shard.table);
+
+        size_t mask = shard.table.size() - 1;
+        for(auto &entry : oldTable){
+            if(!entry.type) continue;
+
+            size_t i = slotOf(shard, entry.type->structuralHash);
+            while(shard.table[i].type)
+                i = (i + 1) & mask;
+            shard.table[i] = entry;
+        }
+    }
+
+
+    void AnTypeContainer::erase(AnType *type){
+        auto &shard = shardOf(type->structuralHash);
+        auto &table = shard.table;
+        size_t mask = table.size() - 1;
+        size_t i = slotOf(shard, type->structuralHash);
+        while(table[i].type != type)
+            i = (i + 1) & mask;
+
+        //Shift back any later entries in the same probe sequence which
+        //could no longer be found once slot i is empty
+        for(size_t j = (i + 1) & mask; table[j].type; j = (j + 1) & mask){
+            size_t home = slotOf(shard, table[j].type->structuralHash);
+            bool reachableFromJ = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if(!reachableFromJ){
+                table[i] = table[j];
+                i = j;
+            }
+        }
+        table[i].type = nullptr;
+        shard.count--;
+    }
+
+
+    void AnTypeContainer::openNursery(){
+        nurseryOpen = true;
+        nurseryTypeVarStart = typeVarTypes.size();
+    }
+
+
+    void AnTypeContainer::promote(TraitImpl *trait){
+        for(auto *typeArg : trait->typeArgs)
+            promote(typeArg);
+    }
+
+
+    void AnTypeContainer::promote(AnType *type){
+        if(!nurseryOpen) return;
+
+        vector<AnType*> worklist{type};
+        while(!worklist.empty()){
+            AnType *t = worklist.back();
+            worklist.pop_back();
+            if(!t) continue;
+
+            if(t->isModifierType()){
+                if(t->generation == TG_Nursery){
+                    t->generation = TG_Promoted;
+                    worklist.push_back((AnType*)static_cast<AnModifier*>(t)->extTy);
+                }
+            }else if(auto *dt = try_cast<AnDataType>(t)){
+                if(!promotedDataTypes.insert(dt).second) continue;
+
+                worklist.insert(worklist.end(), dt->typeArgs.begin(), dt->typeArgs.end());
+                worklist.push_back(dt->unboundType);
+                for(auto &llvmTy : dt->llvmTypes)
+                    worklist.insert(worklist.end(), llvmTy.first.begin(), llvmTy.first.end());
+
+                if(auto *pt = try_cast<AnProductType>(dt)){
+                    worklist.insert(worklist.end(), pt->fields.begin(), pt->fields.end());
+                    worklist.insert(worklist.end(), pt->genericVariants.begin(), pt->genericVariants.end());
+                    worklist.push_back(pt->parentUnionType);
+                }else if(auto *st = try_cast<AnSumType>(dt)){
+                    worklist.insert(worklist.end(), st->tags.begin(), st->tags.end());
+                    worklist.insert(worklist.end(), st->genericVariants.begin(), st->genericVariants.end());
+                }
+            }else if(t->generation == TG_Nursery){
+                t->generation = TG_Promoted;
+
+                if(auto *ptr = try_cast<AnPtrType>(t)){
+                    worklist.push_back(ptr->extTy);
+                }else if(auto *arr = try_cast<AnArrayType>(t)){
+                    worklist.push_back(arr->extTy);
+                }else if(auto *tup = try_cast<AnTupleType>(t)){
+                    worklist.insert(worklist.end(), tup->fields.begin(), tup->fields.end());
+                }else if(auto *fn = try_cast<AnFunctionType>(t)){
+                    worklist.push_back(fn->retTy);
+                    worklist.insert(worklist.end(), fn->paramTys.begin(), fn->paramTys.end());
+                    for(auto *tc : fn->typeClassConstraints)
+                        worklist.insert(worklist.end(), tc->typeArgs.begin(), tc->typeArgs.end());
+                }
+            }
+        }
+    }
+
+
+    void AnTypeContainer::collectNursery(){
+        for(auto &shard : shards){
+            for(auto *type : shard.nursery){
+                if(type->generation == TG_Nursery){
+                    erase(type);
+                    release(type);
+                }
+            }
+            shard.nursery.clear();
+        }
+
+        for(size_t i = nurseryTypeVarStart; i < typeVarTypes.size(); i++){
+            auto *tvar = typeVarTypes[i];
+            if(!tvar || tvar->generation != TG_Nursery) continue;
+
+            auto name = typeVarNames.find(tvar->name);
+            if(name != typeVarNames.end() && name->second == tvar)
+                typeVarNames.erase(name);
+
+            release(tvar);
+            typeVarTypes[i] = nullptr;
+        }
+
+        //Typevar ids are indices into typeVarTypes so only trailing ids can be reused
+        while(!typeVarTypes.empty() && !typeVarTypes.back())
+            typeVarTypes.pop_back();
+
+        promotedDataTypes.clear();
+        nurseryOpen = false;
+    }
+
+
     AnType* AnType::getFunctionReturnType() const{
         return try_cast<AnFunctionType>(this)->retTy;
     }
@@ -798,4 +1089,71 @@ namespace ante {
         }
         ASSERT_UNREACHABLE("Unknown TypeTag in AnType::approxEq");
     }
+
+
+    /** Typevar ids reserved by the current thread while the typeArena is concurrent */
+    struct TypeVarIdBlock {
+        /** The concurrent section these ids were reserved in */
+        size_t section = 0;
+        size_t next = 0;
+        size_t end = 0;
+
+        /** Typevars created by this thread which are not yet in typeVarTypes */
+        vector<AnTypeVarType*> pending;
+    };
+
+    static thread_local TypeVarIdBlock typeVarIdBlock;
+
+    /** How many typevar ids a thread reserves at once while concurrent */
+    const size_t typeVarIdBlockSize = 1024;
+
+
+    size_t AnTypeContainer::nextTypeVarId(){
+        if(!concurrent)
+            return typeVarTypes.size();
+
+        auto &block = typeVarIdBlock;
+        if(block.section != concurrentSection || block.next == block.end){
+            lock_guard<mutex> lock{typeVarMutex};
+            block.section = concurrentSection;
+            block.next = typeVarTypes.size();
+            block.end = block.next + typeVarIdBlockSize;
+            typeVarTypes.resize(block.end, nullptr);
+        }
+        return block.next++;
+    }
+
+
+    void AnTypeContainer::registerTypeVar(AnTypeVarType *tvar){
+        if(concurrent){
+            typeVarIdBlock.pending.push_back(tvar);
+        }else{
+            typeVarTypes.push_back(tvar);
+        }
+    }
+
+
+    void AnTypeContainer::beginConcurrent(){
+        assert(!nurseryOpen && "The nursery cannot be used while the typeArena is concurrent");
+        concurrent = true;
+        concurrentSection++;
+    }
+
+
+    void AnTypeContainer::flushTypeVars(){
+        auto &pending = typeVarIdBlock.pending;
+        if(pending.empty())
+            return;
+
+        lock_guard<mutex> lock{typeVarMutex};
+        for(auto *tvar : pending)
+            typeVarTypes[tvar->id] = tvar;
+        pending.clear();
+    }
+
+
+    void AnTypeContainer::endConcurrent(){
+        flushTypeVars();
+        concurrent = false;
+    }
 }
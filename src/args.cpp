@@ -12,6 +12,7 @@ map<string, Args> argsMap = {
     {"-emit-llvm", Args::EmitLLVM},
     {"-e",         Args::Eval},
     {"-help",      Args::Help},
+    {"-j",         Args::Jobs},
     {"-lib",       Args::Lib},
     {"-no-color",  Args::NoColor},
     {"-O",         Args::OptLvl},
@@ -52,7 +53,7 @@ ArgTy requiresArg(Args a){
     if(a == OutputName)
         return ArgTy::Str;
 
-    if(a == OptLvl)
+    if(a == OptLvl || a == Jobs)
         return ArgTy::Int;
 
     return ArgTy::None;
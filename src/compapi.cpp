@@ -27,7 +27,7 @@ extern "C" {
         FuncDecl *f = fd.castTo<FuncDecl*>();
         string n = f->getName();
 
-        yy::location lloc = mkLoc(mkPos(0,0,0), mkPos(0,0,0));
+        LOC_TY lloc;
         auto *strlit = new StrLitNode(lloc, n);
 
         return new TypedValue(CompilingVisitor::compile(c, strlit));
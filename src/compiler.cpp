@@ -20,6 +20,7 @@
 #include <chrono>
 
 #include "parser.h"
+#include "parsecontext.h"
 #include "compiler.h"
 #include "function.h"
 #include "types.h"
@@ -377,7 +378,7 @@ void CompilingVisitor::visit(ForNode *n){
     auto subs = unifyOne(n->pattern->getType(), uwrap.type, err);
     c->compCtxt->insertMonomorphisationMappings(subs);
 
-    auto vn = dynamic_cast<VarNode*>(n->pattern.get());
+    auto vn = dyn_cast<VarNode>(n->pattern.get());
     if(vn){
         vn->decl->tval = uwrap;
     }
@@ -486,7 +487,7 @@ void CompilingVisitor::visit(VarNode *n){
     }
     val = n->decl->tval;
     if(n->decl->tval.type->hasModifier(Tok_Mut) && val.val->getType()->isPointerTy()){
-        val.val = c->builder.CreateLoad(val.val, n->name);
+        val.val = c->builder.CreateLoad(val.val, n->name.ref());
     }
 }
 
@@ -500,7 +501,7 @@ void CompilingVisitor::visit(VarNode *n){
  */
 void compMutBinding(VarAssignNode *node, CompilingVisitor &cv){
     Compiler *c = cv.c;
-    if(!dynamic_cast<VarNode*>(node->ref_expr))
+    if(!isa<VarNode>(node->ref_expr))
         error("Unknown pattern for l-expr", node->expr->loc);
 
     auto *decl = static_cast<VarNode*>(node->ref_expr)->decl;
@@ -535,7 +536,7 @@ void compMutBinding(VarAssignNode *node, CompilingVisitor &cv){
 
 void compLetBinding(VarAssignNode *node, CompilingVisitor &cv){
     Compiler *c = cv.c;
-    if(!dynamic_cast<VarNode*>(node->ref_expr))
+    if(!isa<VarNode>(node->ref_expr))
         error("Unknown pattern for l-expr", node->expr->loc);
 
     auto *decl = static_cast<VarNode*>(node->ref_expr)->decl;
@@ -585,7 +586,7 @@ TypedValue compFieldInsert(Compiler *c, BinOpNode *bop, Node *expr){
 
     //A . operator can also have a type/module as its lval, but its
     //impossible to insert into a non-value so fail if the lvalue is one
-    if(auto *tn = dynamic_cast<TypeNode*>(bop->lval.get()))
+    if(auto *tn = dyn_cast<TypeNode>(bop->lval.get()))
         error("Cannot insert value into static module '" +
                 anTypeToColoredStr(toAnType(tn, c->compUnit)), tn->loc);
 
@@ -635,7 +636,7 @@ TypedValue compFieldInsert(Compiler *c, BinOpNode *bop, Node *expr){
         }
     }
 
-    error("Method/Field " + field->name + " not found in type " + anTypeToColoredStr(tyn), bop->loc);
+    error("Method/Field " + field->name.str() + " not found in type " + anTypeToColoredStr(tyn), bop->loc);
     return {};
 }
 
@@ -670,7 +671,7 @@ void CompilingVisitor::visit(VarAssignNode *n){
     //If this is an insert value (where the lval resembles var[index] = ...)
     //then this must be instead compiled with compInsert, otherwise the [ operator
     //would retrieve the value at the index instead of the reference for storage.
-    if(BinOpNode *bop = dynamic_cast<BinOpNode*>(n->ref_expr)){
+    if(BinOpNode *bop = dyn_cast<BinOpNode>(n->ref_expr)){
         if(bop->op == '#'){
             this->val = c->compInsert(bop, n->expr.get());
             return;
@@ -1184,22 +1185,14 @@ Compiler::Compiler(const char *_fileName, bool lib, shared_ptr<LLVMContext> llvm
         scope(0), optLvl(2), fnScope(1){
 
     if(_fileName){
-        string* fileName_cpy = new string(fileName);
-        setLexer(new Lexer(fileName_cpy));
-        yy::parser p{};
-        int flag = p.parse();
+        ParseContext parseCtxt{new Lexer(&fileName)};
+        int flag = parseCtxt.parse();
         if(flag != PE_OK){ //parsing error, cannot procede
-            //print out remaining errors
-            int tok;
-            yy::location loc;
-            while((tok = yylexer->next(&loc)) != Tok_Newline && tok != 0);
-            while(p.parse() != PE_OK && yylexer->peek() != 0);
-
             fputs("Syntax error, aborting.\n", stderr);
             exit(flag);
         }
 
-        RootNode* root = parser::getRootNode();
+        RootNode* root = parseCtxt.root;
         this->ast = root;
     }
 
@@ -1246,6 +1239,15 @@ bool showTimingInformation() {
     return showTimingInformationGlobal;
 }
 
+size_t compilerJobsGlobal = 1;
+size_t compilerJobs() {
+    return compilerJobsGlobal;
+}
+
+void setCompilerJobs(size_t jobs) {
+    compilerJobsGlobal = jobs;
+}
+
 void Compiler::processArgs(CompilerArgs *args){
     string out = "";
     bool shouldGenerateExecutable = true;
@@ -1306,11 +1308,6 @@ void Compiler::processArgs(CompilerArgs *args){
     }
 }
 
-Compiler::~Compiler(){
-    if(yylexer){
-        delete yylexer;
-        yylexer = 0;
-    }
-}
+Compiler::~Compiler(){}
 
 } //end of namespace ante
@@ -88,10 +88,13 @@ namespace ante {
 
         auto variant = try_cast<AnProductType>(n->typeExpr->getType());
         if(variant){
-            TupleNode *tn = dynamic_cast<TupleNode*>(n->rval.get());
+            TupleNode *tn = dyn_cast<TupleNode>(n->rval.get());
 
             size_t argc = tn ? tn->exprs.size() : 1;
-            size_t offset = variant->parentUnionType ? 1 : 0;
+            //Whether this is a union tag is fixed when the type is declared, so read it from the
+            //unbound type rather than from a variant whose parentUnionType may still be bound later
+            auto declared = variant->unboundType ? static_cast<AnProductType*>(variant->unboundType) : variant;
+            size_t offset = declared->parentUnionType ? 1 : 0;
 
             if(variant->fields.size() - offset != argc){
                 auto lplural = variant->fields.size() == 1 + offset ? " argument, but " : " arguments, but ";
@@ -261,17 +264,17 @@ namespace ante {
                 + weregiven, loc);
     }
 
-    bool ConstraintFindingVisitor::findFieldInTypeList(llvm::StringMap<TypeDecl> const& m, BinOpNode *op, VarNode *rval) {
+    bool ConstraintFindingVisitor::findFieldInTypeList(llvm::DenseMap<Symbol, TypeDecl> const& m, BinOpNode *op, VarNode *rval) {
         for(auto &p : m){
             if(auto *pt = try_cast<AnProductType>(p.second.type)){
                 for(size_t i = 0; i < pt->fieldNames.size(); i++){
                     auto &field = pt->fieldNames[i];
-                    if(field == rval->name){
+                    if(field == rval->name.ref()){
                         auto ty = static_cast<AnProductType*>(copyWithNewTypeVars(pt));
                         addConstraint(op->lval->getType(), ty, op->loc,
                                 "Expected lval of . operator to be of type $2 but got $1");
                         addConstraint(rval->getType(), ty->fields[i], op->loc,
-                                "Expected field '" + rval->name + "' to be of type $2 but got $1");
+                                "Expected field '" + rval->name.str() + "' to be of type $2 but got $1");
                         addConstraint(op->getType(), ty->fields[i], op->loc,
                                 "Expected result of field access to be the type of the field, $2 but got $1");
                         return true;
@@ -283,14 +286,14 @@ namespace ante {
     }
 
     void ConstraintFindingVisitor::searchForField(BinOpNode *op) {
-        if(dynamic_cast<TypeNode*>(op->lval.get())){
+        if(isa<TypeNode>(op->lval.get())){
             // not a field access, just qualified name resolution
             return;
         }
 
-        VarNode *vn = dynamic_cast<VarNode*>(op->rval.get());
+        VarNode *vn = dyn_cast<VarNode>(op->rval.get());
         if(!vn){
-            auto tupleIndex = dynamic_cast<IntLitNode*>(op->rval.get());
+            auto tupleIndex = dyn_cast<IntLitNode>(op->rval.get());
             if(tupleIndex){
                 size_t idx = atoi(tupleIndex->val.c_str());
                 auto fields = vecOf<AnType*>(idx + 2);
@@ -300,9 +303,7 @@ namespace ante {
                 addConstraint(op->getType(), fields.back(), op->loc,
                         "Expected result of tuple member access of index " + to_string(idx) + " to be $2 but got $1 instead");
 
-                auto rho = nextTypeVar();
-                rho = AnTypeVarType::get(rho->name + "...");
-                fields.push_back(rho);
+                fields.push_back(nextTypeVar(true));
                 addConstraint(op->lval->getType(), AnTupleType::get(fields), op->loc,
                         "Expected lhs of . to be a tuple resembling $2 but found $1 instead");
             }else{
@@ -314,13 +315,11 @@ namespace ante {
         if(findFieldInTypeList(module->userTypes, op, vn))
             return;
 
-        for(Module *import : module->imports){
-            if(findFieldInTypeList(import->userTypes, op, vn))
-                return;
-        }
+        if(findFieldInTypeList(module->getImportedTypes(), op, vn))
+            return;
 
         show(vn);
-        error("No field named " + vn->name + " found for any type", vn->loc);
+        error("No field named " + vn->name.str() + " found for any type", vn->loc);
     }
 
     void ConstraintFindingVisitor::fnCallConstraints(BinOpNode *n){
@@ -540,9 +539,9 @@ namespace ante {
         }
     }
 
-    FuncDeclNode* getDecl(string const& name, const TraitDecl *t){
+    FuncDeclNode* getDecl(Symbol name, const TraitDecl *t){
         for(auto &fd : t->funcs){
-            if(fd->getName() == name) return fd->getFDN();
+            if(fd->getFDN()->name == name) return fd->getFDN();
         }
         return nullptr;
     }
@@ -566,7 +565,7 @@ namespace ante {
 
     AnType* findTypeFamilyImpl(ExtNode *en, string const& name, Module *m){
         for(auto &n : *en->methods){
-            auto ddn = dynamic_cast<DataDeclNode*>(&n);
+            auto ddn = dyn_cast<DataDeclNode>(&n);
             if(ddn && ddn->name == name){
                 return anTypeFromDataDecl(ddn, m);
             }
@@ -578,7 +577,7 @@ namespace ante {
         if(n->trait){
             auto tr = n->traitType;
             for(Node &m : *n->methods){
-                auto fdn = dynamic_cast<FuncDeclNode*>(&m);
+                auto fdn = dyn_cast<FuncDeclNode>(&m);
                 if(fdn){
                     auto *decl = getDecl(fdn->name, tr->decl);
                     fdn->setType(decl->getType());
@@ -661,13 +660,13 @@ namespace ante {
     }
 
     void ConstraintFindingVisitor::handlePattern(MatchNode *n, Node *pattern, AnType *expectedType, Pattern &patChecker){
-        if(TupleNode *tn = dynamic_cast<TupleNode*>(pattern)){
+        if(TupleNode *tn = dyn_cast<TupleNode>(pattern)){
             handleTuplePattern(n, tn, expectedType, patChecker);
 
-        }else if(TypeCastNode *tcn = dynamic_cast<TypeCastNode*>(pattern)){
+        }else if(TypeCastNode *tcn = dyn_cast<TypeCastNode>(pattern)){
             handleUnionVariantPattern(n, tcn, expectedType, patChecker);
 
-        }else if(TypeNode *tn = dynamic_cast<TypeNode*>(pattern)){
+        }else if(TypeNode *tn = dyn_cast<TypeNode>(pattern)){
             auto sumType = try_cast<AnSumType>(tn->getType());
             patChecker.overwrite(Pattern::fromSumType(sumType), tn->loc);
             auto idx = sumType->getTagVal(tn->typeName);
@@ -675,24 +674,24 @@ namespace ante {
             addConstraint(tn->getType(), expectedType, pattern->loc,
                 "Expected a $2 here from the union variant pattern, but found a $1 instead");
 
-        }else if(VarNode *vn = dynamic_cast<VarNode*>(pattern)){
+        }else if(VarNode *vn = dyn_cast<VarNode>(pattern)){
             addConstraint(expectedType, vn->getType(), pattern->loc,
                 "Expected the var pattern's type to be $1 from this match pattern but got $2 instead");
             patChecker.setMatched();
 
-        }else if(IntLitNode *iln = dynamic_cast<IntLitNode*>(pattern)){
+        }else if(IntLitNode *iln = dyn_cast<IntLitNode>(pattern)){
             auto ty = AnType::getPrimitive(iln->typeTag);
             patChecker.overwrite(Pattern::fromType(ty), iln->loc);
             addConstraint(ty, expectedType, pattern->loc,
                     "Expected this integer to be of type $2 from the match pattern, but got $1 instead");
 
-        }else if(FltLitNode *fln = dynamic_cast<FltLitNode*>(pattern)){
+        }else if(FltLitNode *fln = dyn_cast<FltLitNode>(pattern)){
             auto ty = AnType::getPrimitive(fln->typeTag);
             patChecker.overwrite(Pattern::fromType(ty), fln->loc);
             addConstraint(ty, expectedType, pattern->loc,
                     "Expected this float to be of type $2 from the match pattern, but got $1 instead");
 
-        }else if(dynamic_cast<StrLitNode*>(pattern)){
+        }else if(isa<StrLitNode>(pattern)){
             auto str = module->lookupType("Str");
             patChecker.overwrite(Pattern::fromType(str), pattern->loc);
             addConstraint(str, expectedType, pattern->loc,
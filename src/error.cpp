@@ -2,144 +2,156 @@
 #include "target.h"
 #include "error.h"
 #include "types.h"
+#include "sourcebuffer.h"
+
+#include <atomic>
 
 using namespace std;
 using namespace ante::parser;
 
 namespace ante {
 
-size_t globalErrorCount = 0;
+std::atomic<size_t> globalErrorCount{0};
 
-/*
- * Skips input in a given istream until it encounters the given coordinates,
- * with each newline signalling the end of a row.
- *
- * precondition: coordinates must be valid
- */
-void skipToLine(istream& ifs, unsigned int row){
-    unsigned int line = 1;
-    if(line != row){
-        while(true){
-            int c = ifs.get();
-            if(c == '\n'){
-                line++;
-                if(line >= row){
-                    break;
-                }
-            }else if(c == EOF){
-                break;
-            }
-        }
-    }
+/** Where diagnostics issued on the current thread are written, see setDiagnosticBuffer */
+thread_local DiagnosticBuffer *diagnosticBuffer = nullptr;
+
+ostream& diagnostics(){
+    return diagnosticBuffer ? diagnosticBuffer->out : cout;
+}
+
+void setDiagnosticBuffer(DiagnosticBuffer *buffer){
+    diagnosticBuffer = buffer;
+}
+
+void flushDiagnosticBuffer(DiagnosticBuffer &buffer){
+    diagnostics() << buffer.out.str() << flush;
+    buffer.out.str("");
 }
 
 void printErrorTypeColor(ErrorType t){
     if(colored_output){
         if(t == ErrorType::Error)
-            cout << AN_ERR_COLOR;
+            diagnostics() << AN_ERR_COLOR;
         else if(t == ErrorType::Warning)
-            cout << AN_WARN_COLOR;
+            diagnostics() << AN_WARN_COLOR;
         else
-            cout << AN_NOTE_COLOR;
+            diagnostics() << AN_NOTE_COLOR;
     }
 }
 
 void clearColor(){
     if(colored_output)
-        cout << AN_CONSOLE_RESET;
+        diagnostics() << AN_CONSOLE_RESET;
 }
 
 
 void setTermFGColor(AN_COLOR_TYPE fg){
     if(colored_output)
-        cout << fg;
+        diagnostics() << fg;
+}
+
+/** A SourceRange traced back to the buffer, lines, and columns it spans */
+struct DecodedLoc {
+    SourceBuffer *source;
+    LineAndColumn begin, end;
+};
+
+DecodedLoc decodeLoc(const SourceRange& loc){
+    SourceBuffer *source = SourceBuffer::find(loc.begin);
+    if(!source)
+        return {nullptr, {0, 0}, {0, 0}};
+
+    LineAndColumn begin = source->getLineAndColumn(loc.begin);
+    LineAndColumn end = SourceBuffer::find(loc.end) == source
+        ? source->getLineAndColumn(loc.end) : begin;
+    return {source, begin, end};
 }
 
 /*
  *  Prints a given line (row) of a file, along with an arrow pointing to
  *  the specified column.
  */
-void printErrLine(const yy::location& loc, ErrorType t){
-    if(!loc.begin.filename) return;
-    ifstream f{*loc.begin.filename};
+void printErrLine(const DecodedLoc& loc, ErrorType t){
+    ostream &out = diagnostics();
+    if(!loc.source) return;
 
     // highlight the whole first line if the error spans multiple lines
     unsigned int end_col = loc.begin.line == loc.end.line ? loc.end.column : -1;
 
-    //skip to line in question
-    skipToLine(f, loc.begin.line);
-
-    //print line
-    string s;
-    getline(f, s);
+    llvm::StringRef s = loc.source->getLine(loc.begin.line);
 
     for(size_t i = 0; i < s.size(); i++){
         if(i == loc.begin.column - 1){
             printErrorTypeColor(t);
         }else if(i == end_col){
-            cout << AN_CONSOLE_RESET;
+            out << AN_CONSOLE_RESET;
         }
-        cout << s[i];
+        out << s[i];
     }
 
     //draw arrow
     if(!colored_output){
-        putchar('\n');
+        out << '\n';
         printErrorTypeColor(t);
         unsigned int i = 1;
 
         //skip to begin pos and draw arrow until end pos
-        for(; i < loc.begin.column; i++) putchar(' ');
-        for(; i <= loc.end.column; i++) putchar('^');
+        for(; i < loc.begin.column; i++) out << ' ';
+        for(; i <= loc.end.column; i++) out << '^';
     }
 
     clearColor();
 }
 
-void printFileNameAndLineNumber(const yy::location& loc){
-    if(colored_output) cout << AN_CONSOLE_ITALICS;
+void printFileNameAndLineNumber(const DecodedLoc& loc){
+    ostream &out = diagnostics();
+    if(colored_output) out << AN_CONSOLE_ITALICS;
 
-    if (loc.begin.filename) cout << *loc.begin.filename;
-    else cout << "(unknown file)";
+    if (loc.source && !loc.source->getName().empty()) out << loc.source->getName();
+    else out << "(unknown file)";
 
     clearColor();
-    cout << ": ";
+    out << ": ";
 
-    if(colored_output) cout << AN_CONSOLE_BOLD;
-    cout << loc.begin.line << ",";
+    if(colored_output) out << AN_CONSOLE_BOLD;
+    out << loc.begin.line << ",";
 
-    if(loc.begin.column == loc.end.column) cout << loc.begin.column;
-    else cout << loc.begin.column << '-' << loc.end.column;
+    if(loc.begin.column == loc.end.column) out << loc.begin.column;
+    else out << loc.begin.column << '-' << loc.end.column;
 
     clearColor();
 }
 
 
-void showFileInfo(const yy::location &loc, ErrorType t){
+void showFileInfo(const DecodedLoc &loc, ErrorType t){
+    ostream &out = diagnostics();
     printFileNameAndLineNumber(loc);
 
-    cout << '\t' << flush;
+    out << '\t' << flush;
     printErrorTypeColor(t);
 
     if(t == ErrorType::Error)
-        cout << "error: ";
+        out << "error: ";
     else if(t == ErrorType::Warning)
-        cout << "warning: ";
+        out << "warning: ";
     else if(t == ErrorType::Note)
-        cout << "note: ";
+        out << "note: ";
 
     clearColor();
 }
 
 
-void showError(lazy_printer msg, const yy::location& loc, ErrorType t){
+void showError(lazy_printer msg, const SourceRange& range, ErrorType t){
+    ostream &out = diagnostics();
     if(t == ErrorType::Error)
         globalErrorCount++;
 
+    DecodedLoc loc = decodeLoc(range);
     showFileInfo(loc, t);
-    cout << msg << endl;
+    out << msg << endl;
     printErrLine(loc, t);
-    cout << endl << endl;
+    out << endl << endl;
 }
 
 
@@ -148,17 +160,17 @@ size_t errorCount() {
 }
 
 
-LOC_TY unknownLoc(){
-    return parser::mkLoc(parser::mkPos(0, 0, 0), parser::mkPos(0, 0, 0));
+SourceRange unknownLoc(){
+    return SourceRange();
 }
 
 
-void error(const char* msg, const yy::location& loc, ErrorType t){
+void error(const char* msg, const SourceRange& loc, ErrorType t){
     showError(msg, loc, t);
     throw CtError();
 }
 
-void error(lazy_printer strs, const yy::location& loc, ErrorType t){
+void error(lazy_printer strs, const SourceRange& loc, ErrorType t){
     showError(strs, loc, t);
     throw CtError();
 }
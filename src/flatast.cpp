@@ -0,0 +1,174 @@
+#include "flatast.h"
+
+using namespace std;
+
+namespace ante {
+    namespace parser {
+
+        /** Records the expression children of each node it visits */
+        struct ChildCollector : public NodeVisitor {
+            vector<Node*> &children;
+
+            ChildCollector(vector<Node*> &children) : children{children}{}
+
+            void add(Node *n){
+                if(n) children.push_back(n);
+            }
+
+            template<typename T>
+            void addAll(vector<unique_ptr<T>> const& nodes){
+                for(auto &n : nodes)
+                    children.push_back(n.get());
+            }
+
+            /** Add a list of nodes linked through their next field */
+            void addList(Node *n){
+                for(; n; n = n->next.get())
+                    children.push_back(n);
+            }
+
+            void visit(RootNode *n){
+                addAll(n->imports);
+                addAll(n->types);
+                addAll(n->traits);
+                addAll(n->main);
+            }
+
+            void visit(IntLitNode *n){}
+            void visit(FltLitNode *n){}
+            void visit(BoolLitNode *n){}
+            void visit(CharLitNode *n){}
+            void visit(StrLitNode *n){}
+
+            void visit(ArrayNode *n){
+                addAll(n->exprs);
+            }
+
+            void visit(TupleNode *n){
+                addAll(n->exprs);
+            }
+
+            void visit(UnOpNode *n){
+                add(n->rval.get());
+            }
+
+            void visit(BinOpNode *n){
+                add(n->lval.get());
+                add(n->rval.get());
+            }
+
+            void visit(SeqNode *n){
+                addAll(n->sequence);
+            }
+
+            void visit(BlockNode *n){
+                add(n->block.get());
+            }
+
+            void visit(ModNode *n){
+                add(n->expr.get());
+            }
+
+            void visit(TypeNode *n){}
+
+            void visit(TypeCastNode *n){
+                add(n->rval.get());
+                add(n->typeExpr.get());
+            }
+
+            void visit(RetNode *n){
+                add(n->expr.get());
+            }
+
+            void visit(NamedValNode *n){
+                add(n->typeExpr.get());
+            }
+
+            void visit(VarNode *n){}
+
+            void visit(VarAssignNode *n){
+                add(n->expr.get());
+                add(n->ref_expr);
+            }
+
+            void visit(ExtNode *n){
+                addList(n->methods.get());
+            }
+
+            void visit(ImportNode *n){}
+
+            void visit(JumpNode *n){
+                add(n->expr.get());
+            }
+
+            void visit(WhileNode *n){
+                add(n->condition.get());
+                add(n->child.get());
+            }
+
+            void visit(ForNode *n){
+                add(n->range.get());
+                add(n->pattern.get());
+                add(n->child.get());
+            }
+
+            void visit(MatchBranchNode *n){
+                add(n->pattern.get());
+                add(n->branch.get());
+            }
+
+            void visit(MatchNode *n){
+                add(n->expr.get());
+                addAll(n->branches);
+            }
+
+            void visit(IfNode *n){
+                add(n->condition.get());
+                add(n->thenN.get());
+                add(n->elseN.get());
+            }
+
+            void visit(FuncDeclNode *n){
+                addList(n->params.get());
+                add(n->child.get());
+            }
+
+            void visit(DataDeclNode *n){}
+            void visit(TraitNode *n){}
+        };
+
+
+        const NodeId FlatAst::noParent;
+
+        FlatAst::FlatAst(Node *root){
+            nodes.push_back(root);
+            parents.push_back(noParent);
+
+            //Each node's children are appended as it is reached, so they always follow their siblings
+            vector<Node*> children;
+            ChildCollector collector{children};
+            for(NodeId id = 0; id < nodes.size(); id++){
+                children.clear();
+                nodes[id]->accept(collector);
+
+                kinds.push_back(nodes[id]->getKind());
+                firstChild.push_back(nodes.size());
+                nodes.insert(nodes.end(), children.begin(), children.end());
+                parents.insert(parents.end(), children.size(), id);
+            }
+            firstChild.push_back(nodes.size());
+
+            types.reserve(nodes.size());
+            for(Node *n : nodes)
+                types.push_back(n->getType());
+            modified.resize(nodes.size());
+        }
+
+
+        void FlatAst::storeTypes(){
+            for(unsigned id : modified.set_bits())
+                nodes[id]->setType(types[id]);
+            modified.reset();
+        }
+    }
+}
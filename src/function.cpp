@@ -93,11 +93,11 @@ void addAllArgAttrs(Function *f, NamedValNode *params){
 }
 
 LOC_TY getFinalLoc(Node *n){
-    auto *seq = dynamic_cast<SeqNode*>(n);
+    auto *seq = dyn_cast<SeqNode>(n);
     if(!seq){
-        if(BlockNode* bn = dynamic_cast<BlockNode*>(n)){
+        if(BlockNode* bn = dyn_cast<BlockNode>(n)){
             n = bn->block.get();
-            seq = dynamic_cast<SeqNode*>(n);
+            seq = dyn_cast<SeqNode>(n);
         }
     }
     return seq ? seq->sequence.back()->loc : n->loc;
@@ -134,7 +134,7 @@ TypedValue compFnWithModifiers(Compiler *c, FuncDecl *fd){
 
     TypedValue fn;
     if(mod->isCompilerDirective()){
-        if(VarNode *vn = dynamic_cast<VarNode*>(mod->directive.get())){
+        if(VarNode *vn = dyn_cast<VarNode>(mod->directive.get())){
             if(vn->name == "inline"){
                 fn = c->compFn(fd);
                 if(!fn) return fn;
@@ -145,7 +145,7 @@ TypedValue compFnWithModifiers(Compiler *c, FuncDecl *fd){
                 fn = TypedValue(nullptr, fnty);
             }else{
                 fdn->modifiers.emplace_back(mod);
-                error("Unrecognized compiler directive '"+vn->name+"'", vn->loc);
+                error("Unrecognized compiler directive '"+vn->name.str()+"'", vn->loc);
             }
 
             return fn;
@@ -278,7 +278,7 @@ TypedValue compFnHelper(Compiler *c, FuncDecl *fd){
 void CompilingVisitor::visit(FuncDeclNode *n){
     // Only lambdas need to be compiled immediately.
     // Other functions can be done lazily when called.
-    if(n->name.empty() && n->decl->isFuncDecl()){
+    if(n->name.ref().empty() && n->decl->isFuncDecl()){
         val = c->compFn(static_cast<FuncDecl*>(n->decl));
     }
 }
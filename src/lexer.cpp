@@ -1,7 +1,13 @@
 #include "lexer.h"
 #include "lazystr.h"
+#include "sourcebuffer.h"
+#include "lexerkernels.h"
+#include "symbol.h"
+#include "parsecontext.h"
 #include <cstdlib>
 #include <cstring>
+#include <cstdint>
+#include <array>
 
 using namespace ante;
 using namespace std;
@@ -10,7 +16,7 @@ using namespace std;
  *  Maps each non-literal token to a string representing
  *  its type.
  */
-map<int, const char*> tokDict = {
+static const pair<int, const char*> tokNames[] = {
     {Tok_Ident, "Identifier"},
     {Tok_UserType, "UserType"},
     {Tok_TypeVar, "TypeVar"},
@@ -108,10 +114,26 @@ map<int, const char*> tokDict = {
     {Tok_Unindent, "Unindent"},
 };
 
+/*
+ *  The string of each non-literal token, indexed by the
+ *  token's offset from Tok_Ident.
+ */
+static const array<const char*, Tok_Unindent - Tok_Ident + 1> tokStrs = []{
+    array<const char*, Tok_Unindent - Tok_Ident + 1> strs{};
+    for(auto &tok : tokNames)
+        strs[tok.first - Tok_Ident] = tok.second;
+    return strs;
+}();
+
+struct Keyword {
+    const char *name;
+    int tok;
+};
+
 /*
  *  Maps each keyword to its corresponding TokenType
  */
-map<string, int> keywords = {
+static const Keyword keywords[] = {
     {"i8",       Tok_I8},
     {"i16",      Tok_I16},
     {"i32",      Tok_I32},
@@ -176,65 +198,113 @@ map<string, int> keywords = {
     {"where",    Tok_Where},
 };
 
+const size_t maxKeywordLength = 8;
 
-/* Raw text to store identifiers and usertypes in */
-char *lextxt;
-
-Lexer *yylexer;
+/*
+ *  Multiplier found by search such that every keyword above
+ *  has a distinct hash.  It must be changed if a keyword
+ *  is added that collides with an existing one.
+ */
+const uint64_t keywordHashMultiplier = 0x5cebe21356cd42d3;
 
-bool ante::colored_output = true;
+/*
+ *  Hashes an identifier of at least 2 characters from its length
+ *  and its first and last two characters.
+ */
+static inline uint8_t hashKeyword(const char *s, size_t len){
+    uint64_t key = (uint64_t)(uint8_t)s[0]
+                 | (uint64_t)(uint8_t)s[1] << 8
+                 | (uint64_t)(uint8_t)s[len - 2] << 16
+                 | (uint64_t)(uint8_t)s[len - 1] << 24
+                 | (uint64_t)len << 32;
+    return (key * keywordHashMultiplier) >> 56;
+}
 
-/* Sets lexer instance for yylex to use */
-void setLexer(Lexer *l){
-    if(yylexer)
-        delete yylexer;
+/*
+ *  Perfect hash table of keywords.  Each slot holds
+ *  the index of its keyword plus one, or 0 if empty.
+ */
+static const array<uint8_t, 256> keywordSlots = []{
+    array<uint8_t, 256> slots{};
+    for(size_t i = 0; i < sizeof(keywords) / sizeof(Keyword); i++){
+        auto &slot = slots[hashKeyword(keywords[i].name, strlen(keywords[i].name))];
+        if(slot){
+            //Checked in every build since a collision would otherwise lex one keyword as an identifier
+            cerr << "Keywords '" << keywords[slot - 1].name << "' and '" << keywords[i].name
+                 << "' have the same hash, keywordHashMultiplier must be changed\n";
+            abort();
+        }
+        slot = i + 1;
+    }
+    return slots;
+}();
 
-    yylexer = l;
+/*
+ *  Returns the keyword spelled by the given characters or
+ *  nullptr if they are not a keyword.
+ */
+static const Keyword* findKeyword(const char *s, size_t len){
+    if(len < 2 || len > maxKeywordLength)
+        return nullptr;
+
+    uint8_t slot = keywordSlots[hashKeyword(s, len)];
+    if(!slot)
+        return nullptr;
+
+    const Keyword *keyword = &keywords[slot - 1];
+    if(strncmp(keyword->name, s, len) != 0 || keyword->name[len] != '\0')
+        return nullptr;
+    return keyword;
 }
 
-int yylex(yy::parser::semantic_type* st, yy::location* yyloc){
-    return yylexer->next(yyloc);
+
+bool ante::colored_output = true;
+
+/* Lexes the next token of the context's file, passing its text as the semantic value */
+int yylex(yy::parser::semantic_type* st, yy::parser::location_type* yyloc, ante::parser::ParseContext &ctx){
+    int tok = ctx.lexer->next(yyloc);
+    *st = (ante::parser::Node*)ctx.lexer->getText();
+    return tok;
 }
 
 
 
+/*
+ * Loads the file to be lexed, or stdin if file = nullptr,
+ * exiting if it cannot be read.
+ */
+static SourceBuffer* loadSource(const string *file){
+    SourceBuffer *source = file ? SourceBuffer::get(*file) : SourceBuffer::getStdin();
+    if(!source){
+        cerr << "Error: Unable to open file '" << (file ? *file : "stdin") << "'\n";
+        exit(EXIT_FAILURE);
+    }
+    return source;
+}
+
 /*
  * Initializes lexer from a filename to be opened
  * If file = nullptr then stdin will be opened instead
  */
-Lexer::Lexer(string* file) :
-    isPseudoFile(false),
-    row{1},
-    col{1},
-    rowOffset{0},
-    colOffset{0},
-    cur{0},
-    nxt{0},
+Lexer::Lexer(const string* file) : Lexer(loadSource(file)){
+    if(cur == '#' && nxt == '!')
+        while(cur != '\n' && cur != '\0') incPos();
+}
+
+
+Lexer::Lexer(SourceBuffer *source, bool pi) :
+    source{source},
+    pos{source->begin()},
+    cur{1}, //Cannot initialize cur=nxt=0 as 0 is treated as end of file
+    nxt{1},
     scopes{new stack<unsigned int>()},
     cscope{0},
     manualScopeLevel{0},
     shouldReturnNewline(false),
-    printInput(false)
+    printInput(pi)
 {
-    if(file){
-        in = new ifstream(*file);
-        fileName = file;
-    }else{
-        in = &cin;
-        fileName = new string("stdin");
-    }
-
-    if(!*in){
-        cerr << "Error: Unable to open file '" << *file << "'\n";
-        exit(EXIT_FAILURE);
-    }
-
     incPos(2);
-    row = col = 1;
     scopes->push(0);
-
-    if(cur == '#' && nxt == '!')
-        while(cur != '\n') incPos();
 }
 
 
@@ -242,13 +312,9 @@ Lexer::Lexer(string* file) :
  * Initializes lexer from a string, the 'pseudofile' to be
  * lexed instead of an actual file
  */
-Lexer::Lexer(string* fName, string& pFile,
-        unsigned int ro, unsigned int co, bool pi) :
-    isPseudoFile(true),
-    row{1},
-    col{1},
-    rowOffset{ro},
-    colOffset{co},
+Lexer::Lexer(string& pFile, bool pi) :
+    source{nullptr},
+    pos{pFile.c_str()},
     cur{1}, //Cannot initialize cur=nxt=0 as 0 is treated as end of file for a pseudo-file
     nxt{1},
     scopes{new stack<unsigned int>()},
@@ -257,31 +323,33 @@ Lexer::Lexer(string* fName, string& pFile,
     shouldReturnNewline(false),
     printInput(pi)
 {
-    fileName = fName;
-    pseudoFile = (char*)pFile.c_str();
     incPos(2);
     scopes->push(0);
 }
 
 Lexer::~Lexer(){
     delete scopes;
-    if(!isPseudoFile && in != &cin)
-        delete in;
 }
 
 char Lexer::peek() const{
     return cur;
 }
 
-namespace ante{
-    namespace parser{
-        yy::position mkPos(string*, unsigned int, unsigned int);
-    }
+char* Lexer::getText() const{
+    return lextxt;
 }
 
-yy::position Lexer::getPos(bool inclusiveEnd) const{
-    return parser::mkPos(fileName, row + rowOffset, col + colOffset -
-                (inclusiveEnd ? 0 : 1));
+SourceBuffer* Lexer::getSource() const{
+    return source;
+}
+
+SourceLoc Lexer::getPos(bool inclusiveEnd) const{
+    if(!source)
+        return SourceLoc();
+
+    //Once the terminator is reached pos no longer advances
+    const char *c = cur ? curPos() : source->end();
+    return source->getLoc(inclusiveEnd || c == source->begin() ? c : c - 1);
 }
 
 bool isKeywordAType(int tok){
@@ -305,25 +373,15 @@ string Lexer::getTokStr(int t){
     string s = "";
     if(IS_LITERAL(t)){
         s += (char)t;
-    }else{
-        s += tokDict[t];
+    }else if(t <= Tok_Unindent && tokStrs[t - Tok_Ident]){
+        s += tokStrs[t - Tok_Ident];
     }
     return s;
 }
 
 inline void Lexer::incPos(){
     cur = nxt;
-    col++;
-
-    if(isPseudoFile){
-        nxt = !nxt ? 0 : *(pseudoFile++);
-    }else{
-        if(in->good()){
-            in->get(nxt);
-        }else {
-            cur = nxt = 0;
-        }
-    }
+    nxt = !nxt ? 0 : *(pos++);
 }
 
 void Lexer::incPos(int end){
@@ -332,6 +390,26 @@ void Lexer::incPos(int end){
     }
 }
 
+inline const char* Lexer::curPos() const {
+    //pos is always one past nxt, which directly follows cur
+    return pos - 2;
+}
+
+void Lexer::skipTo(const char *end, bool print){
+    const char *start = curPos();
+    if(printInput && print)
+        fwrite(start, 1, end - start, stdout);
+
+    cur = *end;
+    if(cur){
+        nxt = end[1];
+        pos = end + 2;
+    }else{
+        nxt = 0;
+        pos = end + 1;
+    }
+}
+
 unsigned int Lexer::getManualScopeLevel() const {
     return manualScopeLevel;
 }
@@ -358,11 +436,8 @@ int Lexer::handleComment(yy::parser::location_type* loc){
             if(printInput)
                 putchar(cur);
 
-            if(cur == '\n'){
-                row++;
-                col = 0;
             //handle nested comments
-            }else if(cur == '/' && nxt == '*'){
+            if(cur == '/' && nxt == '*'){
                 level += 1;
             }else if(cur == '*' && nxt == '/'){
                 if(level != 0)
@@ -380,11 +455,7 @@ int Lexer::handleComment(yy::parser::location_type* loc){
     }else{ //single line comment
         if(printInput)
             setTermFGColor(AN_COMMENT_COLOR);
-        while(cur != '\n' && cur != '\0'){
-            if(printInput)
-                putchar(cur);
-            incPos();
-        }
+        skipTo(lexerKernels->scanLineEnd(curPos()));
     }
 
     if(printInput)
@@ -404,52 +475,58 @@ void Lexer::setlextxt(string &str){
     lextxt = strdup(str.c_str());
 }
 
+/*
+*  Sets lextxt to the interned copy of the given identifier.
+*  Every occurrence of the same identifier shares this copy,
+*  so it must never be modified or freed.
+*/
+void Lexer::setlextxt(const char *begin, const char *end){
+    lextxt = const_cast<char*>(Symbol::get(llvm::StringRef(begin, end - begin)).c_str());
+}
+
 int Lexer::genAlphaNumTok(yy::parser::location_type* loc){
-    string s = "";
     loc->begin = getPos();
 
     bool isUsertype = cur >= 'A' && cur <= 'Z';
-    if(isUsertype){
-        while(IS_ALPHANUM(cur)){
-            if(cur == '_'){
-                loc->end = getPos();
-                lexErr("Usertypes cannot contain an underscore.", loc);
-            }
+    const char *start = curPos();
+    const char *end = lexerKernels->scanIdentifier(start);
 
-            s += cur;
-            incPos();
-        }
-    }else{
-        while(IS_ALPHANUM(cur)){
-            s += cur;
-            incPos();
+    if(isUsertype){
+        auto underscore = (const char*)memchr(start, '_', end - start);
+        if(underscore){
+            skipTo(underscore, false);
+            loc->end = getPos();
+            lexErr("Usertypes cannot contain an underscore.", loc);
         }
     }
 
+    //the token is printed below in its own color
+    skipTo(end, false);
+
     loc->end = getPos(false);
 
     if(isUsertype){
+        setlextxt(start, end);
         if(printInput)
-            cout << AN_TYPE_COLOR << s << AN_CONSOLE_RESET;
-        setlextxt(s);
+            cout << AN_TYPE_COLOR << lextxt << AN_CONSOLE_RESET;
         return Tok_UserType;
     }else{ //ident or keyword
-        auto key = keywords.find(s.c_str());
-        if(key != keywords.end()){
+        auto key = findKeyword(start, end - start);
+        if(key){
             if(printInput){
-                if(isKeywordAType(key->second))
+                if(isKeywordAType(key->tok))
                     cout << AN_TYPE_COLOR;
-                else if(key->second == Tok_True || key->second == Tok_False)
+                else if(key->tok == Tok_True || key->tok == Tok_False)
                     cout << AN_CONSTANT_COLOR;
                 else cout << AN_KEYWORD_COLOR;
 
-                cout << key->first << AN_CONSOLE_RESET;
+                cout << key->name << AN_CONSOLE_RESET;
             }
-            return key->second;
+            return key->tok;
         }else{//ident
+            setlextxt(start, end);
             if(printInput)
-                cout << s;
-            setlextxt(s);
+                cout << lextxt;
             return Tok_Ident;
         }
     }
@@ -559,12 +636,17 @@ int Lexer::genWsTok(yy::parser::location_type* loc){
         unsigned int newScope = 0;
 
         while(IS_WHITESPACE(cur) && cur != '\0'){
+            if(cur == ' '){
+                const char *end = lexerKernels->scanSpaces(curPos());
+                newScope += end - curPos();
+                skipTo(end);
+                if(IS_COMMENT(cur, nxt)) return handleComment(loc);
+                continue;
+            }
+
             switch(cur){
-                case ' ': newScope++; break;
                 case '\n':
                     newScope = 0;
-                    row++;
-                    col = 0;
                     loc->begin = getPos();
                     break;
                 case '\t':
@@ -603,12 +685,12 @@ int Lexer::genWsTok(yy::parser::location_type* loc){
 }
 
 int Lexer::skipWsAndReturnNext(yy::parser::location_type* loc){
-    do{
-        if(printInput)
-            putchar(cur);
+    if(printInput)
+        putchar(cur);
 
-        incPos();
-    }while(cur == ' ');
+    incPos();
+    if(cur == ' ')
+        skipTo(lexerKernels->scanSpaces(curPos()));
     return next(loc);
 }
 
@@ -627,6 +709,15 @@ int Lexer::genStrLitTok(yy::parser::location_type* loc){
         cout << AN_STRING_COLOR << '"';
 
     while(cur != '"' && cur != '\0'){
+        //Copy every plain character before the next quote, escape, or newline at once.
+        //The last one is left to the checks below in case a newline follows it.
+        const char *start = curPos();
+        const char *end = lexerKernels->scanStrLit(start) - 1;
+        if(end > start){
+            s.append(start, end);
+            skipTo(end);
+        }
+
         if(cur == '\\'){
             if(printInput)
                 putchar('\\');
@@ -640,10 +731,6 @@ int Lexer::genStrLitTok(yy::parser::location_type* loc){
                 case 'v': s += '\v'; break;
                 default:
                     if(!IS_NUMERICAL(nxt)){
-                        if(nxt == '\n'){
-                            col = 0;
-                            row++;
-                        }
                         s += nxt;
                     }else{
                         int cha = 0;
@@ -661,7 +748,7 @@ int Lexer::genStrLitTok(yy::parser::location_type* loc){
                         cha += cur - '0';
 
                         s += cha;
-                        in->putback(nxt);
+                        pos--; //put nxt back to be read again
                         nxt = cur;
                     }
                     break;
@@ -669,10 +756,6 @@ int Lexer::genStrLitTok(yy::parser::location_type* loc){
 
             incPos();
         }else{
-            if(nxt == '\n'){
-                col = 0;
-                row++;
-            }
             s += cur;
         }
 
@@ -708,7 +791,7 @@ int Lexer::genTypeVarTok(yy::parser::location_type* loc, string &s){
         cout << AN_TYPE_COLOR << s << AN_CONSOLE_RESET;
 
     loc->end = getPos(false);
-    setlextxt(s);
+    setlextxt(s.data(), s.data() + s.size());
     return Tok_TypeVar;
 }
 
@@ -757,7 +840,7 @@ int Lexer::genCharLitTok(yy::parser::location_type* loc){
                     cha += cur - '0';
 
                     s += cha;
-                    in->putback(nxt);
+                    pos--; //put nxt back to be read again
                     nxt = cur;
                 }
                 break;
@@ -825,8 +908,6 @@ int Lexer::genOpTok(yy::parser::location_type* loc){
             putchar('\n');
         }
         incPos(2);
-        col = 1;
-        row++;
         return next(loc);
     }
 
@@ -960,11 +1041,6 @@ int Lexer::next(yy::parser::location_type* loc){
     //only check for significant whitespace if the lexer is not trying to match brackets.
     if(IS_WHITESPACE(cur)){
         if(matchingToks.size() > 0){
-            //make sure to maintain line count if a newline is skipped in skipWsAndReturnNext
-            if(cur == '\n'){
-                row++;
-                col = 0;
-            }
             return skipWsAndReturnNext(loc);
         }else{
             return genWsTok(loc);
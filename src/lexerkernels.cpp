@@ -0,0 +1,189 @@
+#include "lexerkernels.h"
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  define AN_LEXER_SIMD 1
+#  include <immintrin.h>
+#endif
+
+namespace ante {
+
+    static inline bool isIdentChar(char c){
+        return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z')
+            || (c >= 'a' && c <= 'z') || c == '_';
+    }
+
+    static const char* scanIdentifierScalar(const char *p){
+        while(isIdentChar(*p)) p++;
+        return p;
+    }
+
+    static const char* scanSpacesScalar(const char *p){
+        while(*p == ' ') p++;
+        return p;
+    }
+
+    static const char* scanLineEndScalar(const char *p){
+        while(*p != '\n' && *p != '\0') p++;
+        return p;
+    }
+
+    static const char* scanStrLitScalar(const char *p){
+        while(*p != '"' && *p != '\\' && *p != '\n' && *p != '\0') p++;
+        return p;
+    }
+
+    const LexerKernels LexerKernels::scalar = {
+        "scalar",
+        scanIdentifierScalar,
+        scanSpacesScalar,
+        scanLineEndScalar,
+        scanStrLitScalar,
+    };
+
+#ifdef AN_LEXER_SIMD
+    /*
+     * The first block loaded is the aligned block containing p so no load
+     * ever crosses into a page the terminator is not on.  This may read a
+     * few bytes before p or after the terminator, which is why these are
+     * excluded from address and thread sanitization.
+     */
+#  define AN_SSE2 __attribute__((target("sse2")))
+#  define AN_AVX2 __attribute__((target("avx2")))
+#  define AN_NO_SANITIZE __attribute__((no_sanitize_address, no_sanitize_thread))
+
+    // Each predicate returns a mask with every byte that ends the run set
+
+    AN_SSE2 static inline __m128i isIdentEnd16(__m128i c){
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+
+        // setting 0x20 maps upper case letters onto lower case ones
+        __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+
+        __m128i underscore = _mm_cmpeq_epi8(c, _mm_set1_epi8('_'));
+        __m128i ident = _mm_or_si128(_mm_or_si128(digit, alpha), underscore);
+        return _mm_xor_si128(ident, _mm_set1_epi8(-1));
+    }
+
+    AN_SSE2 static inline __m128i isSpacesEnd16(__m128i c){
+        return _mm_xor_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')), _mm_set1_epi8(-1));
+    }
+
+    AN_SSE2 static inline __m128i isLineEnd16(__m128i c){
+        return _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('\n')),
+                            _mm_cmpeq_epi8(c, _mm_setzero_si128()));
+    }
+
+    AN_SSE2 static inline __m128i isStrLitEnd16(__m128i c){
+        __m128i quote = _mm_cmpeq_epi8(c, _mm_set1_epi8('"'));
+        __m128i escape = _mm_cmpeq_epi8(c, _mm_set1_epi8('\\'));
+        return _mm_or_si128(_mm_or_si128(quote, escape), isLineEnd16(c));
+    }
+
+    template<__m128i (*isEnd)(__m128i)>
+    AN_SSE2 AN_NO_SANITIZE static const char* scan16(const char *p){
+        unsigned misalign = (uintptr_t)p & 15;
+        const char *block = p - misalign;
+
+        unsigned ends = _mm_movemask_epi8(isEnd(_mm_load_si128((const __m128i*)block)));
+        ends &= 0xFFFFu << misalign;
+
+        while(!ends){
+            block += 16;
+            ends = _mm_movemask_epi8(isEnd(_mm_load_si128((const __m128i*)block)));
+        }
+        return block + __builtin_ctz(ends);
+    }
+
+    AN_AVX2 static inline __m256i isIdentEnd32(__m256i c){
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+
+        __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+
+        __m256i underscore = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_'));
+        __m256i ident = _mm256_or_si256(_mm256_or_si256(digit, alpha), underscore);
+        return _mm256_xor_si256(ident, _mm256_set1_epi8(-1));
+    }
+
+    AN_AVX2 static inline __m256i isSpacesEnd32(__m256i c){
+        return _mm256_xor_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')), _mm256_set1_epi8(-1));
+    }
+
+    AN_AVX2 static inline __m256i isLineEnd32(__m256i c){
+        return _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n')),
+                               _mm256_cmpeq_epi8(c, _mm256_setzero_si256()));
+    }
+
+    AN_AVX2 static inline __m256i isStrLitEnd32(__m256i c){
+        __m256i quote = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('"'));
+        __m256i escape = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\\'));
+        return _mm256_or_si256(_mm256_or_si256(quote, escape), isLineEnd32(c));
+    }
+
+    template<__m256i (*isEnd)(__m256i)>
+    AN_AVX2 AN_NO_SANITIZE static const char* scan32(const char *p){
+        unsigned misalign = (uintptr_t)p & 31;
+        const char *block = p - misalign;
+
+        unsigned ends = _mm256_movemask_epi8(isEnd(_mm256_load_si256((const __m256i*)block)));
+        ends &= ~0u << misalign;
+
+        while(!ends){
+            block += 32;
+            ends = _mm256_movemask_epi8(isEnd(_mm256_load_si256((const __m256i*)block)));
+        }
+        return block + __builtin_ctz(ends);
+    }
+
+    static const LexerKernels sse2Kernels = {
+        "sse2",
+        scan16<isIdentEnd16>,
+        scan16<isSpacesEnd16>,
+        scan16<isLineEnd16>,
+        scan16<isStrLitEnd16>,
+    };
+
+    static const LexerKernels avx2Kernels = {
+        "avx2",
+        scan32<isIdentEnd32>,
+        scan32<isSpacesEnd32>,
+        scan32<isLineEnd32>,
+        scan32<isStrLitEnd32>,
+    };
+
+    const LexerKernels& LexerKernels::native(){
+        // native() may run during static initialization, before the cpu model is otherwise set
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+            return avx2Kernels;
+        if(__builtin_cpu_supports("sse2"))
+            return sse2Kernels;
+        return scalar;
+    }
+
+    std::vector<const LexerKernels*> LexerKernels::supported(){
+        std::vector<const LexerKernels*> kernels{&scalar};
+        if(__builtin_cpu_supports("sse2"))
+            kernels.push_back(&sse2Kernels);
+        if(__builtin_cpu_supports("avx2"))
+            kernels.push_back(&avx2Kernels);
+        return kernels;
+    }
+#else
+    const LexerKernels& LexerKernels::native(){
+        return scalar;
+    }
+
+    std::vector<const LexerKernels*> LexerKernels::supported(){
+        return {&scalar};
+    }
+#endif
+
+    const LexerKernels *lexerKernels = &LexerKernels::native();
+}
@@ -18,6 +18,10 @@ namespace ante {
         return children.find(name);
     }
 
+    llvm::StringMap<Module>::iterator Module::childrenBegin() {
+        return children.begin();
+    }
+
     llvm::StringMap<Module>::iterator Module::childrenEnd() {
         return children.end();
     }
@@ -76,7 +80,7 @@ namespace ante {
         return s != rhs.s || cur != rhs.cur || prev != rhs.prev;
     }
 
-    AnType* Module::lookupType(std::string const& name) const {
+    AnType* Module::lookupType(Symbol name) const {
         TypeDecl *typeDecl = lookupTypeDecl(name);
         if(!typeDecl) return nullptr;
 
@@ -88,63 +92,177 @@ namespace ante {
         }
     }
 
-    TypeDecl* Module::lookupTypeDecl(std::string const& name) const {
+    void Module::addImport(Module *import){
+        size_t index = imports.size();
+        imports.push_back(import);
+        imported.moduleNames.try_emplace(import->name, index);
+
+        for(auto &child : import->children)
+            imported.submodules.try_emplace(child.getKey(), &child.getValue());
+
+        for(auto &fn : import->fnDecls){
+            imported.fnDecls.try_emplace(fn.first, fn.second);
+            imported.fnProviders.try_emplace(fn.first, index);
+        }
+
+        for(auto &ty : import->userTypes){
+            imported.userTypes.try_emplace(ty.first, ty.second);
+            imported.typeProviders.try_emplace(ty.first, index);
+        }
+
+        for(auto &tr : import->traitDecls){
+            imported.traitDecls.try_emplace(tr.first, tr.second);
+            imported.traitProviders.try_emplace(tr.first, index);
+        }
+
+        for(auto &impls : import->traitImpls){
+            auto &visible = imported.traitImpls[impls.first];
+            for(auto *impl : impls.second.getImpls())
+                visible.add(impl);
+        }
+        resolvedImpls.clear();
+    }
+
+    size_t Module::findImport(llvm::StringRef moduleName) const {
+        auto it = imported.moduleNames.find(moduleName);
+        return it != imported.moduleNames.end() ? it->second : imports.size();
+    }
+
+    Module* Module::findImportedSubmodule(llvm::StringRef name) const {
+        auto it = imported.submodules.find(name);
+        return it != imported.submodules.end() ? it->second : nullptr;
+    }
+
+    /** Lower first to the provider of the first name in decls with the earliest provider before it */
+    template<typename T>
+    static void findEarliestProvider(llvm::DenseMap<Symbol, T> const& decls,
+            llvm::DenseMap<Symbol, size_t> const& providers, size_t &first, Symbol &name){
+
+        for(auto &decl : decls){
+            auto it = providers.find(decl.first);
+            if(it != providers.end() && it->second < first){
+                first = it->second;
+                name = decl.first;
+            }
+        }
+    }
+
+    size_t Module::findImportConflict(Module const *import, Symbol &name) const {
+        size_t first = imports.size();
+        findEarliestProvider(import->userTypes, imported.typeProviders, first, name);
+        findEarliestProvider(import->traitDecls, imported.traitProviders, first, name);
+        findEarliestProvider(import->fnDecls, imported.fnProviders, first, name);
+        return first;
+    }
+
+    void Module::addTraitImpl(Symbol traitName, TraitImpl *impl){
+        traitImpls[traitName].add(impl);
+        resolvedImpls.clear();
+    }
+
+    FuncDecl* Module::lookupFunction(Symbol name) const {
+        auto it = fnDecls.find(name);
+        if(it != fnDecls.end())
+            return it->second;
+
+        it = imported.fnDecls.find(name);
+        return it != imported.fnDecls.end() ? it->second : nullptr;
+    }
+
+    TypeDecl* Module::lookupTypeDecl(Symbol name) const {
         auto it = userTypes.find(name);
         if(it != userTypes.end())
             return (TypeDecl*)&it->second;
 
-        for(auto &module : imports){
-            it = module->userTypes.find(name);
-            if(it != module->userTypes.end())
-                return (TypeDecl*)&it->second;
-        }
-        return nullptr;
+        it = imported.userTypes.find(name);
+        return it != imported.userTypes.end() ? (TypeDecl*)&it->second : nullptr;
     }
 
     /** Lookup the given Trait* and return it if found, null otherwise */
-    TraitDecl* Module::lookupTraitDecl(std::string const& name) const {
+    TraitDecl* Module::lookupTraitDecl(Symbol name) const {
         auto it = traitDecls.find(name);
-        if(it != traitDecls.end()){
-            return it->getValue();
-        }
-        for(Module *module : this->imports){
-            auto it = module->traitDecls.find(name);
-            if(it != module->traitDecls.end()){
-                return it->getValue();
-            }
+        if(it != traitDecls.end())
+            return it->second;
+
+        it = imported.traitDecls.find(name);
+        return it != imported.traitDecls.end() ? it->second : nullptr;
+    }
+
+    /** Return the first impl of the named trait in the given map with matching typeArgs */
+    static TraitImpl* findImpl(llvm::DenseMap<Symbol, TraitImplIndex> const& impls,
+            Symbol name, TypeArgs const& typeArgs){
+
+        auto it = impls.find(name);
+        return it != impls.end() ? it->second.find(typeArgs) : nullptr;
+    }
+
+    static TraitImpl* findVisibleImpl(llvm::DenseMap<Symbol, TraitImplIndex> const& own,
+            llvm::DenseMap<Symbol, TraitImplIndex> const& imported, Symbol name, TypeArgs const& typeArgs){
+
+        if(TraitImpl *impl = findImpl(own, name, typeArgs))
+            return impl;
+        return findImpl(imported, name, typeArgs);
+    }
+
+    size_t Module::ResolvedImplKeyHash::operator()(ResolvedImplKey const& key) const {
+        return hashCombine(key.traitName.getId(), std::hash<TypeArgs>()(key.typeArgs));
+    }
+
+    Module::ResolvedImpl* Module::resolveTraitImpl(Symbol name, TypeArgs const& typeArgs) const {
+        //An impl found for generic args may not be the one used once they are bound, so only concrete args are memoized
+        for(auto *arg : typeArgs)
+            if(arg->isGeneric)
+                return nullptr;
+
+        auto it = resolvedImpls.find({name, typeArgs});
+        if(it == resolvedImpls.end()){
+            it = resolvedImpls.emplace(ResolvedImplKey{name, typeArgs}, ResolvedImpl()).first;
+            it->second.impl = findVisibleImpl(traitImpls, imported.traitImpls, name, typeArgs);
         }
-        return nullptr;
+        return &it->second;
     }
 
     /** Lookup the given TraitInstance* and return it if found, null otherwise */
-    TraitImpl* Module::lookupTraitImpl(std::string const& name, TypeArgs const& typeArgs) const {
-        auto it = traitImpls.find(name);
-        if(it != traitImpls.end()){
-            for(auto *impl : it->getValue()){
-                if(allApproxEq(impl->typeArgs, typeArgs)){
-                    return impl;
-                }
-            }
-        }
-        for(Module *import : this->imports){
-            auto it = import->traitImpls.find(name);
-            if(it != import->traitImpls.end()){
-                for(auto *impl : it->getValue()){
-                    if(allApproxEq(impl->typeArgs, typeArgs)){
-                        return impl;
-                    }
-                }
-            }
+    TraitImpl* Module::lookupTraitImpl(Symbol name, TypeArgs const& typeArgs) const {
+        if(ResolvedImpl *resolved = resolveTraitImpl(name, typeArgs))
+            return resolved->impl;
+        return findVisibleImpl(traitImpls, imported.traitImpls, name, typeArgs);
+    }
+
+    static Declaration* findMethod(TraitImpl *impl, Symbol fnName){
+        if(!impl || !impl->impl || !impl->impl->methods)
+            return nullptr;
+
+        for(parser::Node &n : *impl->impl->methods){
+            auto *fdn = dyn_cast<parser::FuncDeclNode>(&n);
+            if(fdn && fdn->name == fnName)
+                return fdn->decl;
         }
         return nullptr;
     }
 
+    Declaration* Module::ResolvedImpl::findMethod(Symbol fnName){
+        auto it = methods.find(fnName);
+        if(it != methods.end())
+            return it->second;
+
+        Declaration *method = ante::findMethod(impl, fnName);
+        methods.try_emplace(fnName, method);
+        return method;
+    }
+
+    Declaration* Module::lookupTraitMethod(Symbol traitName, TypeArgs const& typeArgs, Symbol fnName) const {
+        if(ResolvedImpl *resolved = resolveTraitImpl(traitName, typeArgs))
+            return resolved->findMethod(fnName);
+        return findMethod(findVisibleImpl(traitImpls, imported.traitImpls, traitName, typeArgs), fnName);
+    }
+
     /** Lookup the TraitDecl and return a new, unimplemented instance of it */
-    TraitImpl* Module::freshTraitImpl(std::string const& traitName) const {
+    TraitImpl* Module::freshTraitImpl(Symbol traitName) const {
         TraitDecl *decl = Module::lookupTraitDecl(traitName);
         if(!decl){
-            yy::location loc;
-            error("Could not find trait " + lazy_str(traitName, AN_TYPE_COLOR) + " in module " + this->name, loc);
+            LOC_TY loc;
+            error("Could not find trait " + lazy_str(traitName.str(), AN_TYPE_COLOR) + " in module " + this->name, loc);
         }
         auto typeArgs = ante::applyToAll(decl->typeArgs, [](AnType *a) -> AnType* {
             return nextTypeVar();
@@ -153,11 +271,11 @@ namespace ante {
     }
 
     /** Create a TraitImpl with the same type args as its TraitDecl */
-    TraitImpl* Module::createTraitImplFromDecl(std::string const& traitName) const {
+    TraitImpl* Module::createTraitImplFromDecl(Symbol traitName) const {
         TraitDecl *decl = lookupTraitDecl(traitName);
         if(!decl){
-            yy::location loc;
-            error("Could not find trait " + lazy_str(traitName, AN_TYPE_COLOR) + " in module " + this->name, loc);
+            LOC_TY loc;
+            error("Could not find trait " + lazy_str(traitName.str(), AN_TYPE_COLOR) + " in module " + this->name, loc);
         }
         return new TraitImpl(decl, decl->typeArgs);
     }
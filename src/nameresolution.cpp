@@ -10,21 +10,22 @@
 #include "typeinference.h"
 #include "trait.h"
 #include "util.h"
+#include "parsecontext.h"
+#include "sourcebuffer.h"
+#include "threadpool.h"
+#include <llvm/ADT/StringMap.h>
+#include <mutex>
 
 using namespace std;
 
-//yy::locations stored in all Nodes contain a string* to
-//a filename which must not be freed until all nodes are
-//deleted, including the FuncDeclNodes within ante::Modules
-//that all have a static lifetime
-list<string> fileNames;
-
 
 namespace ante {
     using namespace parser;
 
+    extern AnTypeContainer typeArena;
+
     bool Declaration::isParamDecl() const {
-        return dynamic_cast<NamedValNode*>(definition);
+        return definition && isa<NamedValNode>(definition);
     }
 
     bool Declaration::isGlobal() const {
@@ -46,7 +47,7 @@ namespace ante {
     }
 
     TypeArgs convertToNewTypeArgs(vector<unique_ptr<TypeNode>> const& types, Module *module,
-            unordered_map<string, AnTypeVarType*> &mapping){
+            TypeVarMap &mapping){
 
         TypeArgs ret;
         ret.reserve(types.size());
@@ -59,86 +60,93 @@ namespace ante {
     /** Check if a name was declared previously in the given table.
      * Throw an appropriate error if it was. */
     template<typename T>
-    void checkForPreviousDecl(NameResolutionVisitor *v, string const& name,
+    void checkForPreviousDecl(NameResolutionVisitor *v, Symbol name,
             T const& tbl, LOC_TY &loc, string kind = "", LOC_TY *importLoc = nullptr){
 
         auto prevDecl = tbl.find(name);
         if(prevDecl != tbl.end()){
-            showError(kind + ' ' + name + " was already declared", loc);
-            error(name + " was previously declared here", (*prevDecl).getValue()->getLoc(), ErrorType::Note);
+            showError(kind + ' ' + name.str() + " was already declared", loc);
+            error(name.str() + " was previously declared here", prevDecl->second->getLoc(), ErrorType::Note);
             if(importLoc)
-                error("Second" + name +  " was imported here", *importLoc, ErrorType::Note);
+                error("Second" + name.str() +  " was imported here", *importLoc, ErrorType::Note);
             throw CtError();
         }
     }
 
 
-    void NameResolutionVisitor::declare(string const& name, VarNode *decl){
-        if(name != "_"){
-            checkForPreviousDecl(this, name, varTable.top().back(), decl->loc, "Variable");
-            auto var = new Variable(name, decl);
+    void NameResolutionVisitor::bind(Symbol name, Variable *var, LOC_TY &loc, string const& kind){
+        auto &stack = bindings[name];
+        if(!stack.empty() && stack.back().scope == scopes.size() - 1){
+            showError(kind + ' ' + name.str() + " was already declared", loc);
+            error(name.str() + " was previously declared here", stack.back().var->getLoc(), ErrorType::Note);
+        }
+        stack.push_back({var, scopes.size() - 1});
+        scopes.back().push_back(name);
+    }
+
+
+    void NameResolutionVisitor::declare(Symbol name, VarNode *decl){
+        if(name.ref() != "_"){
+            auto var = new Variable(name.str(), decl);
+            bind(name, var, decl->loc, "Variable");
             decl->decl = var;
-            varTable.top().back().try_emplace(name, var);
         }else{
-            auto var = new Variable(name, decl);
+            auto var = new Variable(name.str(), decl);
             decl->decl = var;
         }
     }
 
 
-    void NameResolutionVisitor::declare(string const& name, NamedValNode *decl){
-        if(name != "_" && name != ""){
-            checkForPreviousDecl(this, name, varTable.top().back(), decl->loc, "Parameter");
-            auto var = new Variable(name, decl);
+    void NameResolutionVisitor::declare(Symbol name, NamedValNode *decl){
+        if(name.ref() != "_" && name.ref() != ""){
+            auto var = new Variable(name.str(), decl);
+            bind(name, var, decl->loc, "Parameter");
             decl->decl = var;
-            varTable.top().back().try_emplace(name, var);
         }else{
-            auto var = new Variable(name, decl);
+            auto var = new Variable(name.str(), decl);
             decl->decl = var;
         }
     }
 
 
-    void NameResolutionVisitor::declare(TraitDecl *decl, LOC_TY &loc){
-        auto prevDecl = compUnit->traitDecls.find(decl->name);
+    void NameResolutionVisitor::declare(Symbol name, TraitDecl *decl, LOC_TY &loc){
+        auto prevDecl = compUnit->traitDecls.find(name);
         if(prevDecl != compUnit->traitDecls.end()){
             error("Trait " + decl->name + " has already been declared", loc);
         }
-        compUnit->traitDecls.try_emplace(decl->name, decl);
+        compUnit->traitDecls.try_emplace(name, decl);
     }
 
 
-    void NameResolutionVisitor::define(string const& name, AnDataType *dt, LOC_TY &loc){
+    void NameResolutionVisitor::define(Symbol name, AnDataType *dt, LOC_TY &loc){
         TypeDecl *existingTy = lookupType(name);
         if(existingTy){
             auto pt = try_cast<AnProductType>(existingTy->type);
             if(pt->isTypeFamily()) return;
 
-            showError(name + " was already declared", loc);
-            error(name + " was previously declared here", existingTy->loc, ErrorType::Note);
+            showError(name.str() + " was already declared", loc);
+            error(name.str() + " was previously declared here", existingTy->loc, ErrorType::Note);
         }
 
         TypeDecl decl{static_cast<AnType*>(dt), loc};
         compUnit->userTypes.try_emplace(name, decl);
     }
 
-    TypeDecl* NameResolutionVisitor::lookupType(string const& name) const {
+    TypeDecl* NameResolutionVisitor::lookupType(Symbol name) const {
         return compUnit->lookupTypeDecl(name);
     }
 
-    Variable* NameResolutionVisitor::lookupVar(std::string const& name) const {
-        if(!varTable.empty()){
-            auto &context = varTable.top();
-            for(auto it = context.rbegin(); it != context.rend(); it++){
-                auto var = it->find(name);
-                if(var != it->end())
-                    return var->getValue();
-            }
-        }
+    Variable* NameResolutionVisitor::lookupVar(Symbol name) const {
+        //The innermost binding is the only candidate; if it belongs to an enclosing function so do the rest
+        auto binding = bindings.find(name);
+        if(binding != bindings.end() && !binding->second.empty() && !functionScopes.empty()
+                && binding->second.back().scope >= functionScopes.back())
+            return binding->second.back().var;
+
         //local var not found, search for a global
         auto it = globals.find(name);
         if(it != globals.end()){
-            Variable *v = it->getValue().get();
+            Variable *v = it->second.get();
             if(v->tval.type->hasModifier(Tok_Global))
                 return v;
         }
@@ -147,50 +155,46 @@ namespace ante {
 
 
     size_t NameResolutionVisitor::getScope() const {
-        return varTable.size();
+        return functionScopes.size();
     }
 
 
     void NameResolutionVisitor::newScope(){
-        varTable.top().emplace_back();
+        scopes.emplace_back();
     }
 
 
     void NameResolutionVisitor::exitScope(){
-        varTable.top().pop_back();
+        for(Symbol name : scopes.back())
+            bindings[name].pop_back();
+        scopes.pop_back();
     }
 
 
     void NameResolutionVisitor::enterFunction(){
-        varTable.emplace();
+        functionScopes.push_back(scopes.size());
         newScope();
     }
 
 
     void NameResolutionVisitor::exitFunction(){
-        varTable.pop();
+        while(scopes.size() > functionScopes.back())
+            exitScope();
+        functionScopes.pop_back();
     }
 
 
-    FuncDecl* NameResolutionVisitor::getFunction(string const& name) const{
-        auto it = compUnit->fnDecls.find(name);
-        if(it != compUnit->fnDecls.end())
-            return it->getValue();
-
-        for(const Module *m : compUnit->imports){
-            auto it = m->fnDecls.find(name);
-            if(it != m->fnDecls.end())
-                return it->getValue();
-        }
-        return nullptr;
+    FuncDecl* NameResolutionVisitor::getFunction(Symbol name) const{
+        return compUnit->lookupFunction(name);
     }
 
     /** Declare function but do not define it */
     void NameResolutionVisitor::declare(FuncDeclNode *n){
-        checkForPreviousDecl(this, n->name, this->compUnit->fnDecls, n->loc, "Function");
+        Symbol name = n->name;
+        checkForPreviousDecl(this, name, this->compUnit->fnDecls, n->loc, "Function");
 
-        auto *fd = new FuncDecl(n, n->name, this->compUnit);
-        compUnit->fnDecls[n->name] = fd;
+        auto *fd = new FuncDecl(n, name.str(), this->compUnit);
+        compUnit->fnDecls[name] = fd;
         n->decl = fd;
     }
 
@@ -226,6 +230,175 @@ namespace ante {
         return "";
     }
 
+    std::vector<std::string> scanImports(const char *begin, const char *end){
+        std::vector<std::string> imports;
+        const char *line = begin;
+        while(line < end){
+            const char *lineEnd = (const char*)memchr(line, '\n', end - line);
+            if(!lineEnd) lineEnd = end;
+
+            const char *c = line;
+            line = lineEnd + 1;
+
+            while(c < lineEnd && (*c == ' ' || *c == '\t')) c++;
+            if(lineEnd - c < 7 || strncmp(c, "import", 6) != 0 || (c[6] != ' ' && c[6] != '\t'))
+                continue;
+
+            c += 7;
+            while(c < lineEnd && (*c == ' ' || *c == '\t')) c++;
+
+            string path;
+            if(c < lineEnd && *c == '"'){
+                //string literals are used as the path directly
+                const char *close = (const char*)memchr(c + 1, '"', lineEnd - c - 1);
+                if(!close || memchr(c + 1, '\\', close - c - 1))
+                    continue;
+                path.assign(c + 1, close);
+            }else{
+                //Mod.Submod is imported from mod/submod.an, see moduleExprToStr
+                while(c < lineEnd && IS_ALPHANUM(*c)){
+                    const char *segment = c;
+                    while(c < lineEnd && IS_ALPHANUM(*c)) c++;
+
+                    if(!path.empty()) path += '/';
+                    path += char(tolower(*segment));
+                    path.append(segment + 1, c);
+
+                    if(c + 1 < lineEnd && *c == '.' && IS_ALPHANUM(c[1]))
+                        c++;
+                    else
+                        break;
+                }
+                path = addAnSuffix(path);
+            }
+
+            if(!path.empty())
+                imports.push_back(path);
+        }
+        return imports;
+    }
+
+    /** A file parsed ahead of name resolution by parseImportsAhead */
+    struct ParsedFile {
+        string fileName;
+        RootNode *root = nullptr;
+        int flag = PE_OK;
+
+        /** Set if parsing threw a CtError */
+        bool threw = false;
+
+        /** Set once visitImport has taken this file's RootNode */
+        bool taken = false;
+
+        /** Diagnostics issued while parsing, shown once the file is imported */
+        DiagnosticBuffer diagnostics;
+
+        ParsedFile(string const& fileName) : fileName{fileName}{}
+    };
+
+    /** Every file parsed ahead of time, keyed by its full path */
+    static llvm::StringMap<unique_ptr<ParsedFile>> parsedFiles;
+
+    /** Guards parsedFiles while imports are parsed in parallel */
+    static mutex parsedFilesMutex;
+
+    /**
+     * Reserve a ParsedFile for the given import and return it along with
+     * the file's full path, or return null if the file cannot be found or
+     * has already been parsed or imported.
+     */
+    static ParsedFile* reserveParsedFile(string const& import, string &fullPath){
+        Module &root = Module::getRoot();
+        if(root.findPath(ModulePath(import)) != root.childrenEnd())
+            return nullptr;
+
+        fullPath = findFile(import);
+        if(fullPath.empty())
+            return nullptr;
+
+        lock_guard<mutex> lock{parsedFilesMutex};
+        auto &file = parsedFiles[fullPath];
+        if(file)
+            return nullptr;
+
+        file.reset(new ParsedFile(fullPath));
+        return file.get();
+    }
+
+    static void parseAhead(ThreadPool &pool, ParsedFile *file, string const& fullPath);
+
+    /** Queue each of the given imports which has not yet been parsed */
+    static void queueImports(ThreadPool &pool, vector<string> const& imports){
+        for(auto &import : imports){
+            string fullPath;
+            if(ParsedFile *file = reserveParsedFile(import, fullPath)){
+                pool.async([&pool, file, fullPath]{
+                    parseAhead(pool, file, fullPath);
+                });
+            }
+        }
+    }
+
+    /** Queue the file's own imports, then parse it */
+    static void parseAhead(ThreadPool &pool, ParsedFile *file, string const& fullPath){
+        if(SourceBuffer *source = SourceBuffer::get(fullPath))
+            queueImports(pool, scanImports(source->begin(), source->end()));
+
+        setDiagnosticBuffer(&file->diagnostics);
+        try{
+            ParseContext parseCtxt{new Lexer(&file->fileName)};
+            file->flag = parseCtxt.parse();
+            file->root = parseCtxt.root;
+        }catch(CtError){
+            file->threw = true;
+        }
+        typeArena.flushTypeVars();
+        setDiagnosticBuffer(nullptr);
+    }
+
+    /**
+     * Parse every file the given module transitively imports, on up to
+     * compilerJobs() threads, before name resolution reaches any of them.
+     * Name resolution still visits each import in dependency order and
+     * takes its RootNode from parsedFiles.  Any import scanImports misses
+     * is parsed when it is reached instead.
+     */
+    void parseImportsAhead(RootNode *root, bool importsPrelude){
+        if(compilerJobs() <= 1 || typeArena.isNurseryOpen())
+            return;
+
+        vector<string> imports;
+        if(importsPrelude)
+            imports.push_back(AN_PRELUDE_FILE);
+
+        if(SourceBuffer *source = SourceBuffer::find(root->loc.begin)){
+            auto fileImports = scanImports(source->begin(), source->end());
+            imports.insert(imports.end(), fileImports.begin(), fileImports.end());
+        }
+
+        //Threads are only started once some import is found to still need parsing
+        unique_ptr<ThreadPool> pool;
+        for(auto &import : imports){
+            string fullPath;
+            if(ParsedFile *file = reserveParsedFile(import, fullPath)){
+                if(!pool){
+                    typeArena.beginConcurrent();
+                    pool.reset(new ThreadPool(compilerJobs()));
+                }
+                ThreadPool &p = *pool;
+                p.async([&p, file, fullPath]{
+                    parseAhead(p, file, fullPath);
+                });
+            }
+        }
+
+        if(pool){
+            pool->wait();
+            pool.reset();
+            typeArena.endConcurrent();
+        }
+    }
+
     /** Return true if the given file has already been imported into the current module. */
     bool alreadyImported(NameResolutionVisitor &v, std::string const& name){
         return std::any_of(v.compUnit->imports.begin(), v.compUnit->imports.end(), [&](Module *mod){
@@ -234,14 +407,14 @@ namespace ante {
     }
 
     template<typename T>
-    bool hasFunction(vector<T> const& fns, string const& name){
+    bool hasFunction(vector<T> const& fns, llvm::StringRef name){
         return ante::any(fns, [&](T const& declFn){
             return declFn->name == name;
         });
     }
 
     template<typename T>
-    typename vector<T>::const_iterator getFunction(vector<T> const& fns, string const& name){
+    typename vector<T>::const_iterator getFunction(vector<T> const& fns, llvm::StringRef name){
         return ante::find_if(fns, [&](T const& declFn){
             return declFn->name == name;
         });
@@ -253,7 +426,7 @@ namespace ante {
         if(expectedParams != numParams){
             string part1 = to_string(expectedParams) + (expectedParams == 1 ? " parameter" : " parameters");
             string part2 = to_string(numParams) + (numParams == 1 ? " was" : " were");
-            showError(def->name + " was declared to take " + part1 + " but " + part2 + " given here", def->loc);
+            showError(def->name.str() + " was declared to take " + part1 + " but " + part2 + " given here", def->loc);
         }
     }
 
@@ -278,10 +451,10 @@ namespace ante {
 
         auto original = getFunction(traitImplFns, fdn->name);
         if(original != traitImplFns.cend()){
-            showError("Duplicate function " + fdn->name + " in trait impl", fdn->loc);
-            showError(fdn->name + " previously defined here", (*original)->getFDN()->loc, ErrorType::Note);
+            showError("Duplicate function " + fdn->name.str() + " in trait impl", fdn->loc);
+            showError(fdn->name.str() + " previously defined here", (*original)->getFDN()->loc, ErrorType::Note);
         }else{
-            showError("No function named " + fdn->name + " in trait " + trait->name, fdn->loc);
+            showError("No function named " + fdn->name.str() + " in trait " + trait->name, fdn->loc);
         }
         return false;
     }
@@ -357,8 +530,8 @@ namespace ante {
         auto traitImplTys = vecOf<TypeFamily>(traitDeclTys.size());
 
         for(Node &m : *n->methods){
-            if(FuncDeclNode *fdn = dynamic_cast<FuncDeclNode*>(&m)){
-                auto *fd = new FuncDecl(fdn, fdn->name, v.compUnit);
+            if(FuncDeclNode *fdn = dyn_cast<FuncDeclNode>(&m)){
+                auto *fd = new FuncDecl(fdn, fdn->name.str(), v.compUnit);
                 fdn->decl = fd;
                 if(checkFnInTraitDecl(traitDeclFns, traitImplFns, fdn, trait)){
                     ante::remove_if(traitDeclFns, [&](shared_ptr<FuncDecl> const& declFn){
@@ -366,7 +539,7 @@ namespace ante {
                     });
                     traitImplFns.push_back(fd);
                 }
-            }else if(DataDeclNode *ddn = dynamic_cast<DataDeclNode*>(&m)){
+            }else if(DataDeclNode *ddn = dyn_cast<DataDeclNode>(&m)){
                 if(checkTyInTraitDecl(traitDeclTys, traitImplTys, ddn, trait)){
                     ante::remove_if(traitDeclTys, [&](TypeFamily &decl){
                         return decl.name == ddn->name;
@@ -406,6 +579,7 @@ namespace ante {
             ASSERT_UNREACHABLE()
         }
         compUnit->ast.reset(n);
+        parseImportsAhead(n, compUnit->name != "stdlib/prelude");
 
         if(compUnit->name != "stdlib/prelude"){
             TRY_TO(importFile(AN_PRELUDE_FILE, n->loc));
@@ -420,14 +594,14 @@ namespace ante {
         // unwrap any surrounding modifiers then declare
         for(auto &m : n->extensions){
             auto mn = m.get();
-            while(dynamic_cast<ModNode*>(mn))
+            while(isa<ModNode>(mn))
                 mn = static_cast<ModNode*>(mn)->expr.get();
 
             TRY_TO(declare(static_cast<ExtNode*>(mn)));
         }
         for(auto &m : n->funcs){
             auto mn = m.get();
-            while(dynamic_cast<ModNode*>(mn))
+            while(isa<ModNode>(mn))
                 mn = static_cast<ModNode*>(mn)->expr.get();
 
             TRY_TO(declare(static_cast<FuncDeclNode*>(mn)));
@@ -532,15 +706,15 @@ namespace ante {
 
 
     llvm::Optional<string> getIdentifier(Node *n){
-        BinOpNode *bop = dynamic_cast<BinOpNode*>(n);
+        BinOpNode *bop = dyn_cast<BinOpNode>(n);
         if(bop && bop->op == '.'){
             auto l = getIdentifier(bop->lval.get());
             auto r = getIdentifier(bop->rval.get());
             if(!l || !r) return llvm::Optional<string>();
             return *l + "." + *r;
-        }else if(VarNode *vn = dynamic_cast<VarNode*>(n)){
-            return vn->name;
-        }else if(TypeNode *tn = dynamic_cast<TypeNode*>(n)){
+        }else if(VarNode *vn = dyn_cast<VarNode>(n)){
+            return vn->name.str();
+        }else if(TypeNode *tn = dyn_cast<TypeNode>(n)){
             return typeNodeToStr(tn);
         }else{
             return llvm::Optional<string>();
@@ -550,32 +724,29 @@ namespace ante {
 
     Declaration* NameResolutionVisitor::findCandidate(Node *n) const {
         auto name = getIdentifier(n);
-        auto vn = dynamic_cast<VarNode*>(n);
+        auto vn = dyn_cast<VarNode>(n);
         if(!name){
             return new NoDecl(n);
         }else if(vn && !vn->decl->isFuncDecl()){
             return vn->decl;
         }
         
-        auto bop = dynamic_cast<BinOpNode*>(n);
+        auto bop = dyn_cast<BinOpNode>(n);
         if(bop && bop->decl){
             return bop->decl;
         }else{
-            return getFunction(*name);
+            return getFunction(vn ? vn->name : Symbol::get(*name));
         }
     }
 
     bool isImplicitImportExpr(BinOpNode *bop){
-        return bop && bop->op == '.' && dynamic_cast<TypeNode*>(bop->lval.get());
+        return bop && bop->op == '.' && isa<TypeNode>(bop->lval.get());
     }
 
 
     Module *findModule(NameResolutionVisitor *v, string const& name){
-        for(Module *m : v->compUnit->imports){
-            auto it = m->findChild(name);
-            if(it != m->childrenEnd())
-                return &it->second;
-        }
+        if(Module *m = v->compUnit->findImportedSubmodule(name))
+            return m;
 
         Module &root = Module::getRoot();
         auto it = root.findChild(name);
@@ -604,7 +775,7 @@ namespace ante {
             }
 
             rhs = cur->rval.get();
-            cur = dynamic_cast<BinOpNode*>(rhs);
+            cur = dyn_cast<BinOpNode>(rhs);
         }
 
         if(!m){
@@ -619,10 +790,10 @@ namespace ante {
             auto modAndNode = handleImplicitModuleImport(this, n);
             Module *mod = modAndNode.first;
 
-            if(VarNode *vn = dynamic_cast<VarNode*>(modAndNode.second)){
+            if(VarNode *vn = dyn_cast<VarNode>(modAndNode.second)){
                 auto fn = mod->fnDecls.find(vn->name);
                 if(fn == mod->fnDecls.end()){
-                    error("No function named '" + vn->name + "' has not been declared in "
+                    error("No function named '" + vn->name.str() + "' has not been declared in "
                             + lazy_str(mod->name, AN_TYPE_COLOR), n->loc);
                 }
                 vn->decl = fn->second;
@@ -634,7 +805,7 @@ namespace ante {
         n->lval->accept(*this);
 
         if(n->op == '.'){
-            auto vn = dynamic_cast<VarNode*>(n->rval.get());
+            auto vn = dyn_cast<VarNode>(n->rval.get());
             if(vn && !vn->decl){
                 vn->decl = new NoDecl(vn);
             }
@@ -644,7 +815,7 @@ namespace ante {
         n->rval->accept(*this);
 
         if(n->op != '('){
-            FuncDecl *candidate = getFunction(Lexer::getTokStr(n->op));
+            FuncDecl *candidate = getFunction(Symbol::get(Lexer::getTokStr(n->op)));
             if(candidate)
                 n->decl = candidate;
             else //v TODO: memory leak here
@@ -667,19 +838,26 @@ namespace ante {
 
     template<class StringIt>
     NameResolutionVisitor visitImport(string const& filename, StringIt path){
-        //The lexer stores the fileName in the loc field of all Nodes. The fileName is copied
-        //to let Node's outlive the context they were made in, ensuring they work with imports.
-        fileNames.emplace_back(filename);
-        setLexer(new Lexer(&fileNames.back()));
-        yy::parser p{};
-        int flag = p.parse();
-        if(flag != PE_OK){ //parsing error, cannot procede
-            //print out remaining errors
-            int tok;
-            yy::location loc;
-            while((tok = yylexer->next(&loc)) != Tok_Newline && tok != 0);
-            while(p.parse() != PE_OK && yylexer->peek() != 0);
+        RootNode *root;
+        int flag;
+
+        auto parsed = parsedFiles.find(filename);
+        if(parsed != parsedFiles.end() && !parsed->getValue()->taken){
+            ParsedFile &file = *parsed->getValue();
+            file.taken = true;
+            flushDiagnosticBuffer(file.diagnostics);
+            if(file.threw)
+                throw CtError();
+
+            root = file.root;
+            flag = file.flag;
+        }else{
+            ParseContext parseCtxt{new Lexer(&filename)};
+            flag = parseCtxt.parse();
+            root = parseCtxt.root;
+        }
 
+        if(flag != PE_OK){ //parsing error, cannot procede
             cerr << "Syntax error, aborting.\n";
             exit(flag);
         }
@@ -689,7 +867,6 @@ namespace ante {
         //Add this module to the cache first to ensure it is not compiled twice
         NameResolutionVisitor newVisitor{modName};
         newVisitor.compUnit = &Module::getRoot().addPath(path);
-        RootNode *root = parser::getRootNode();
         root->accept(newVisitor);
 
         if (errorCount()) return newVisitor;
@@ -698,40 +875,6 @@ namespace ante {
     }
 
 
-    /**
-     * Issue an error if any of the names in the given module
-     * conflict with any in the modules already imported.
-     */
-    void checkForConflict(Module *import, Module *other, LOC_TY &loc){
-        for(const auto& ty : import->userTypes){
-            if(other->userTypes.find(ty.getKey()) != other->userTypes.end()){
-                error(lazy_str(ty.getKey().str(), AN_TYPE_COLOR) +  " in module "
-                        + lazy_str(import->name, AN_TYPE_COLOR) + " conflicts with "
-                        + lazy_str(ty.getKey().str(), AN_TYPE_COLOR)
-                        + " in module " + lazy_str(other->name, AN_TYPE_COLOR), loc);
-            }
-        }
-
-        for(const auto& tr : import->traitDecls){
-            if(other->traitDecls.find(tr.getKey()) != other->traitDecls.end()){
-                error(lazy_str(tr.getKey().str(), AN_TYPE_COLOR) +  " in module "
-                        + lazy_str(import->name, AN_TYPE_COLOR) + " conflicts with "
-                        + lazy_str(tr.getKey().str(), AN_TYPE_COLOR)
-                        + " in module " + lazy_str(other->name, AN_TYPE_COLOR), loc);
-            }
-        }
-
-        for(const auto& fn : import->fnDecls){
-            if(other->fnDecls.find(fn.getKey()) != other->fnDecls.end()){
-                error(lazy_str(fn.getKey().str(), AN_TYPE_COLOR) +  " in module "
-                        + lazy_str(import->name, AN_TYPE_COLOR) + " conflicts with "
-                        + lazy_str(fn.getKey().str(), AN_TYPE_COLOR)
-                        + " in module " + lazy_str(other->name, AN_TYPE_COLOR), loc);
-            }
-        }
-    }
-
-
     void NameResolutionVisitor::importFile(string const& fName, LOC_TY &loc){
         //f = fName with full directory
         string fullPath = findFile(fName);
@@ -744,19 +887,30 @@ namespace ante {
         if(it != root.childrenEnd()){
             //module already compiled
             Module *import = &it->getValue();
-            for(auto *mod : compUnit->imports){
-                if(mod->name == import->name){
-                    error("Module " + lazy_str(import->name, AN_TYPE_COLOR) + " has already been imported", loc, ErrorType::Warning);
-                    return;
-                }
-                checkForConflict(import, mod, loc);
+
+            //Report whichever of a repeated import or a conflicting declaration is in the earliest import
+            Symbol name;
+            size_t conflict = compUnit->findImportConflict(import, name);
+            size_t previous = compUnit->findImport(import->name);
+
+            if(previous < compUnit->imports.size() && previous <= conflict){
+                error("Module " + lazy_str(import->name, AN_TYPE_COLOR) + " has already been imported", loc, ErrorType::Warning);
+                return;
+            }
+
+            if(conflict < compUnit->imports.size()){
+                Module *other = compUnit->imports[conflict];
+                error(lazy_str(name.str(), AN_TYPE_COLOR) +  " in module "
+                        + lazy_str(import->name, AN_TYPE_COLOR) + " conflicts with "
+                        + lazy_str(name.str(), AN_TYPE_COLOR)
+                        + " in module " + lazy_str(other->name, AN_TYPE_COLOR), loc);
             }
 
-            compUnit->imports.push_back(import);
+            compUnit->addImport(import);
         }else{
             //module not found
             NameResolutionVisitor newVisitor = visitImport(fullPath, modPath);
-            compUnit->imports.push_back(newVisitor.compUnit);
+            compUnit->addImport(newVisitor.compUnit);
         }
     }
 
@@ -776,17 +930,17 @@ namespace ante {
     * literals can be used instead.
     */
     std::string moduleExprToStr(Node *expr){
-        if(BinOpNode *bn = dynamic_cast<BinOpNode*>(expr)){
+        if(BinOpNode *bn = dyn_cast<BinOpNode>(expr)){
             if(bn->op != '.') return "";
 
             return moduleExprToStr(bn->lval.get()) + "/" + moduleExprToStr(bn->rval.get());
-        }else if(TypeNode *tn = dynamic_cast<TypeNode*>(expr)){
+        }else if(TypeNode *tn = dyn_cast<TypeNode>(expr)){
             if(tn->typeTag != TT_Data || !tn->params.empty()) return "";
 
             return lowercaseFirstLetter(tn->typeName);
-        }else if(VarNode *va = dynamic_cast<VarNode*>(expr)){
-            return va->name;
-        }else if(StrLitNode *sln = dynamic_cast<StrLitNode*>(expr)){
+        }else if(VarNode *va = dyn_cast<VarNode>(expr)){
+            return va->name.str();
+        }else if(StrLitNode *sln = dyn_cast<StrLitNode>(expr)){
             return sln->val;
         }else{
             error("Syntax error in import expression", expr->loc);
@@ -799,7 +953,7 @@ namespace ante {
     * See moduleExprToStr for details.
     */
     std::string importExprToStr(Node *expr){
-        if(StrLitNode *sln = dynamic_cast<StrLitNode*>(expr)){
+        if(StrLitNode *sln = dyn_cast<StrLitNode>(expr)){
             return sln->val;
         }else{
             return addAnSuffix(moduleExprToStr(expr));
@@ -836,18 +990,21 @@ namespace ante {
     }
 
     void NameResolutionVisitor::visit(VarNode *n){
+        Symbol name = n->name;
         if(autoDeclare){
-            declare(n->name, n);
+            declare(name, n);
             return;
         }
 
-        auto maybeVar = lookupVar(n->name);
+        auto maybeVar = lookupVar(name);
         if(maybeVar){
             n->decl = maybeVar;
-        }else if(FuncDecl *fn = getFunction(n->name)){
+        }else if(FuncDecl *fn = getFunction(name)){
             n->decl = fn;
+            if(currentFunction)
+                currentFunction->callees.push_back(fn);
         }else{
-            error("Variable or function '" + n->name + "' has not been declared.", n->loc);
+            error("Variable or function '" + n->name.str() + "' has not been declared.", n->loc);
         }
     }
 
@@ -890,7 +1047,7 @@ namespace ante {
 
             auto impl = new TraitImpl(traitName, args);
             impl->impl = n;
-            compUnit->traitImpls[traitName].push_back(impl);
+            compUnit->addTraitImpl(Symbol::get(traitName), impl);
         }
     }
 
@@ -938,6 +1095,8 @@ namespace ante {
             declare(n);
         }
 
+        // lambdas are inferred along with their enclosing function so their callees are its callees
+        TMP_SET(currentFunction, currentFunction ? currentFunction : static_cast<FuncDecl*>(n->decl));
         enterFunction();
         for(Node &p : *n->params){
             p.accept(*this);
@@ -995,10 +1154,10 @@ namespace ante {
             auto *tvt = try_cast<AnTypeVarType>(tn);
 
             for(auto &p : rootTy->generics){
-                if(p->typeName == tvt->name) return;
+                if(p->typeName == tvt->getName()) return;
             }
 
-            // error("Lookup for " + tvt->name + " not found", rootTy->loc);
+            // error("Lookup for " + tvt->getName() + " not found", rootTy->loc);
         }
     }
 
@@ -1006,7 +1165,7 @@ namespace ante {
     void NameResolutionVisitor::visitUnionDecl(parser::DataDeclNode *decl){
         auto generics = convertToTypeArgs(decl->generics, compUnit);
         AnSumType *data = AnSumType::create(decl->name, {}, generics);
-        define(decl->name, data, decl->loc);
+        define(Symbol::get(decl->name), data, decl->loc);
 
         for(Node& child : *decl->child){
             auto nvn = static_cast<NamedValNode*>(&child);
@@ -1014,7 +1173,7 @@ namespace ante {
             AnType *tagTy = tyn->extTy ? toAnType(tyn->extTy.get(), compUnit) : AnType::getUnit();
 
             // fake var to make sure the field decl is not null
-            auto var = new Variable(nvn->name, decl);
+            auto var = new Variable(nvn->name.str(), decl);
             nvn->decl = var;
 
             vector<AnType*> exts = { AnType::getU8() }; //All variants are comprised of at least their tag value
@@ -1027,7 +1186,7 @@ namespace ante {
 
             //Store the tag as a UnionTag and a AnDataType
             //AnDataType *tagdt = AnDataType::create(nvn->name, exts, false, generics);
-            AnProductType *tagdt = AnProductType::create(nvn->name, exts, generics);
+            AnProductType *tagdt = AnProductType::create(nvn->name.str(), exts, generics);
 
             tagdt->parentUnionType = data;
             tagdt->isGeneric = isGeneric(exts);
@@ -1041,7 +1200,7 @@ namespace ante {
 
     void NameResolutionVisitor::visitTypeFamily(DataDeclNode *n){
         auto *family = AnProductType::createTypeFamily(n->name, convertToTypeArgs(n->generics, compUnit));
-        define(n->name, family, n->loc);
+        define(Symbol::get(n->name), family, n->loc);
     }
 
 
@@ -1056,7 +1215,7 @@ namespace ante {
 
         AnProductType *data = AnProductType::create(n->name, {}, convertToTypeArgs(n->generics, compUnit));
 
-        define(n->name, data, n->loc);
+        define(Symbol::get(n->name), data, n->loc);
         data->fields.reserve(n->fields);
         data->fieldNames.reserve(n->fields);
         data->isAlias = n->isAlias;
@@ -1065,20 +1224,20 @@ namespace ante {
             TypeNode *tyn = (TypeNode*)nvn->typeExpr.get();
             auto ty = toAnType(tyn, compUnit);
 
-            auto var = new Variable(nvn->name, n);
+            auto var = new Variable(nvn->name.str(), n);
             nvn->decl = var;
 
             validateType(ty, n);
 
             data->fields.push_back(ty);
-            data->fieldNames.push_back(nvn->name);
+            data->fieldNames.push_back(nvn->name.str());
 
             nvn = (NamedValNode*)nvn->next.get();
         }
     }
 
-    void mutateWithNewTypeVarNodes(TypeNode *ty, unordered_map<string, AnTypeVarType*> &map){
-        auto mn = dynamic_cast<ModNode*>(ty);
+    void mutateWithNewTypeVarNodes(TypeNode *ty, TypeVarMap &map){
+        auto mn = dyn_cast<ModNode>(ty);
         if(mn){
             mutateWithNewTypeVarNodes(static_cast<TypeNode*>(mn->expr.get()), map);
             return;
@@ -1089,23 +1248,24 @@ namespace ante {
         }
         if(ty->extTy){
             for(Node &node : *ty->extTy){
-                if(TypeNode *ext = dynamic_cast<TypeNode*>(&node)){
+                if(TypeNode *ext = dyn_cast<TypeNode>(&node)){
                     mutateWithNewTypeVarNodes((TypeNode*)ext, map);
                 }
             }
         }else if(ty->typeTag == TT_TypeVar){
-            auto it = map.find(ty->typeName);
+            auto tv = AnTypeVarType::get(ty->typeName);
+            auto it = map.find(tv);
             if(it != map.end()){
-                ty->typeName = it->second->name;
+                ty->typeName = it->second->getName();
             }else{
-                auto newTypeVar = nextTypeVar();
-                map[ty->typeName] = newTypeVar;
-                ty->typeName = newTypeVar->name;
+                auto newTypeVar = nextTypeVar(tv->isRhoVar());
+                map[tv] = newTypeVar;
+                ty->typeName = newTypeVar->getName();
             }
         }
     }
 
-    void mutateWithNewTypeVarNodes(FuncDeclNode *fdn, unordered_map<string, AnTypeVarType*> &map){
+    void mutateWithNewTypeVarNodes(FuncDeclNode *fdn, TypeVarMap &map){
         if(fdn->returnType) mutateWithNewTypeVarNodes(fdn->returnType.get(), map);
         for(Node& node : *fdn->params){
             auto nvn = static_cast<NamedValNode*>(&node);
@@ -1116,24 +1276,24 @@ namespace ante {
     }
 
     void NameResolutionVisitor::visit(TraitNode *n){
-        unordered_map<string, AnTypeVarType*> map;
+        TypeVarMap map;
         auto typeArgs = convertToNewTypeArgs(n->generics, compUnit, map);
-        auto decl = new TraitDecl(n->name, typeArgs);
+        auto decl = new TraitDecl(n->name.str(), typeArgs);
 
         // trait type is created here but the internal trait
         // tr will still be mutated with additional methods after
-        declare(decl, n->loc);
+        declare(n->name, decl, n->loc);
 
         enterFunction();
         for(Node &child : *n->child){
-            if(FuncDeclNode *fdn = dynamic_cast<FuncDeclNode*>(&child)){
+            if(FuncDeclNode *fdn = dyn_cast<FuncDeclNode>(&child)){
                 mutateWithNewTypeVarNodes(fdn, map);
                 child.accept(*this);
                 auto *fd = static_cast<FuncDecl*>(fdn->decl);
                 fd->traitFuncDecl = true;
                 compUnit->fnDecls[fdn->name] = fd;
                 decl->funcs.emplace_back(fd);
-            }else if(DataDeclNode *type = dynamic_cast<DataDeclNode*>(&child)){
+            }else if(DataDeclNode *type = dyn_cast<DataDeclNode>(&child)){
                 child.accept(*this);
                 decl->typeFamilies.emplace_back(type->name, convertToNewTypeArgs(type->generics, compUnit, map));
             }
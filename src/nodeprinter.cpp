@@ -222,7 +222,7 @@ void PrintingVisitor::visit(IfNode *n){
 void PrintingVisitor::visit(NamedValNode *n){
     cout << '(' << n->name;
 
-    if(!n->name.empty() && n->typeExpr)
+    if(!n->name.ref().empty() && n->typeExpr)
         cout << ": ";
 
     if(n->typeExpr)
@@ -322,11 +322,12 @@ void PrintingVisitor::visit(FuncDeclNode *n){
         cout << n->name << ": " << anTypeToColoredStr(n->getType()) << '\n';
     }
 
-    if(!n->name.empty() && n->name[n->name.size()-1] == ';'){
+    llvm::StringRef name = n->name;
+    if(!name.empty() && name.back() == ';'){
         isExtern = true;
-        cout << n->name.substr(0, n->name.size()-1);
+        cout << name.drop_back().str();
     }else{
-        cout << (n->name.empty() ? "\\" : n->name.c_str());
+        cout << (name.empty() ? "\\" : n->name.c_str());
     }
 
     if(n->params){
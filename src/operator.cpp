@@ -414,7 +414,7 @@ TypedValue compIf(Compiler *c, IfNode *ifn, BasicBlock *mergebb, vector<pair<Typ
     BasicBlock *elsebb = 0;
 
     if(ifn->elseN){
-        if(dynamic_cast<IfNode*>(ifn->elseN.get())){
+        if(isa<IfNode>(ifn->elseN.get())){
             elsebb = BasicBlock::Create(*c->ctxt, "elif");
             c->builder.CreateCondBr(cond.val, thenbb, elsebb);
 
@@ -551,25 +551,34 @@ bool hasTrivialImpl(TraitImpl *impl){
     }
 }
 
-void attachTraitImpl(Declaration *decl, AnType *fnTy, Module *m, LOC_TY &loc){
-    if(decl->isTraitFuncDecl()){
-        auto trait = try_cast<AnFunctionType>(fnTy)->typeClassConstraints.front();
-        if(!hasTrivialImpl(trait)){
-            auto impl = m->lookupTraitImpl(trait->name, trait->typeArgs);
-            if(!impl){
-                error("No impl for " + traitToColoredStr(trait) + " in scope", loc);
-            }else if(impl){
-                trait->impl = impl->impl;
-            }
-        }
-    }
+/**
+ * Set the impl of decl's trait constraint within fnTy, returning the
+ * module's memoized impl so its methods need not be resolved again.
+ * Returns null if the constraint has no memoizable impl.
+ */
+Module::ResolvedImpl* attachTraitImpl(Declaration *decl, AnType *fnTy, Module *m, LOC_TY &loc){
+    if(!decl->isTraitFuncDecl())
+        return nullptr;
+
+    auto trait = try_cast<AnFunctionType>(fnTy)->typeClassConstraints.front();
+    if(hasTrivialImpl(trait))
+        return nullptr;
+
+    Symbol traitName = Symbol::get(trait->name);
+    auto resolved = m->resolveTraitImpl(traitName, trait->typeArgs);
+    auto impl = resolved ? resolved->impl : m->lookupTraitImpl(traitName, trait->typeArgs);
+    if(!impl){
+        error("No impl for " + traitToColoredStr(trait) + " in scope", loc);
+    }
+    trait->impl = impl->impl;
+    return resolved;
 }
 
-Declaration* findFnInImpl(string const& fnName, TraitImpl *impl){
+Declaration* findFnInImpl(Symbol fnName, TraitImpl *impl){
     auto extNode = impl->impl;
     if(extNode && extNode->methods){
         for(Node& n : *extNode->methods){
-            if(auto fdn = dynamic_cast<FuncDeclNode*>(&n)){
+            if(auto fdn = dyn_cast<FuncDeclNode>(&n)){
                 if(fdn->name == fnName){
                     return fdn->decl;
                 }
@@ -580,6 +589,18 @@ Declaration* findFnInImpl(string const& fnName, TraitImpl *impl){
     ASSERT_UNREACHABLE();
 }
 
+/**
+ * Find the function named fnName within the impl attached to the given
+ * trait constraint, using the impl returned by attachTraitImpl if any
+ * since its methods are memoized by the module.
+ */
+Declaration* findTraitFn(Module::ResolvedImpl *resolved, Symbol fnName, TraitImpl *trait){
+    if(resolved)
+        if(Declaration *fn = resolved->findMethod(fnName))
+            return fn;
+    return findFnInImpl(fnName, trait);
+}
+
 TypedValue monomorphise(Compiler *c, FuncDecl *fd, AnFunctionType *boundType, LOC_TY &loc){
     auto fnTy = try_cast<AnFunctionType>(fd->definition->getType());
 
@@ -602,7 +623,7 @@ AnFunctionType* applyMonomorphisationBindings(AnFunctionType *type, Substitution
 }
 
 TypedValue compForLoopTraitFn(Compiler *c, string const& fnName, TraitImpl *impl, AnType *argTy, LOC_TY &loc){
-    FuncDecl *fn = static_cast<FuncDecl*>(findFnInImpl(fnName, impl));
+    FuncDecl *fn = static_cast<FuncDecl*>(findFnInImpl(Symbol::get(fnName), impl));
 
     auto fnTy = try_cast<AnFunctionType>(fn->tval.type);
     auto boundTy = AnFunctionType::get(fnTy->retTy, {argTy}, fnTy->typeClassConstraints);
@@ -619,16 +640,16 @@ TypedValue compForLoopTraitFn(Compiler *c, string const& fnName, TraitImpl *impl
 }
 
 TypedValue getFunction(Compiler *c, BinOpNode *bop){
-    auto vn = dynamic_cast<VarNode*>(bop->lval.get());
+    auto vn = dyn_cast<VarNode>(bop->lval.get());
     Declaration *decl = bop->decl;
     if(decl->tval.val){
         return decl->tval;
     }else if(decl->isTraitFuncDecl()){
         auto fnTy = try_cast<AnFunctionType>(bop->lval->getType());
         fnTy = applyMonomorphisationBindings(fnTy, c->compCtxt->monomorphisationMappings);
-        attachTraitImpl(decl, fnTy, c->compUnit, bop->loc);
+        auto resolved = attachTraitImpl(decl, fnTy, c->compUnit, bop->loc);
         TraitImpl *trait = fnTy->typeClassConstraints.front();
-        Declaration *fn = findFnInImpl(static_cast<VarNode*>(bop->lval.get())->name, trait);
+        Declaration *fn = findTraitFn(resolved, static_cast<VarNode*>(bop->lval.get())->name, trait);
         return monomorphise(c, static_cast<FuncDecl*>(fn), fnTy, bop->loc);
     }else if(decl->isFuncDecl()){
         auto fnTy = try_cast<AnFunctionType>(bop->lval->getType());
@@ -721,11 +742,11 @@ vector<AnType*> toAnTypeVector(vector<TypedValue> &tvs){
 
 
 string getName(Node *n){
-    if(VarNode *vn = dynamic_cast<VarNode*>(n))
-        return vn->name;
-    else if(BinOpNode *op = dynamic_cast<BinOpNode*>(n))
+    if(VarNode *vn = dyn_cast<VarNode>(n))
+        return vn->name.str();
+    else if(BinOpNode *op = dyn_cast<BinOpNode>(n))
         return getName(op->lval.get()) + "_" + getName(op->rval.get());
-    else if(TypeNode *tn = dynamic_cast<TypeNode*>(n))
+    else if(TypeNode *tn = dyn_cast<TypeNode>(n))
         return tn->params.empty() ? typeNodeToStr(tn) : tn->typeName;
     else
         return "";
@@ -1262,7 +1283,7 @@ TypedValue compFnCall(Compiler *c, BinOpNode *bop){
     Node *r = bop->rval.get();
 
     //add all remaining arguments
-    if(auto *tup = dynamic_cast<TupleNode*>(r)){
+    if(auto *tup = dyn_cast<TupleNode>(r)){
         typedArgs = tup->unpack(c);
 
         for(TypedValue v : typedArgs){
@@ -1348,7 +1369,7 @@ TypedValue compFnCall(Compiler *c, BinOpNode *bop){
             string baseName = getName(l);
             auto *fnty = try_cast<AnFunctionType>(tvf.type);
             string mangledName = mangle(baseName, fnty->extTys);
-            if(auto *tup = dynamic_cast<TupleNode*>(r)){
+            if(auto *tup = dyn_cast<TupleNode>(r)){
                 return compMetaFunctionResult(c, l->loc, baseName, mangledName, typedArgs, tup->exprs);
             }else{
                 vector<unique_ptr<Node>> anteExpr;
@@ -1632,7 +1653,7 @@ bool isPrimitiveOp(BinOpNode *n, AnType *l, AnType *r){
  */
 void CompilingVisitor::visit(BinOpNode *n){
     if(n->op == '.'){
-        if(dynamic_cast<IntLitNode*>(n->rval.get())){
+        if(isa<IntLitNode>(n->rval.get())){
             TypedValue l = CompilingVisitor::compile(c, n->lval);
             TypedValue r = CompilingVisitor::compile(c, n->rval);
             this->val = c->compExtract(l, r, n);
@@ -1680,9 +1701,9 @@ void CompilingVisitor::visit(BinOpNode *n){
                 return;
             }
 
-            attachTraitImpl(n->decl, fnTy, c->compUnit, n->loc);
+            auto resolved = attachTraitImpl(n->decl, fnTy, c->compUnit, n->loc);
             TraitImpl *trait = fnTy->typeClassConstraints.front();
-            Declaration *fn = findFnInImpl(Lexer::getTokStr(n->op), trait);
+            Declaration *fn = findTraitFn(resolved, Symbol::get(Lexer::getTokStr(n->op)), trait);
             fnVal = monomorphise(c, static_cast<FuncDecl*>(fn), fnTy, n->loc);
         }
 
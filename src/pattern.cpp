@@ -174,25 +174,25 @@ namespace ante {
     void handlePattern(CompilingVisitor &cv, MatchNode *n, Node *pattern,
             BasicBlock *jmpOnFail, TypedValue valToMatch){
 
-        if(TupleNode *tn = dynamic_cast<TupleNode*>(pattern)){
+        if(TupleNode *tn = dyn_cast<TupleNode>(pattern)){
             match_tuple(cv, n, tn, jmpOnFail, valToMatch);
 
-        }else if(TypeCastNode *tcn = dynamic_cast<TypeCastNode*>(pattern)){
+        }else if(TypeCastNode *tcn = dyn_cast<TypeCastNode>(pattern)){
             match_variant(cv, n, tcn->typeExpr.get(), tcn->rval.get(), jmpOnFail, valToMatch);
 
-        }else if(TypeNode *tn = dynamic_cast<TypeNode*>(pattern)){
+        }else if(TypeNode *tn = dyn_cast<TypeNode>(pattern)){
             match_variant(cv, n, tn, nullptr, jmpOnFail, valToMatch);
 
-        }else if(VarNode *vn = dynamic_cast<VarNode*>(pattern)){
+        }else if(VarNode *vn = dyn_cast<VarNode>(pattern)){
             match_var(cv, n, vn, jmpOnFail, valToMatch);
 
-        }else if(dynamic_cast<IntLitNode*>(pattern)){
+        }else if(isa<IntLitNode>(pattern)){
             match_literal(cv, n, pattern, jmpOnFail, valToMatch, Int);
 
-        }else if(dynamic_cast<FltLitNode*>(pattern)){
+        }else if(isa<FltLitNode>(pattern)){
             match_literal(cv, n, pattern, jmpOnFail, valToMatch, Flt);
 
-        }else if(dynamic_cast<StrLitNode*>(pattern)){
+        }else if(isa<StrLitNode>(pattern)){
             match_literal(cv, n, pattern, jmpOnFail, valToMatch, Str);
 
         }else{
@@ -0,0 +1,235 @@
+#include "promotingvisitor.h"
+#include "antype.h"
+#include "trait.h"
+
+using namespace std;
+
+namespace ante {
+    using namespace parser;
+
+    extern AnTypeContainer typeArena;
+
+    void PromotingVisitor::promoteModule(Module &module){
+        vector<Module*> worklist{&module};
+
+        while(!worklist.empty()){
+            Module *m = worklist.back();
+            worklist.pop_back();
+
+            for(auto &ty : m->userTypes)
+                typeArena.promote(ty.second.type);
+
+            for(auto &fn : m->fnDecls){
+                typeArena.promote(fn.second->type);
+                typeArena.promote(fn.second->tval.type);
+            }
+
+            for(auto &decl : m->traitDecls){
+                for(auto *typeArg : decl.second->typeArgs)
+                    typeArena.promote(typeArg);
+
+                for(auto &family : decl.second->typeFamilies)
+                    for(auto *typeArg : family.typeArgs)
+                        typeArena.promote(typeArg);
+
+                for(auto &fn : decl.second->funcs)
+                    typeArena.promote(fn->type);
+            }
+
+            for(auto &impls : m->traitImpls)
+                for(auto *impl : impls.second.getImpls())
+                    typeArena.promote(impl);
+
+            for(auto &resolved : m->resolvedImpls)
+                for(auto *typeArg : resolved.first.typeArgs)
+                    typeArena.promote(typeArg);
+
+            if(m->ast)
+                promoteAst(m->ast.get());
+
+            for(auto it = m->childrenBegin(); it != m->childrenEnd(); ++it)
+                worklist.push_back(&it->getValue());
+        }
+    }
+
+    void PromotingVisitor::promoteNodeType(Node *n){
+        typeArena.promote(n->getType());
+    }
+
+    void PromotingVisitor::visit(RootNode *n){
+        for(auto &m : n->imports)
+            m->accept(*this);
+        for(auto &m : n->types)
+            m->accept(*this);
+        for(auto &m : n->traits)
+            m->accept(*this);
+        for(auto &m : n->extensions)
+            m->accept(*this);
+        for(auto &m : n->funcs)
+            m->accept(*this);
+        for(auto &m : n->main)
+            m->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(IntLitNode *n){
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(FltLitNode *n){
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(BoolLitNode *n){
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(StrLitNode *n){
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(CharLitNode *n){
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(ArrayNode *n){
+        for(auto &e : n->exprs)
+            e->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(TupleNode *n){
+        for(auto &e : n->exprs)
+            e->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(ModNode *n){
+        if(n->expr)
+            n->expr->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(TypeNode *n){
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(TypeCastNode *n){
+        n->rval->accept(*this);
+        n->typeExpr->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(UnOpNode *n){
+        n->rval->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(SeqNode *n){
+        for(auto &stmt : n->sequence)
+            stmt->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(VarNode *n){
+        if(n->decl)
+            promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(BinOpNode *n){
+        n->lval->accept(*this);
+        n->rval->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(BlockNode *n){
+        n->block->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(RetNode *n){
+        if(n->expr)
+            n->expr->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(ImportNode *n){}
+
+    void PromotingVisitor::visit(IfNode *n){
+        n->condition->accept(*this);
+        n->thenN->accept(*this);
+        if(n->elseN)
+            n->elseN->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(NamedValNode *n){
+        if(n->typeExpr)
+            n->typeExpr->accept(*this);
+        if(n->decl)
+            promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(VarAssignNode *n){
+        n->expr->accept(*this);
+        n->ref_expr->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(ExtNode *n){
+        for(Node &m : *n->methods)
+            m.accept(*this);
+        if(n->traitType)
+            typeArena.promote(n->traitType);
+    }
+
+    void PromotingVisitor::visit(JumpNode *n){
+        if(n->expr)
+            n->expr->accept(*this);
+    }
+
+    void PromotingVisitor::visit(WhileNode *n){
+        n->condition->accept(*this);
+        n->child->accept(*this);
+    }
+
+    void PromotingVisitor::visit(ForNode *n){
+        n->range->accept(*this);
+        n->pattern->accept(*this);
+        n->child->accept(*this);
+        if(n->iterableInstance)
+            typeArena.promote(n->iterableInstance);
+    }
+
+    void PromotingVisitor::visit(MatchNode *n){
+        n->expr->accept(*this);
+        for(auto &b : n->branches)
+            b->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(MatchBranchNode *n){
+        n->pattern->accept(*this);
+        n->branch->accept(*this);
+        promoteNodeType(n);
+    }
+
+    void PromotingVisitor::visit(FuncDeclNode *n){
+        if(n->params)
+            for(Node &p : *n->params)
+                p.accept(*this);
+
+        if(n->child)
+            n->child->accept(*this);
+
+        if(n->decl){
+            if(n->decl->isFuncDecl())
+                typeArena.promote(static_cast<FuncDecl*>(n->decl)->type);
+            promoteNodeType(n);
+        }
+    }
+
+    void PromotingVisitor::visit(DataDeclNode *n){}
+
+    void PromotingVisitor::visit(TraitNode *n){}
+}
@@ -5,8 +5,11 @@
  */
 #include "compiler.h"
 #include "yyparser.h"
+#include "parsecontext.h"
 #include "unification.h"
 #include "util.h"
+#include "scopeguard.h"
+#include "sourcebuffer.h"
 #include <stack>
 
 #include <compiler.h>
@@ -18,16 +21,48 @@ namespace ante {
 
     namespace parser {
 
-        //stack of relative roots, eg. a FuncDeclNode's first statement would be set as the
-        //relative root, where the last would be returned by the parser.  Relative roots are
-        //returned through getRoot() which also pops the stack.
-        stack<Node*> roots;
+        thread_local NodeArena *currentNodeArena = nullptr;
 
-        //The single true-root of the compiled file.  One RootNode per file parsed.
-        RootNode *root;
+        /* Each Node is preceeded by the arena it was allocated in, or null if it is on the heap */
+        static void* allocateNode(size_t size, NodeArena *arena){
+            size += sizeof(NodeArena*);
+            auto header = (NodeArena**)(arena ? arena->allocate(size) : ::operator new(size));
+            *header = arena;
+            return header + 1;
+        }
+
+        void* Node::operator new(size_t size){
+            return allocateNode(size, currentNodeArena);
+        }
+
+        void* RootNode::operator new(size_t size){
+            return allocateNode(size, nullptr);
+        }
+
+        void Node::operator delete(void *node){
+            if(!node) return;
+
+            //Nodes in an arena are only freed along with the whole arena
+            auto header = (NodeArena**)node - 1;
+            if(!*header)
+                ::operator delete(header);
+        }
+
+        int ParseContext::parse(){
+            TMP_SET(currentNodeArena, arena.get());
+            yy::parser p{*this};
+            int flag = p.parse();
+            if(flag != PE_OK){
+                //print out remaining errors
+                int tok;
+                LOC_TY loc;
+                while((tok = lexer->next(&loc)) != Tok_Newline && tok != 0);
+                while(p.parse() != PE_OK && lexer->peek() != 0);
+            }
 
-        RootNode* getRootNode(){
-            return root;
+            if(root)
+                root->arena = move(arena);
+            return flag;
         }
 
         AnType* VarNode::getType() const {
@@ -55,16 +90,16 @@ namespace ante {
         }
 
         Node* setElse(Node *ifn, Node *elseN){
-            if(auto *n = dynamic_cast<IfNode*>(ifn)){
+            if(auto *n = dyn_cast<IfNode>(ifn)){
                 if(n->elseN)
                     setElse(n->elseN.get(), elseN);
                 else
                     n->elseN.reset(elseN);
             }else{
-                auto *seq = dynamic_cast<SeqNode*>(ifn);
+                auto *seq = dyn_cast<SeqNode>(ifn);
 
-                if(seq && (n = dynamic_cast<IfNode*>(seq->sequence.back().get()))){
-                    while(auto *tmp = dynamic_cast<IfNode*>(n->elseN.get()))
+                if(seq && (n = dyn_cast<IfNode>(seq->sequence.back().get()))){
+                    while(auto *tmp = dyn_cast_or_null<IfNode>(n->elseN.get()))
                         n = tmp;
 
                     n->elseN.reset(elseN);
@@ -76,67 +111,56 @@ namespace ante {
             return ifn;
         }
 
-        yy::position mkPos(string *f, unsigned int line, unsigned int col) {
-            yy::position pos;
-            pos.filename = f;
-            pos.line = line;
-            pos.column = col;
-            return pos;
-        }
-
-        LOC_TY mkLoc(yy::position begin, yy::position end) {
-            LOC_TY loc;
-            loc.begin = begin;
-            loc.end = end;
-            return loc;
-        }
-
         //initializes the root node
-        void createRoot(LOC_TY& loc){
+        void ParseContext::createRoot(LOC_TY& loc){
             root = new RootNode(loc);
         }
 
-        void createRoot(){
-            auto loc = mkLoc(mkPos(yylexer->fileName, 0, 0),
-                             mkPos(yylexer->fileName, 0, 0));
+        void ParseContext::createRoot(){
+            //The root only covers the start of its file, which is enough to find the file from its loc
+            SourceLoc start;
+            if(SourceBuffer *source = lexer->getSource())
+                start = source->getLoc(source->begin());
+
+            LOC_TY loc{start, start};
             createRoot(loc);
         }
 
-        Node* append_main(Node *n){
+        Node* ParseContext::append_main(Node *n){
             root->main.emplace_back(n);
             return n;
         }
 
-        Node* append_fn(Node *n){
+        Node* ParseContext::append_fn(Node *n){
             root->funcs.emplace_back(n);
             return n;
         }
 
-        Node* append_type(Node *n){
+        Node* ParseContext::append_type(Node *n){
             root->types.emplace_back(n);
             return n;
         }
 
-        Node* append_extension(Node *n){
+        Node* ParseContext::append_extension(Node *n){
             root->extensions.emplace_back(n);
             return n;
         }
 
-        Node* append_trait(Node *n){
+        Node* ParseContext::append_trait(Node *n){
             root->traits.emplace_back(n);
             return n;
         }
 
-        Node* append_import(Node *n){
+        Node* ParseContext::append_import(Node *n){
             root->imports.emplace_back(n);
             return n;
         }
 
         void copyModsToContainedNodes(ModNode *m, ModifiableNode *n){
             if(!m->isCompilerDirective()){
-                if(ExtNode *en = dynamic_cast<ExtNode*>(n)){
+                if(ExtNode *en = dyn_cast<ExtNode>(n)){
                     for(Node &f : *en->methods){
-                        if(ModifiableNode *fmn = dynamic_cast<ModifiableNode*>(&f)){
+                        if(ModifiableNode *fmn = dyn_cast<ModifiableNode>(&f)){
                             ModNode *cpy = new ModNode(m->loc, m->mod, nullptr);
                             fmn->modifiers.emplace_back(cpy);
                         }
@@ -147,12 +171,12 @@ namespace ante {
 
         Node* append_modifier(Node *modifier, Node *modifiableNode){
             ModNode *m = (ModNode*)modifier;
-            if(ModifiableNode *van = dynamic_cast<ModifiableNode*>(modifiableNode)){
+            if(ModifiableNode *van = dyn_cast<ModifiableNode>(modifiableNode)){
                 van->modifiers.emplace_back(m);
                 copyModsToContainedNodes(m, van);
 
                 return van;
-            }else if(BinOpNode *assign = dynamic_cast<BinOpNode*>(modifiableNode)){
+            }else if(BinOpNode *assign = dyn_cast<BinOpNode>(modifiableNode)){
                 if(assign->op == '='){
                     auto *vas = new VarAssignNode(assign->loc, assign->lval.release(), assign->rval.release(), false);
                     delete assign;
@@ -171,23 +195,12 @@ namespace ante {
             return modifiableNode;
         }
 
-        LOC_TY copyLoc(const LOC_TY &loc){
-            return mkLoc(mkPos(loc.begin.filename, loc.begin.line, loc.begin.column),
-                        mkPos(loc.end.filename,   loc.end.line,   loc.end.column));
-        }
-
-        /*
-        *  Saves the root of a new block and returns it.
-        */
-        Node* setRoot(Node* node){
+        Node* ParseContext::setRoot(Node* node){
             roots.push(node);
             return node;
         }
 
-        /*
-        *  Pops and returns the root of the current block
-        */
-        Node* getRoot(){
+        Node* ParseContext::getRoot(){
             Node *ret = roots.top();
             roots.pop();
             return ret;
@@ -322,7 +335,7 @@ namespace ante {
         Node* mkTypeNode(LOC_TY loc, TypeTag type, char* typeName, Node* extTy){
             if(type == TT_Array){
                 //2nd type ext is size of the array when making Array types, ensure it is an intlit
-                auto *size = dynamic_cast<IntLitNode*>(extTy->next.get());
+                auto *size = dyn_cast_or_null<IntLitNode>(extTy->next.get());
 
                 if(!size){
                     ante::error("Size of array must be an integer literal", extTy->next->loc);
@@ -333,12 +346,12 @@ namespace ante {
 
         Node* mkInferredTypeNode(LOC_TY loc){
             auto t = nextTypeVar();
-            return new TypeNode(loc, TT_TypeVar, t->name, nullptr);
+            return new TypeNode(loc, TT_TypeVar, t->getName(), nullptr);
         }
 
         Node* mkTypeCastNode(LOC_TY loc, Node *l, Node *r){
             auto type = static_cast<TypeNode*>(l);
-            auto arg  = dynamic_cast<TypeNode*>(r);
+            auto arg  = dyn_cast<TypeNode>(r);
             //TODO: Fix this parse conflict
             if(arg){
                 type->params.emplace_back(arg);
@@ -357,7 +370,7 @@ namespace ante {
         }
 
         Node* mkSeqNode(LOC_TY loc, Node *l, Node *r){
-            if(SeqNode *seq = dynamic_cast<SeqNode*>(l)){
+            if(SeqNode *seq = dyn_cast<SeqNode>(l)){
                 seq->sequence.emplace_back(r);
                 return seq;
             }else{
@@ -387,6 +400,10 @@ namespace ante {
             return new VarNode(loc, s);
         }
 
+        Node* mkVarNode(LOC_TY loc, Symbol s){
+            return new VarNode(loc, s);
+        }
+
         Node* mkImportNode(LOC_TY loc, Node* expr){
             return new ImportNode(loc, expr);
         }
@@ -412,27 +429,27 @@ namespace ante {
         }
 
         Node* mkForNode(LOC_TY loc, Node* var, Node* range, Node* body){
-            return new ForNode(loc, new VarNode(loc, (char*)var), range, body);
+            return new ForNode(loc, new VarNode(loc, Symbol::fromInterned((char*)var)), range, body);
         }
 
         char* nextVarArgsTVName(){
-            return strdup((ante::nextTypeVar()->name + "...").c_str());
+            return strdup(ante::nextTypeVar(true)->getName().c_str());
         }
 
         NamedValNode* convertParam(Node *param){
-            TypeNode *tn = dynamic_cast<TypeNode*>(param);
+            TypeNode *tn = dyn_cast<TypeNode>(param);
             if(tn){
                 return new NamedValNode(tn->loc, "_", tn);
             }
-            VarNode *vn = dynamic_cast<VarNode*>(param);
+            VarNode *vn = dyn_cast<VarNode>(param);
             if(vn){
                 return new NamedValNode(vn->loc, vn->name, mkInferredTypeNode(vn->loc));
             }
-            BinOpNode *bop = dynamic_cast<BinOpNode*>(param);
+            BinOpNode *bop = dyn_cast<BinOpNode>(param);
             if(bop){
                 if(bop->op == ':'){
-                    VarNode *vn = dynamic_cast<VarNode*>(bop->lval.get());
-                    TypeNode *tn = dynamic_cast<TypeNode*>(bop->rval.get());
+                    VarNode *vn = dyn_cast<VarNode>(bop->lval.get());
+                    TypeNode *tn = dyn_cast<TypeNode>(bop->rval.get());
                     if(!vn || !tn){
                         ante::error("Invalid syntax in type ascription", bop->loc);
                     }
@@ -440,14 +457,14 @@ namespace ante {
 
                 //manually fix a parsing glitch that causes (var: Type TypeArg TypeArg) to be parsed as ((var:Type) TypeArg TypeArg)
                 }else if(bop->op == '('){
-                    BinOpNode *l = dynamic_cast<BinOpNode*>(bop->lval.get());
-                    TupleNode *typeargs = dynamic_cast<TupleNode*>(bop->rval.get());
+                    BinOpNode *l = dyn_cast<BinOpNode>(bop->lval.get());
+                    TupleNode *typeargs = dyn_cast<TupleNode>(bop->rval.get());
                     if(l && typeargs && l->op == ':'){
-                        VarNode *var = dynamic_cast<VarNode*>(l->lval.get());
-                        TypeNode *basety = dynamic_cast<TypeNode*>(l->rval.get());
+                        VarNode *var = dyn_cast<VarNode>(l->lval.get());
+                        TypeNode *basety = dyn_cast<TypeNode>(l->rval.get());
                         if(var && basety){
                             for(auto &expr : typeargs->exprs){
-                                auto tn = dynamic_cast<TypeNode*>(expr.get());
+                                auto tn = dyn_cast<TypeNode>(expr.get());
                                 if(!tn){
                                     ante::error("Expected a typearg here", expr->loc);
                                 }
@@ -459,7 +476,7 @@ namespace ante {
                 }
             }
             // hard coded case before full pattern matching is implemented for function parameters
-            TupleNode *tup = dynamic_cast<TupleNode*>(param);
+            TupleNode *tup = dyn_cast<TupleNode>(param);
             if(tup){
                 if(tup->exprs.empty()){
                     return new NamedValNode(tup->loc, "", new TypeNode(tup->loc, TT_Unit, "", nullptr));
@@ -472,7 +489,7 @@ namespace ante {
         }
 
         NamedValNode* convertParams(Node *params){
-            NamedValNode *nvn = dynamic_cast<NamedValNode*>(params);
+            NamedValNode *nvn = dyn_cast_or_null<NamedValNode>(params);
             if(nvn) return nvn;
 
             NamedValNode *cur = 0;
@@ -492,12 +509,12 @@ namespace ante {
         }
 
         Node* mkFuncDeclNode(LOC_TY loc, Node* nameAndParams, Node* tExpr, Node* tcc, Node* body){
-            VarNode *name = dynamic_cast<VarNode*>(nameAndParams);
+            VarNode *name = dyn_cast<VarNode>(nameAndParams);
             if(!name){
                 ante::error("Expected function name here to start function declaration", nameAndParams->loc);
             }
             auto params = convertParams(name->next.release());
-            return new FuncDeclNode(loc, name->name.c_str(), (TypeNode*)tExpr, params, (TypeNode*)tcc, body);
+            return new FuncDeclNode(loc, name->name, (TypeNode*)tExpr, params, (TypeNode*)tcc, body);
         }
 
         Node* mkFuncCallNode(LOC_TY loc, Node* nameAndArgs){
@@ -538,7 +555,7 @@ namespace ante {
                 genericsVec.emplace_back((TypeNode*)generics);
                 generics = generics->next.release();
             }
-            return new TraitNode(loc, s, move(genericsVec), fns);
+            return new TraitNode(loc, Symbol::fromInterned(s), move(genericsVec), fns);
         }
     } //end of namespace ante::parser
 } //end of namespace ante
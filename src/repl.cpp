@@ -4,7 +4,10 @@
 #include <string>
 #include <nameresolution.h>
 #include "typeinference.h"
+#include "parsecontext.h"
 #include "typeerror.h"
+#include "promotingvisitor.h"
+#include "sourcebuffer.h"
 
 #ifdef unix
 #  include <unistd.h>
@@ -18,8 +21,6 @@ using namespace std;
 using namespace ante;
 using namespace ante::parser;
 
-extern char* lextxt;
-
 extern "C" void* Ante_debug(Compiler *c, AnteValue &tv);
 
 namespace ante {
@@ -270,7 +271,7 @@ namespace ante {
 
         //lex through input to ensure all brackets are matched
         LOC_TY loc;
-        auto l = Lexer(nullptr, line, 1, 1, false);
+        auto l = Lexer(line, false);
         while (l.next(&loc)){ /* do nothing*/ };
 
         //unmatched {
@@ -328,7 +329,7 @@ namespace ante {
 #if defined(unix) || defined(_WIN32)
             //use lexer for syntax highlighting
             LOC_TY loc;
-            auto l = Lexer(nullptr, line, 1, 1, true);
+            auto l = Lexer(line, true);
             while (l.next(&loc)){ /* do nothing*/ };
 
             //move cursor from end of text to the current pos
@@ -349,7 +350,7 @@ namespace ante {
 
 #if defined(unix) || defined(_WIN32)
             LOC_TY loc;
-            auto l = Lexer(nullptr, line, 1, 1, true);
+            auto l = Lexer(line, true);
             while (l.next(&loc)){ /* do nothing*/ };
 #endif
         return line;
@@ -408,6 +409,21 @@ namespace ante {
     }
 
 
+    extern AnTypeContainer typeArena;
+
+    /**
+     * Free each type created while evaluating the last line that
+     * is no longer reachable from any module or the compiler's AST.
+     */
+    void collectLineTypes(Compiler *c){
+        PromotingVisitor::promoteModule(Module::getRoot());
+        if(c->compUnit)
+            PromotingVisitor::promoteModule(*c->compUnit);
+        if(c->getAST())
+            PromotingVisitor::promoteAst(c->getAST());
+        typeArena.collectNursery();
+    }
+
     void startRepl(Compiler *c){
         cout << "Ante REPL v0.2.0\nType 'exit' to exit.\n";
         setupTerm();
@@ -416,24 +432,27 @@ namespace ante {
 
         while(cmd != "exit\n"){
             int flag;
+            typeArena.openNursery();
+
+            //Each line gets its own buffer, released after the line's AST is freed below
+            unique_ptr<SourceBuffer, void(*)(SourceBuffer*)> line{SourceBuffer::create("", cmd), SourceBuffer::release};
+            ParseContext parseCtxt{new Lexer(line.get())};
             try{
-                setLexer(new Lexer(nullptr, cmd, /*line*/1, /*col*/1));
-                yy::parser p{};
-                flag = p.parse();
+                flag = parseCtxt.parse();
             }catch(CtError e){
+                collectLineTypes(c);
                 continue;
             }
 
             c->isJIT = true;
 
             LOC_TY loc;
-            ModNode *expr = new ModNode(loc, Tok_Ante, nullptr);
+            unique_ptr<ModNode> expr{new ModNode(loc, Tok_Ante, nullptr)};
             if(flag == PE_OK){
-                RootNode *root = parser::getRootNode();
-                auto leak = expr->expr.release();
+                RootNode *root = parseCtxt.root;
                 expr->expr.reset(root);
 
-                TypedValue val = mergeAndCompile(c, root, expr);
+                TypedValue val = mergeAndCompile(c, root, expr.get());
 
                 // Only print types until compile-time eval is setup again
                 if(val.type){
@@ -441,6 +460,7 @@ namespace ante {
                 }
             }
 
+            collectLineTypes(c);
             cmd = getInputColorized();
         }
 
@@ -453,8 +473,15 @@ namespace ante {
      */
     TypedValue mergeAndCompile(Compiler *c, RootNode *rn, ModNode *anteExpr){
         TypedValue ret;
+        NameResolutionVisitor v{"repl"};
+
+        //The line's module only borrows rn, which anteExpr owns, and is freed with the line
+        unique_ptr<Module, void(*)(Module*)> lineModule{v.compUnit, [](Module *m){
+            m->ast.release();
+            delete m;
+        }};
+
         try{
-            NameResolutionVisitor v{"repl"};
             size_t errc = errorCount();
             v.visit(rn);
             if(errorCount() > errc) return {};
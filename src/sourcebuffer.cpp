@@ -0,0 +1,130 @@
+#include "sourcebuffer.h"
+#include <llvm/ADT/StringMap.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+namespace ante {
+
+    /** Every buffer loaded so far, in order of their startOffsets.  Only buffers
+     *  made by create are ever freed since nodes from every module may still
+     *  report errors. */
+    static vector<unique_ptr<SourceBuffer>> buffers;
+
+    /** The buffer of each file loaded so far, keyed by file name */
+    static llvm::StringMap<SourceBuffer*> loadedFiles;
+
+    /** Guards buffers and loadedFiles */
+    static mutex buffersMutex;
+
+    /** The startOffset of the next buffer.  0 is left for invalid locations. */
+    static uint32_t nextOffset = 1;
+
+    SourceBuffer::SourceBuffer(string const& name, unique_ptr<llvm::MemoryBuffer> buffer)
+            : name{name}, buffer{move(buffer)}, startOffset{nextOffset}{
+
+        //Reserve an offset for each character and one more for the end of the buffer
+        size_t size = this->buffer->getBufferSize() + 1;
+        if(size > UINT32_MAX - nextOffset){
+            cerr << "Error: Too much source code to load '" << name << "'\n";
+            exit(EXIT_FAILURE);
+        }
+        nextOffset += size;
+    }
+
+    SourceBuffer* SourceBuffer::get(string const& fileName){
+        lock_guard<mutex> lock{buffersMutex};
+        auto &entry = loadedFiles[fileName];
+        if(!entry){
+            auto buffer = llvm::MemoryBuffer::getFile(fileName);
+            if(!buffer)
+                return nullptr;
+            buffers.emplace_back(new SourceBuffer(fileName, move(*buffer)));
+            entry = buffers.back().get();
+        }
+        return entry;
+    }
+
+
+    SourceBuffer* SourceBuffer::getStdin(){
+        lock_guard<mutex> lock{buffersMutex};
+        auto &entry = loadedFiles["stdin"];
+        if(!entry){
+            auto buffer = llvm::MemoryBuffer::getSTDIN();
+            if(!buffer)
+                return nullptr;
+            buffers.emplace_back(new SourceBuffer("stdin", move(*buffer)));
+            entry = buffers.back().get();
+        }
+        return entry;
+    }
+
+
+    SourceBuffer* SourceBuffer::create(string const& name, llvm::StringRef text){
+        lock_guard<mutex> lock{buffersMutex};
+        buffers.emplace_back(new SourceBuffer(name, llvm::MemoryBuffer::getMemBufferCopy(text, name)));
+        return buffers.back().get();
+    }
+
+
+    void SourceBuffer::release(SourceBuffer *buffer){
+        lock_guard<mutex> lock{buffersMutex};
+        //The buffer is usually the last one created, e.g. the current line of the REPL
+        auto it = find_if(buffers.rbegin(), buffers.rend(), [&](unique_ptr<SourceBuffer> const& b){
+            return b.get() == buffer;
+        });
+        if(it != buffers.rend())
+            buffers.erase(prev(it.base()));
+    }
+
+
+    SourceBuffer* SourceBuffer::find(SourceLoc loc){
+        if(!loc.isValid())
+            return nullptr;
+
+        lock_guard<mutex> lock{buffersMutex};
+        auto it = upper_bound(buffers.begin(), buffers.end(), loc.getOffset(),
+                [](uint32_t offset, unique_ptr<SourceBuffer> const& buffer){
+                    return offset < buffer->startOffset;
+                });
+
+        if(it == buffers.begin())
+            return nullptr;
+
+        SourceBuffer *buffer = prev(it)->get();
+        return loc.getOffset() - buffer->startOffset <= buffer->buffer->getBufferSize()
+            ? buffer : nullptr;
+    }
+
+
+    void SourceBuffer::computeLineStarts() const {
+        call_once(lineStartsComputed, [this]{
+            lineStarts.push_back(0);
+            for(const char *c = begin(); c != end(); c++)
+                if(*c == '\n')
+                    lineStarts.push_back(c - begin() + 1);
+        });
+    }
+
+
+    LineAndColumn SourceBuffer::getLineAndColumn(SourceLoc loc) const {
+        computeLineStarts();
+        size_t offset = loc.getOffset() - startOffset;
+        auto line = upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+        unsigned int row = line - lineStarts.begin();
+        return {row, (unsigned int)(offset - lineStarts[row - 1] + 1)};
+    }
+
+
+    llvm::StringRef SourceBuffer::getLine(unsigned int row) const {
+        computeLineStarts();
+
+        if(row == 0 || row > lineStarts.size())
+            return "";
+
+        const char *line = begin() + lineStarts[row - 1];
+        const char *lineEnd = row < lineStarts.size() ? begin() + lineStarts[row] - 1 : end();
+        return llvm::StringRef(line, lineEnd - line);
+    }
+}
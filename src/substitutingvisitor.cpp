@@ -1,4 +1,5 @@
 #include "substitutingvisitor.h"
+#include "flatast.h"
 #include "antype.h"
 #include "compiler.h"
 #include "trait.h"
@@ -28,7 +29,7 @@ namespace ante {
         for(auto &m : n->main){
             m->accept(*this);
         }
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(IntLitNode *n){}
@@ -45,7 +46,7 @@ namespace ante {
         for(auto &e : n->exprs)
             e->accept(*this);
 
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(TupleNode *n){
@@ -53,52 +54,52 @@ namespace ante {
             e->accept(*this);
 
         if(!n->exprs.empty())
-            n->setType(applySubstitutions(substitutions, n->getType()));
+            n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(ModNode *n){
         if(n->expr)
             n->expr->accept(*this);
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(TypeNode *n){
         if(n->getType()){
-            n->setType(applySubstitutions(substitutions, n->getType()));
+            n->setType(substitutions.apply(n->getType()));
         }
     }
 
     void SubstitutingVisitor::visit(TypeCastNode *n){
         n->rval->accept(*this);
         n->typeExpr->accept(*this);
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(UnOpNode *n){
         n->rval->accept(*this);
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(SeqNode *n){
         for(auto &stmt : n->sequence){
             stmt->accept(*this);
         }
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(VarNode *n){
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(BinOpNode *n){
         n->lval->accept(*this);
         n->rval->accept(*this);
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(BlockNode *n){
         n->block->accept(*this);
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(RetNode *n){
@@ -113,14 +114,14 @@ namespace ante {
         n->thenN->accept(*this);
         if(n->elseN){
             n->elseN->accept(*this);
-            n->setType(applySubstitutions(substitutions, n->getType()));
+            n->setType(substitutions.apply(n->getType()));
         }
     }
 
     void SubstitutingVisitor::visit(NamedValNode *n){
         if(n->typeExpr)
             n->typeExpr->accept(*this);
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(VarAssignNode *n){
@@ -128,7 +129,7 @@ namespace ante {
         n->ref_expr->accept(*this);
 
         if(!n->modifiers.empty())
-            n->setType(applySubstitutions(substitutions, n->getType()));
+            n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(ExtNode *n){
@@ -149,7 +150,7 @@ namespace ante {
         n->range->accept(*this);
         n->pattern->accept(*this);
         n->child->accept(*this);
-        n->iterableInstance = applySubstitutions(substitutions, n->iterableInstance);
+        n->iterableInstance = substitutions.apply(n->iterableInstance);
     }
 
     void SubstitutingVisitor::visit(MatchNode *n){
@@ -157,13 +158,13 @@ namespace ante {
         for(auto &b : n->branches){
             b->accept(*this);
         }
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(MatchBranchNode *n){
         n->pattern->accept(*this);
         n->branch->accept(*this);
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(FuncDeclNode *n){
@@ -174,10 +175,67 @@ namespace ante {
         if(n->child)
             n->child->accept(*this);
 
-        n->setType(applySubstitutions(substitutions, n->getType()));
+        n->setType(substitutions.apply(n->getType()));
     }
 
     void SubstitutingVisitor::visit(DataDeclNode *n){}
 
     void SubstitutingVisitor::visit(TraitNode *n){}
+
+    void SubstitutingVisitor::substitute(FlatAst &flat){
+        for(NodeId id = 0; id < flat.size(); id++){
+            Node *n = flat.getNode(id);
+
+            switch(flat.getKind(id)){
+            //Literals are never given typevars, and the rest have
+            //no type of their own or keep the type of their children
+            case NodeKind::IntLit:
+            case NodeKind::FltLit:
+            case NodeKind::BoolLit:
+            case NodeKind::CharLit:
+            case NodeKind::StrLit:
+            case NodeKind::Ret:
+            case NodeKind::Import:
+            case NodeKind::Ext:
+            case NodeKind::Jump:
+            case NodeKind::While:
+            case NodeKind::DataDecl:
+            case NodeKind::Trait:
+                continue;
+
+            case NodeKind::Tuple:
+                if(static_cast<TupleNode*>(n)->exprs.empty())
+                    continue;
+                break;
+
+            case NodeKind::Type:
+                if(!flat.getType(id))
+                    continue;
+                break;
+
+            case NodeKind::If:
+                if(!static_cast<IfNode*>(n)->elseN)
+                    continue;
+                break;
+
+            case NodeKind::VarAssign:
+                if(static_cast<VarAssignNode*>(n)->modifiers.empty())
+                    continue;
+                break;
+
+            case NodeKind::For: {
+                auto *forNode = static_cast<ForNode*>(n);
+                forNode->iterableInstance = substitutions.apply(forNode->iterableInstance);
+                continue;
+            }
+
+            default:
+                break;
+            }
+
+            flat.setType(id, substitutions.apply(flat.getType(id)));
+        }
+
+        flat.storeTypes();
+    }
 }
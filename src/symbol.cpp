@@ -0,0 +1,117 @@
+#include "symbol.h"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/ADT/Hashing.h>
+#include <mutex>
+#include <atomic>
+#include <cassert>
+
+using namespace std;
+
+namespace ante {
+
+    namespace {
+        using SymbolEntry = llvm::StringMapEntry<uint32_t>;
+
+        /**
+         * Maps each interned string to its id and back.
+         *
+         * Strings are split between shards by their hash, each with its
+         * own lock, so threads interning different strings rarely wait
+         * on each other.  Ids are shared by every shard and index into
+         * fixed size chunks of entries which never move once allocated,
+         * so a symbol's string can be read without taking any lock.
+         */
+        struct SymbolTable {
+            static const size_t chunkBits = 12;
+            static const size_t chunkSize = 1 << chunkBits;
+            static const size_t maxChunks = 1 << 14;
+            static const size_t shardCount = 16;
+
+            struct Shard {
+                mutex lock;
+                llvm::StringMap<uint32_t, llvm::BumpPtrAllocator> ids;
+            };
+
+            Shard shards[shardCount];
+            atomic<const SymbolEntry**> chunks[maxChunks];
+            atomic<uint32_t> count{0};
+
+            SymbolTable(){
+                for(auto &chunk : chunks)
+                    chunk.store(nullptr, memory_order_relaxed);
+            }
+
+            ~SymbolTable(){
+                for(auto &chunk : chunks)
+                    delete[] chunk.load(memory_order_relaxed);
+            }
+
+            uint32_t intern(llvm::StringRef str){
+                auto &shard = shards[llvm::hash_value(str) % shardCount];
+                lock_guard<mutex> guard{shard.lock};
+                auto inserted = shard.ids.try_emplace(str, ~0u);
+                if(!inserted.second)
+                    return inserted.first->getValue();
+
+                uint32_t id = count++;
+                assert(id >> chunkBits < maxChunks && "Symbol table is full");
+                inserted.first->getValue() = id;
+                getChunk(id)[id & (chunkSize - 1)] = &*inserted.first;
+                return id;
+            }
+
+            /** Return the chunk holding the given id, allocating it if this is its first id */
+            const SymbolEntry** getChunk(uint32_t id){
+                auto &slot = chunks[id >> chunkBits];
+                const SymbolEntry **chunk = slot.load(memory_order_acquire);
+                if(chunk)
+                    return chunk;
+
+                //Ids from several shards may begin using the same chunk at once
+                const SymbolEntry **fresh = new const SymbolEntry*[chunkSize];
+                if(slot.compare_exchange_strong(chunk, fresh, memory_order_acq_rel))
+                    return fresh;
+
+                delete[] fresh;
+                return chunk;
+            }
+
+            const SymbolEntry* entry(uint32_t id) const {
+                return chunks[id >> chunkBits].load(memory_order_acquire)[id & (chunkSize - 1)];
+            }
+        };
+
+        SymbolTable& symbolTable(){
+            static SymbolTable table;
+            return table;
+        }
+    }
+
+
+    Symbol Symbol::get(llvm::StringRef str){
+        return Symbol{symbolTable().intern(str)};
+    }
+
+
+    Symbol Symbol::fromInterned(const char *interned){
+        //c_str returns the key of the symbol's entry, which is stored along with its id
+        return Symbol{SymbolEntry::GetStringMapEntryFromKeyData(interned).getValue()};
+    }
+
+
+    llvm::StringRef Symbol::ref() const {
+        return symbolTable().entry(id)->getKey();
+    }
+
+
+    const char* Symbol::c_str() const {
+        //StringMapEntry keys are always followed by a null terminator
+        return symbolTable().entry(id)->getKeyData();
+    }
+
+
+    size_t Symbol::count(){
+        return symbolTable().count;
+    }
+}
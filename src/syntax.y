@@ -19,12 +19,11 @@ using namespace ante;
 using namespace ante::parser;
 
 /* Defined in lexer.cpp */
-extern int yylex(yy::parser::semantic_type*, yy::location*);
+extern int yylex(yy::parser::semantic_type*, yy::parser::location_type*, ante::parser::ParseContext&);
 
 namespace ante {
     extern string typeNodeToStr(const TypeNode*);
     extern string mangle(std::string const& base, NamedValNode *paramTys);
-    static size_t ante_parser_errcount = 0;
 
     namespace parser {
         struct TypeNode;
@@ -37,9 +36,17 @@ namespace ante {
 
 %}
 
+%code requires {
+    #include "sourcelocation.h"
+    namespace ante { namespace parser { struct ParseContext; } }
+}
+
 %locations
+%define api.location.type {ante::SourceRange}
 %define parse.error verbose
 
+%param {ante::parser::ParseContext &ctx}
+
 %token Ident UserType TypeVar
 
 /* types */
@@ -156,15 +163,15 @@ namespace ante {
 %start begin
 %%
 
-begin:  maybe_newline {createRoot();} top_level_expr_list
-     |  maybe_newline {createRoot();}
+begin:  maybe_newline {ctx.createRoot();} top_level_expr_list
+     |  maybe_newline {ctx.createRoot();}
      ;
 
 top_level_expr_list: top_level_expr_list top_level_expr  %prec Newline
-                   | top_level_expr_list expr_no_decl    %prec Newline    {$$ = append_main($2);}
+                   | top_level_expr_list expr_no_decl    %prec Newline    {$$ = ctx.append_main($2);}
                    | top_level_expr_list Newline         
                    | top_level_expr
-                   | expr_no_decl                        %prec Newline  {$$ = append_main($1);}
+                   | expr_no_decl                        %prec Newline  {$$ = ctx.append_main($1);}
 
                    | top_level_expr_list Elif expr Then expr_no_decl_or_jump    %prec MEDIF {auto*elif = mkIfNode(@$, $3, $5, 0); $$ = setElse($1, elif);}
                    | top_level_expr_list Else expr_no_decl_or_jump                    %prec Else  {$$ = setElse($1, $3);}
@@ -174,11 +181,11 @@ top_level_expr: modifiers top_level_expr_nm     {$$ = append_modifiers($1, $2);}
               | top_level_expr_nm
               ;
 
-top_level_expr_nm: function                                   {$$ = append_fn($1);}
-                 | data_decl                                  {$$ = append_type($1);}
-                 | extension                                  {$$ = append_extension($1);}
-                 | trait_decl                                 {$$ = append_trait($1);}
-                 | import_expr                                {$$ = append_import($1);}
+top_level_expr_nm: function                                   {$$ = ctx.append_fn($1);}
+                 | data_decl                                  {$$ = ctx.append_type($1);}
+                 | extension                                  {$$ = ctx.append_extension($1);}
+                 | trait_decl                                 {$$ = ctx.append_trait($1);}
+                 | import_expr                                {$$ = ctx.append_import($1);}
                  ;
 
 /*
@@ -193,29 +200,29 @@ maybe_newline: Newline  %prec Newline
 import_expr: Import expr {$$ = mkImportNode(@$, $2);}
 
 
-ident: Ident {$$ = (Node*)lextxt;}
-     | Self  {$$ = (Node*)strdup("self");}
+ident: Ident {$$ = $1;}
+     | Self  {$$ = (Node*)Symbol::get("self").c_str();}
      ;
 
-usertype: UserType {$$ = (Node*)lextxt;}
+usertype: UserType {$$ = $1;}
         ;
 
 usertype_node: usertype {$$ = mkTypeNode(@$, TT_Data, (char*)$1);}
              ;
 
-typevar: TypeVar {$$ = (Node*)lextxt;}
+typevar: TypeVar {$$ = $1;}
        ;
 
-intlit: IntLit {$$ = mkIntLitNode(@$, lextxt);}
+intlit: IntLit {$$ = mkIntLitNode(@$, (char*)$1);}
       ;
 
-fltlit: FltLit {$$ = mkFltLitNode(@$, lextxt);}
+fltlit: FltLit {$$ = mkFltLitNode(@$, (char*)$1);}
       ;
 
-strlit: StrLit {$$ = mkStrLitNode(@$, lextxt);}
+strlit: StrLit {$$ = mkStrLitNode(@$, (char*)$1);}
       ;
 
-charlit: CharLit {$$ = mkCharLitNode(@$, lextxt);}
+charlit: CharLit {$$ = mkCharLitNode(@$, (char*)$1);}
       ;
 
 lit_type: I8                  {$$ = mkTypeNode(@$, TT_I8,  (char*)"");}
@@ -252,12 +259,12 @@ arr_type: '[' intlit small_type ']' {$3->next.reset($2);
                                      $$ = mkTypeNode(@$, TT_Array, (char*)"", $2);}
         ;
 
-tuple_type: '(' comma_delimited_types ')'      {$$ = mkTypeNode(@$, TT_Tuple, (char*)"", getRoot());}
-          | '(' comma_delimited_types ',' ')'  {$$ = mkTypeNode(@$, TT_Tuple, (char*)"", getRoot());}
+tuple_type: '(' comma_delimited_types ')'      {$$ = mkTypeNode(@$, TT_Tuple, (char*)"", ctx.getRoot());}
+          | '(' comma_delimited_types ',' ')'  {$$ = mkTypeNode(@$, TT_Tuple, (char*)"", ctx.getRoot());}
           ;
 
 comma_delimited_types: comma_delimited_types ',' type      {$$ = setNext($1, $3);}
-                     | type                                {$$ = setRoot($1);}
+                     | type                                {$$ = ctx.setRoot($1);}
                      ;
 
 type_with_generics: type_with_generics small_type   %prec STMT  {$$ = $1; ((TypeNode*)$1)->params.emplace_back((TypeNode*)$2); $1->loc = @$;}
@@ -273,10 +280,10 @@ small_type: lit_type
           ;
 
 modifiers: modifiers modifier maybe_newline   %prec MEDLOW   {$$ = setNext($1, $2);}
-         | modifier maybe_newline             %prec LOW      {$$ = setRoot($1);}
+         | modifier maybe_newline             %prec LOW      {$$ = ctx.setRoot($1);}
          ;
 
-modified_type: modifiers type_with_generics %prec MEDLOW  {$$ = append_modifiers(getRoot(), $2);}
+modified_type: modifiers type_with_generics %prec MEDLOW  {$$ = append_modifiers(ctx.getRoot(), $2);}
              | type_with_generics           %prec LOW     {$$ = $1;}
              ;
 
@@ -301,12 +308,12 @@ modifier: Pub      {$$ = mkModNode(@$, Tok_Pub);}
 trait_decl: Trait usertype generic_params Indent trait_fn_list Unindent  {$$ = mkTraitNode(@$, (char*)$2, $3, $5);}
           ;
 
-trait_fn_list: _trait_fn_list maybe_newline {$$ = getRoot();}
+trait_fn_list: _trait_fn_list maybe_newline {$$ = ctx.getRoot();}
 
 _trait_fn_list: _trait_fn_list Newline trait_fn    {$$ = setNext($1, $3);}
               | _trait_fn_list Newline type_family {$$ = setNext($1, $3);}
-              | trait_fn                           {$$ = setRoot($1);}
-              | type_family                        {$$ = setRoot($1);}
+              | trait_fn                           {$$ = ctx.setRoot($1);}
+              | type_family                        {$$ = ctx.setRoot($1);}
               ;
 
 
@@ -318,26 +325,26 @@ type_family: Type usertype                  {$$ = mkDataDeclNode(@2, (char*)$2,
 params: params var ':' small_type          {$$ = setNext($1, mkNamedValNode(@2, $2, $4));}
       | params '(' var ':' type ')'        {$$ = setNext($1, mkNamedValNode(@3, $3, $5));}
       | params small_type                  {$$ = setNext($1, mkNamedValNode(@2, mkVarNode(@2, (char*)""), $2));}
-      | var ':' small_type                 {$$ = setRoot(mkNamedValNode(@$, $1, $3));}
-      | '(' var ':' type ')'               {$$ = setRoot(mkNamedValNode(@$, $2, $4));}
-      | small_type                         {$$ = setRoot(mkNamedValNode(@$, mkVarNode(@1, (char*)""), $1));}
+      | var ':' small_type                 {$$ = ctx.setRoot(mkNamedValNode(@$, $1, $3));}
+      | '(' var ':' type ')'               {$$ = ctx.setRoot(mkNamedValNode(@$, $2, $4));}
+      | small_type                         {$$ = ctx.setRoot(mkNamedValNode(@$, mkVarNode(@1, (char*)""), $1));}
       ;
 
 
-trait_fn_no_mods: var params RArrow type Given tc_constraints  {setNext($1, getRoot()); $$ = mkFuncDeclNode(@2, /*fn_name*/$1, /*ret_ty*/$4, /*constraints*/$6, /*body*/0);}
-                | var params RArrow type                       {setNext($1, getRoot()); $$ = mkFuncDeclNode(@2, /*fn_name*/$1, /*ret_ty*/$4, /*constraints*/0,  /*body*/0);}
+trait_fn_no_mods: var params RArrow type Given tc_constraints  {setNext($1, ctx.getRoot()); $$ = mkFuncDeclNode(@2, /*fn_name*/$1, /*ret_ty*/$4, /*constraints*/$6, /*body*/0);}
+                | var params RArrow type                       {setNext($1, ctx.getRoot()); $$ = mkFuncDeclNode(@2, /*fn_name*/$1, /*ret_ty*/$4, /*constraints*/0,  /*body*/0);}
                 ;
 
-trait_fn: modifiers trait_fn_no_mods  {$$ = append_modifiers(getRoot(), $2);}
+trait_fn: modifiers trait_fn_no_mods  {$$ = append_modifiers(ctx.getRoot(), $2);}
         | trait_fn_no_mods
         ;
 
 
 typevar_list: typevar_list typevar  %prec LOW  {$$ = setNext($1, mkTypeNode(@$, TT_TypeVar, (char*)$2)); }
-            | typevar               %prec LOW  {$$ = setRoot(mkTypeNode(@$, TT_TypeVar, (char*)$1)); }
+            | typevar               %prec LOW  {$$ = ctx.setRoot(mkTypeNode(@$, TT_TypeVar, (char*)$1)); }
             ;
 
-generic_params: typevar_list  %prec LOW {$$ = getRoot();}
+generic_params: typevar_list  %prec LOW {$$ = ctx.getRoot();}
               ;
 
 
@@ -347,21 +354,21 @@ data_decl: Type usertype generic_params '=' type_decl_block                 {$$
          | Type usertype Is type_decl_block                                 {$$ = mkDataDeclNode(@$, (char*)$2,  0, $4, true);}
          ;
 
-type_decl_list: type_decl_list Newline params                       {$$ = setNext($1, getRoot());}
-              | type_decl_list Newline explicit_tagged_union_list   {$$ = setNext($1, getRoot());}
+type_decl_list: type_decl_list Newline params                       {$$ = setNext($1, ctx.getRoot());}
+              | type_decl_list Newline explicit_tagged_union_list   {$$ = setNext($1, ctx.getRoot());}
               | params                                              {$$ = $1;} /* leave root set */
               | explicit_tagged_union_list                          {$$ = $1;} /* leave root set */
               ;
 
 /* tagged union list with mandatory '|' before first element */
-explicit_tagged_union_list: explicit_tagged_union_list '|' usertype type    %prec STMT  {$$ = setNext($1, mkNamedValNode(@$, mkVarNode(@3, (char*)$3), mkTypeNode(@4, TT_TaggedUnion, (char*)"", $4)));}
-                          | explicit_tagged_union_list '|' usertype         %prec STMT  {$$ = setNext($1, mkNamedValNode(@$, mkVarNode(@3, (char*)$3), mkTypeNode(@3, TT_TaggedUnion, (char*)"",  0)));}
-                          | '|' usertype type                               %prec STMT  {$$ = setRoot(mkNamedValNode(@$, mkVarNode(@2, (char*)$2), mkTypeNode(@3, TT_TaggedUnion, (char*)"", $3)));}
-                          | '|' usertype                                    %prec STMT  {$$ = setRoot(mkNamedValNode(@$, mkVarNode(@2, (char*)$2), mkTypeNode(@2, TT_TaggedUnion, (char*)"",  0)));}
-
-type_decl_block: Indent type_decl_list Unindent   {$$ = getRoot();}
-               | params              %prec LOW    {$$ = getRoot();}
-               | explicit_tagged_union_list    %prec STMT  {$$ = getRoot();}
+explicit_tagged_union_list: explicit_tagged_union_list '|' usertype type    %prec STMT  {$$ = setNext($1, mkNamedValNode(@$, mkVarNode(@3, Symbol::fromInterned((char*)$3)), mkTypeNode(@4, TT_TaggedUnion, (char*)"", $4)));}
+                          | explicit_tagged_union_list '|' usertype         %prec STMT  {$$ = setNext($1, mkNamedValNode(@$, mkVarNode(@3, Symbol::fromInterned((char*)$3)), mkTypeNode(@3, TT_TaggedUnion, (char*)"",  0)));}
+                          | '|' usertype type                               %prec STMT  {$$ = ctx.setRoot(mkNamedValNode(@$, mkVarNode(@2, Symbol::fromInterned((char*)$2)), mkTypeNode(@3, TT_TaggedUnion, (char*)"", $3)));}
+                          | '|' usertype                                    %prec STMT  {$$ = ctx.setRoot(mkNamedValNode(@$, mkVarNode(@2, Symbol::fromInterned((char*)$2)), mkTypeNode(@2, TT_TaggedUnion, (char*)"",  0)));}
+
+type_decl_block: Indent type_decl_list Unindent   {$$ = ctx.getRoot();}
+               | params              %prec LOW    {$$ = ctx.getRoot();}
+               | explicit_tagged_union_list    %prec STMT  {$$ = ctx.getRoot();}
                ;
 
 block: Indent expr Unindent                   {$$ = mkBlockNode(@$, $2);}
@@ -420,34 +427,34 @@ tc_constraints: type  %prec LOW
 
 function_call: function_call val_no_decl    %prec LOW   {$$ = setNext($1, $2);}
              | function_call varargs        %prec LOW   {$$ = setNext($1, $2);}
-             | val_no_decl val_no_decl      %prec LOW   {setRoot($1); $$ = setNext($1, $2);}
-             | val_no_decl varargs          %prec LOW   {setRoot($1); $$ = setNext($1, $2);}
+             | val_no_decl val_no_decl      %prec LOW   {ctx.setRoot($1); $$ = setNext($1, $2);}
+             | val_no_decl varargs          %prec LOW   {ctx.setRoot($1); $$ = setNext($1, $2);}
              ;
 
 lambda_params: lambda_params var ':' small_type     {$$ = setNext($1, mkNamedValNode(@2, $2, $4));}
              | lambda_params '(' var ':' type ')'   {$$ = setNext($1, mkNamedValNode(@3, $3, $5));}
              | lambda_params small_type             {$$ = setNext($1, mkNamedValNode(@2, mkVarNode(@2, (char*)""), $2));}
              | lambda_params var                    {$$ = setNext($1, $2);}
-             | var ':' small_type                   {$$ = setRoot(mkNamedValNode(@$, $1, $3));}
-             | '(' var ':' type ')'                 {$$ = setRoot(mkNamedValNode(@$, $2, $4));}
-             | small_type                           {$$ = setRoot(mkNamedValNode(@$, mkVarNode(@1, (char*)""), $1));}
-             | var                                  {$$ = setRoot($1);}
+             | var ':' small_type                   {$$ = ctx.setRoot(mkNamedValNode(@$, $1, $3));}
+             | '(' var ':' type ')'                 {$$ = ctx.setRoot(mkNamedValNode(@$, $2, $4));}
+             | small_type                           {$$ = ctx.setRoot(mkNamedValNode(@$, mkVarNode(@1, (char*)""), $1));}
+             | var                                  {$$ = ctx.setRoot($1);}
              ;
 
-/* NOTE: lextxt contents from fn_name and the mangleFn result are freed in the call to mkFuncDeclNode */
-fn_def: function_call RArrow type Given tc_constraints '=' expr_or_block  {$$ = mkFuncDeclNode(@1, /*name and params*/getRoot(), /*ret_ty*/$3, /*constraints*/$5, /*body*/$7);}
-      | function_call RArrow type '=' expr_or_block                       {$$ = mkFuncDeclNode(@1, /*name and params*/getRoot(), /*ret_ty*/$3, /*constraints*/0, /*body*/$5);}
+/* NOTE: token text from fn_name and the mangleFn result are freed in the call to mkFuncDeclNode */
+fn_def: function_call RArrow type Given tc_constraints '=' expr_or_block  {$$ = mkFuncDeclNode(@1, /*name and params*/ctx.getRoot(), /*ret_ty*/$3, /*constraints*/$5, /*body*/$7);}
+      | function_call RArrow type '=' expr_or_block                       {$$ = mkFuncDeclNode(@1, /*name and params*/ctx.getRoot(), /*ret_ty*/$3, /*constraints*/0, /*body*/$5);}
       ;
 
-fn_inferredRet: function_call Given tc_constraints '=' expr_or_block  %prec Newline  {$$ = mkFuncDeclNode(@1, /*name and params*/getRoot(), /*ret_ty*/0, /*constraints*/$3, /*body*/$5);}
-              | function_call '=' expr_or_block                       %prec Newline  {$$ = mkFuncDeclNode(@1, /*name and params*/getRoot(), /*ret_ty*/0, /*constraints*/0,  /*body*/$3);}
+fn_inferredRet: function_call Given tc_constraints '=' expr_or_block  %prec Newline  {$$ = mkFuncDeclNode(@1, /*name and params*/ctx.getRoot(), /*ret_ty*/0, /*constraints*/$3, /*body*/$5);}
+              | function_call '=' expr_or_block                       %prec Newline  {$$ = mkFuncDeclNode(@1, /*name and params*/ctx.getRoot(), /*ret_ty*/0, /*constraints*/0,  /*body*/$3);}
               ;
 
-fn_decl: function_call RArrow type Given tc_constraints  %prec Fun  {$$ = mkFuncDeclNode(@1, /*name and params*/getRoot(), /*ret_ty*/$3, /*constraints*/$5, /*body*/0);}
-       | function_call RArrow type                       %prec Fun  {$$ = mkFuncDeclNode(@1, /*name and params*/getRoot(), /*ret_ty*/$3, /*constraints*/0,  /*body*/0);}
+fn_decl: function_call RArrow type Given tc_constraints  %prec Fun  {$$ = mkFuncDeclNode(@1, /*name and params*/ctx.getRoot(), /*ret_ty*/$3, /*constraints*/$5, /*body*/0);}
+       | function_call RArrow type                       %prec Fun  {$$ = mkFuncDeclNode(@1, /*name and params*/ctx.getRoot(), /*ret_ty*/$3, /*constraints*/0,  /*body*/0);}
        ;
 
-fn_lambda: '\\' lambda_params '=' expr_or_block  %prec Fun  {auto name = new VarNode(@1, ""); setNext(name, getRoot()); $$ = mkFuncDeclNode(@$, /*name and params*/name, /*ret_ty*/0,  /*constraints*/0, /*body*/$4);}
+fn_lambda: '\\' lambda_params '=' expr_or_block  %prec Fun  {auto name = new VarNode(@1, ""); setNext(name, ctx.getRoot()); $$ = mkFuncDeclNode(@$, /*name and params*/name, /*ret_ty*/0,  /*constraints*/0, /*body*/$4);}
          | '\\' '=' expr_or_block                %prec Fun  {auto name = new VarNode(@1, "");                           $$ = mkFuncDeclNode(@$, /*name and params*/name, /*ret_ty*/0,  /*constraints*/0, /*body*/$3);}
          ;
 
@@ -460,19 +467,19 @@ extension: Module type Indent ext_list Unindent                     {$$ = mkExtN
          | Impl   type Given tc_constraints Indent ext_list Unindent  {$$ = mkExtNode(@$,  0, $6, $2);}
          ;
 
-ext_list: fn_list_ {$$ = getRoot();}
+ext_list: fn_list_ {$$ = ctx.getRoot();}
 
 fn_list_: fn_list_ ext_fn maybe_newline  {$$ = setNext($1, $2);}
         | fn_list_ ext_dd maybe_newline  {$$ = setNext($1, $2);}
-        | ext_fn maybe_newline           {$$ = setRoot($1);}
-        | ext_dd maybe_newline           {$$ = setRoot($1);}
+        | ext_fn maybe_newline           {$$ = ctx.setRoot($1);}
+        | ext_dd maybe_newline           {$$ = ctx.setRoot($1);}
         ;
 
-ext_fn: modifiers function  {$$ = append_modifiers(getRoot(), $2);}
+ext_fn: modifiers function  {$$ = append_modifiers(ctx.getRoot(), $2);}
       | function
       ;
 
-ext_dd: modifiers data_decl  {$$ = append_modifiers(getRoot(), $2);}
+ext_dd: modifiers data_decl  {$$ = append_modifiers(ctx.getRoot(), $2);}
       | data_decl
       ;
 
@@ -507,8 +514,8 @@ if_expr: If expr_or_block maybe_newline Then expr_or_jump                %prec M
        | if_expr Else expr_or_jump                             {$$ = setElse($1, $3);}
        ;
 
-var: ident  %prec Ident {$$ = mkVarNode(@$, (char*)$1);}
-   | '(' op ')'         {$$ = mkVarNode(@$, strdup((char*)$2));}
+var: ident  %prec Ident {$$ = mkVarNode(@$, Symbol::fromInterned((char*)$1));}
+   | '(' op ')'         {$$ = mkVarNode(@$, (char*)$2);}
    ;
 
 
@@ -564,12 +571,12 @@ unary_op: '@' expr                              {$$ = mkUnOpNode(@$, '@', $2);}
         ;
 
 /* expr is used in expression blocks and can span multiple lines */
-expr_list: expr_list_p {$$ = getRoot();}
+expr_list: expr_list_p {$$ = ctx.getRoot();}
          ;
 
 
 expr_list_p: expr_list_p ',' maybe_newline expr  %prec ',' {$$ = setNext($1, $4);}
-           | expr                                %prec LOW {$$ = setRoot($1);}
+           | expr                                %prec LOW {$$ = ctx.setRoot($1);}
            ;
 
 expr_no_decl_or_jump: expr_no_decl  %prec MEDIF
@@ -609,7 +616,7 @@ expr_no_decl: expr_no_decl '+' maybe_newline expr_no_decl                      {
             | val_no_decl                                           %prec MED  {$$ = $1;}
             | unary_op                                                         {$$ = $1;}
 
-            | function_call                                         %prec LOW  {$$ = mkFuncCallNode(@$, getRoot());}
+            | function_call                                         %prec LOW  {$$ = mkFuncCallNode(@$, ctx.getRoot());}
             | var '=' maybe_newline expr_or_block                              {$$ = mkVarAssignNode(@$, $1, $4); append_modifiers(mkModNode(@1, Tok_Let), $$);}
             | var '=' Mut maybe_newline expr_or_block                          {$$ = mkVarAssignNode(@$, $1, $5); append_modifiers(mkModNode(@1, Tok_Mut), $$);}
             | var '=' Global maybe_newline expr_or_block                       {$$ = mkVarAssignNode(@$, $1, $5); append_modifiers(mkModNode(@1, Tok_Global), $$);}
@@ -678,7 +685,7 @@ expr: expr '+' maybe_newline expr                               {$$ = mkBinOpNod
     | val                                            %prec MED  {$$ = $1;}
     | unary_op                                                  {$$ = $1;}
 
-    | function_call                                  %prec LOW  {$$ = mkFuncCallNode(@$, getRoot());}
+    | function_call                                  %prec LOW  {$$ = mkFuncCallNode(@$, ctx.getRoot());}
     | var '=' maybe_newline expr_or_block                       {$$ = mkVarAssignNode(@$, $1, $4); append_modifiers(mkModNode(@1, Tok_Let), $$);}
     | var '=' Mut maybe_newline expr_or_block                   {$$ = mkVarAssignNode(@$, $1, $5); append_modifiers(mkModNode(@1, Tok_Mut), $$);}
     | var '=' Global maybe_newline expr_or_block                {$$ = mkVarAssignNode(@$, $1, $5); append_modifiers(mkModNode(@1, Tok_Global), $$);}
@@ -712,13 +719,12 @@ expr: expr '+' maybe_newline expr                               {$$ = mkBinOpNod
 %%
 
 /* location parser error */
-void yy::parser::error(const location& loc, const string& msg){
-    if(++ante_parser_errcount > 5){
+void yy::parser::error(const location_type& loc, const string& msg){
+    if(++ctx.errCount > 5){
         std::cerr << "Too many errors, exiting.\n";
         exit(2);
     }
-    location l = loc;
-    ante::showError(msg.c_str(), l);
+    ante::showError(msg.c_str(), loc);
 }
 
 namespace ante {
@@ -0,0 +1,106 @@
+#include "threadpool.h"
+
+using namespace std;
+
+namespace ante {
+
+    /** The pool and worker index of the current thread if it is a worker */
+    static thread_local ThreadPool *currentPool = nullptr;
+    static thread_local size_t currentWorker = 0;
+
+    ThreadPool::ThreadPool(size_t threadCount){
+        if(threadCount == 0)
+            threadCount = 1;
+
+        workers.reserve(threadCount);
+        for(size_t i = 0; i < threadCount; i++)
+            workers.emplace_back(new Worker());
+
+        threads.reserve(threadCount);
+        for(size_t i = 0; i < threadCount; i++)
+            threads.emplace_back([this, i]{ run(i); });
+    }
+
+
+    ThreadPool::~ThreadPool(){
+        wait();
+        {
+            lock_guard<mutex> lock{stateMutex};
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for(auto &thread : threads)
+            thread.join();
+    }
+
+
+    void ThreadPool::async(Task task){
+        size_t worker;
+        {
+            lock_guard<mutex> lock{stateMutex};
+            worker = currentPool == this ? currentWorker : nextWorker++ % workers.size();
+            queuedTasks++;
+            unfinishedTasks++;
+        }
+        {
+            lock_guard<mutex> lock{workers[worker]->mutex};
+            workers[worker]->tasks.push_back(move(task));
+        }
+        workAvailable.notify_one();
+    }
+
+
+    void ThreadPool::wait(){
+        unique_lock<mutex> lock{stateMutex};
+        allDone.wait(lock, [this]{ return unfinishedTasks == 0; });
+    }
+
+
+    bool ThreadPool::takeTask(size_t worker, Task &task){
+        for(size_t i = 0; i < workers.size(); i++){
+            Worker &victim = *workers[(worker + i) % workers.size()];
+            lock_guard<mutex> lock{victim.mutex};
+            if(victim.tasks.empty())
+                continue;
+
+            if(i == 0){
+                task = move(victim.tasks.back());
+                victim.tasks.pop_back();
+            }else{
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    }
+
+
+    void ThreadPool::run(size_t worker){
+        currentPool = this;
+        currentWorker = worker;
+
+        while(true){
+            Task task;
+            if(takeTask(worker, task)){
+                {
+                    lock_guard<mutex> lock{stateMutex};
+                    queuedTasks--;
+                }
+                task();
+
+                lock_guard<mutex> lock{stateMutex};
+                if(--unfinishedTasks == 0)
+                    allDone.notify_all();
+                continue;
+            }
+
+            // queuedTasks is incremented before a task is pushed so a
+            // worker may briefly wake before there is anything to take
+            unique_lock<mutex> lock{stateMutex};
+            workAvailable.wait(lock, [this]{ return stopping || queuedTasks > 0; });
+            if(stopping && queuedTasks == 0)
+                return;
+        }
+    }
+}
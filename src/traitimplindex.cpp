@@ -0,0 +1,126 @@
+#include "traitimplindex.h"
+#include "antype.h"
+#include "trait.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace std;
+
+namespace ante {
+
+    TraitImplIndex::TraitImplIndex() : root{new Node()}{}
+    TraitImplIndex::TraitImplIndex(TraitImplIndex&&) = default;
+    TraitImplIndex& TraitImplIndex::operator=(TraitImplIndex&&) = default;
+    TraitImplIndex::~TraitImplIndex() = default;
+
+
+    bool TraitImplIndex::Key::operator<(Key const& other) const {
+        return tie(tag, arity, name) < tie(other.tag, other.arity, other.name);
+    }
+
+
+    void TraitImplIndex::flatten(TypeArgs const& typeArgs, vector<Token> &tokens){
+        //The argument list itself is the first token so lists of different lengths never match
+        size_t start = tokens.size();
+        tokens.push_back({{TT_Tuple, typeArgs.size(), ""}, false, 0});
+        for(auto *arg : typeArgs)
+            flatten(arg, tokens);
+        tokens[start].end = tokens.size();
+    }
+
+
+    void TraitImplIndex::flatten(const AnType *type, vector<Token> &tokens){
+        size_t start = tokens.size();
+
+        //Modifiers share the TypeTag of the type they modify and are otherwise ignored by approxEq
+        if(type->typeTag == TT_TypeVar){
+            tokens.push_back({{TT_TypeVar, 0, ""}, true, start + 1});
+            return;
+        }
+        while(type->isModifierType())
+            type = static_cast<const AnModifier*>(type)->extTy;
+
+        tokens.push_back({{type->typeTag, 0, ""}, false, 0});
+
+        if(auto *tup = try_cast<AnTupleType>(type)){
+            tokens[start].key.arity = tup->fields.size();
+            for(auto *field : tup->fields)
+                flatten(field, tokens);
+
+        }else if(auto *dt = try_cast<AnDataType>(type)){
+            tokens[start].key.arity = dt->typeArgs.size();
+            tokens[start].key.name = dt->name;
+            for(auto *arg : dt->typeArgs)
+                flatten(arg, tokens);
+
+        }else if(auto *arr = try_cast<AnArrayType>(type)){
+            tokens[start].key.arity = 1;
+            flatten(arr->extTy, tokens);
+
+        }else if(auto *ptr = try_cast<AnPtrType>(type)){
+            tokens[start].key.arity = 1;
+            flatten(ptr->extTy, tokens);
+
+        }else if(auto *fn = try_cast<AnFunctionType>(type)){
+            tokens[start].key.arity = fn->paramTys.size() + 1;
+            flatten(fn->retTy, tokens);
+            for(auto *param : fn->paramTys)
+                flatten(param, tokens);
+        }
+        tokens[start].end = tokens.size();
+    }
+
+
+    void TraitImplIndex::add(TraitImpl *impl){
+        vector<Token> tokens;
+        flatten(impl->typeArgs, tokens);
+
+        Node *node = root.get();
+        for(size_t i = 0; i < tokens.size(); i++){
+            auto &next = tokens[i].isTypeVar ? node->anyType : node->children[tokens[i].key];
+            if(!next)
+                next.reset(new Node());
+            node = next.get();
+        }
+
+        node->implsHere.push_back(impls.size());
+        impls.push_back(impl);
+    }
+
+
+    void TraitImplIndex::collect(const Node *node, vector<Token> const& tokens, size_t i,
+            vector<size_t> &matches){
+
+        if(i == tokens.size()){
+            matches.insert(matches.end(), node->implsHere.begin(), node->implsHere.end());
+            return;
+        }
+
+        if(node->anyType)
+            collect(node->anyType.get(), tokens, tokens[i].end, matches);
+
+        auto it = node->children.find(tokens[i].key);
+        if(it != node->children.end())
+            collect(it->second.get(), tokens, i + 1, matches);
+    }
+
+
+    TraitImpl* TraitImplIndex::find(TypeArgs const& typeArgs) const {
+        if(impls.empty())
+            return nullptr;
+
+        vector<Token> tokens;
+        flatten(typeArgs, tokens);
+
+        vector<size_t> matches;
+        collect(root.get(), tokens, 0, matches);
+
+        //The path only approximates approxEq, eg. it ignores tuple field names, so check each match
+        sort(matches.begin(), matches.end());
+        for(size_t i : matches){
+            if(allApproxEq(impls[i]->typeArgs, typeArgs))
+                return impls[i];
+        }
+        return nullptr;
+    }
+}
@@ -184,7 +184,7 @@ namespace ante {
             }
             return s;
         }else if(auto *tvt = try_cast<AnTypeVarType>(t)){
-            return s + lazy_str(tvt->name, color);
+            return s + lazy_str(tvt->getName(), color);
         }else if(auto *f = try_cast<AnFunctionType>(t)){
             size_t i = 0;
             for(auto &param : f->paramTys){
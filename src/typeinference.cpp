@@ -7,12 +7,19 @@
 #include "types.h"
 #include "trait.h"
 #include "util.h"
+#include "scopeguard.h"
+#include "threadpool.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <atomic>
 
 using namespace std;
 
 namespace ante {
     using namespace parser;
 
+    extern AnTypeContainer typeArena;
+
     /** Annotate all nodes with placeholder types */
     void TypeInferenceVisitor::visit(RootNode *n){
         for(auto &m : n->imports)
@@ -21,6 +28,9 @@ namespace ante {
             m->accept(*this);
         for(auto &m : n->traits)
             m->accept(*this);
+
+        inferFunctions(n);
+
         for(auto &m : n->extensions)
             m->accept(*this);
         for(auto &m : n->funcs)
@@ -169,7 +179,7 @@ namespace ante {
 
         // TODO: is this still necessary?
         if(n->op == '.'){
-            if(dynamic_cast<TypeNode*>(n->lval.get())){
+            if(isa<TypeNode>(n->lval.get())){
                 n->rval->accept(*this);
                 n->setType(n->rval->getType());
                 return;
@@ -222,6 +232,9 @@ namespace ante {
             auto tv = nextTypeVar();
             decl->tval.type = nextTypeVar();
             n->setType(tv);
+        }else if(component && component->count(decl)){
+            // functions in the same component are not yet generalized
+            n->setType(decl->tval.type);
         }else if(auto *fnty = try_cast<AnFunctionType>(decl->tval.type)){
             n->setType(copyWithNewTypeVars(fnty));
         }else{
@@ -238,13 +251,15 @@ namespace ante {
         n->setType(AnType::getUnit());
     }
 
-    vector<TraitImpl*> getAllTcConstraints(AnFunctionType *fn, UnificationList const& constraints,
-            Substitutions const& substitutions){
+    /** Collect the typeclass constraints among the next constraintCount
+     *  constraints, advancing the iterator past them. */
+    vector<TraitImpl*> getAllTcConstraints(AnFunctionType *fn, UnificationList::const_iterator &constraint,
+            size_t constraintCount, Substitutions const& substitutions){
 
         auto tcConstraints = fn->typeClassConstraints;
-        for(auto &c : constraints){
-            if(!c.isEqConstraint()){
-                auto resolved = applySubstitutions(substitutions, c.asTypeClassConstraint());
+        for(size_t i = 0; i < constraintCount; i++, ++constraint){
+            if(!constraint->isEqConstraint()){
+                auto resolved = applySubstitutions(substitutions, constraint->asTypeClassConstraint());
                 tcConstraints.push_back(resolved);
             }
         }
@@ -268,12 +283,17 @@ namespace ante {
     }
 
 
-    void fillInFunctionParamsAndBodyTypes(TypeInferenceVisitor &v, FuncDeclNode *n){
+    void fillInFunctionSignature(TypeInferenceVisitor &v, FuncDeclNode *n){
         auto paramTypes = setParamTypes(v, n->params.get());
 
         auto typeClassConstraints = toTraitTypeVec(n->typeClassConstraints, v.module);
         AnType *retTy = n->returnType ? toAnType(n->returnType.get(), v.module) : nextTypeVar();
         n->setType(AnFunctionType::get(retTy, paramTypes, typeClassConstraints));
+    }
+
+
+    void fillInFunctionParamsAndBodyTypes(TypeInferenceVisitor &v, FuncDeclNode *n){
+        fillInFunctionSignature(v, n);
 
         if(n->child){
             n->child->accept(v);
@@ -284,7 +304,7 @@ namespace ante {
     void TypeInferenceVisitor::visit(ExtNode *n){
         if(n->trait){
             for(Node &m : *n->methods){
-                FuncDeclNode *fdn = dynamic_cast<FuncDeclNode*>(&m);
+                FuncDeclNode *fdn = dyn_cast<FuncDeclNode>(&m);
                 if(fdn) fillInFunctionParamsAndBodyTypes(*this, fdn);
             }
             n->setType(AnType::getUnit());
@@ -293,7 +313,7 @@ namespace ante {
             auto constraints = step2.getConstraints();
             auto substitutions = unify(constraints);
             if(!substitutions.empty()){
-                SubstitutingVisitor::substituteIntoAst(n, substitutions, module);
+                SubstitutingVisitor::substituteIntoAst(n, substitutions);
             }
         }else{
             for(Node &m : *n->methods){
@@ -335,15 +355,15 @@ namespace ante {
     }
 
     void checkTraitImpls(Module *m, AnFunctionType *f, LOC_TY loc){
-        llvm::StringMap<const AnTypeVarType*> map;
-        getAllContainedTypeVarsHelper(f->retTy, map);
+        TypeVarSet set;
+        getAllContainedTypeVarsHelper(f->retTy, set);
         for(auto *paramTy : f->paramTys){
-            getAllContainedTypeVarsHelper(paramTy, map);
+            getAllContainedTypeVarsHelper(paramTy, set);
         }
 
         for(TraitImpl *trait : f->typeClassConstraints){
             for(auto *ty : trait->typeArgs){
-                if(hasTypeVarNotInMap(ty, map)){
+                if(hasTypeVarNotInSet(ty, set)){
                     std::cerr << "in fntype " << anTypeToColoredStr(f) << " trait "
                         << traitToColoredStr(trait) << " has " << anTypeToColoredStr(ty) << " not in function signature\n";
                 }
@@ -352,34 +372,232 @@ namespace ante {
     }
 
 
-    void TypeInferenceVisitor::visit(FuncDeclNode *n){
-        if(n->getType())
-            return;
+    Node* unwrapModifiers(Node *n){
+        while(auto *mn = dyn_cast_or_null<ModNode>(n))
+            n = mn->expr.get();
+        return n;
+    }
+
+
+    /**
+     * Split the given functions into the strongly connected components of
+     * their call graph using an iterative version of Tarjan's algorithm.
+     * Components are returned in dependency order: functions in each component
+     * only call functions within the same component or an earlier one.
+     */
+    vector<vector<FuncDeclNode*>> findCallGraphComponents(vector<FuncDeclNode*> const& fns){
+        llvm::DenseMap<Declaration*, size_t> indexOf;
+        for(size_t i = 0; i < fns.size(); i++)
+            indexOf[fns[i]->decl] = i;
+
+        const size_t unvisited = SIZE_MAX;
+        vector<size_t> order(fns.size(), unvisited);
+        vector<size_t> lowlink(fns.size());
+        vector<bool> onStack(fns.size());
+        vector<size_t> stack;
+        size_t nextOrder = 0;
+
+        // Each frame holds a function and the index of the next of its callees to visit
+        vector<pair<size_t, size_t>> frames;
+        vector<vector<FuncDeclNode*>> components;
+
+        auto enter = [&](size_t fn){
+            order[fn] = lowlink[fn] = nextOrder++;
+            stack.push_back(fn);
+            onStack[fn] = true;
+            frames.emplace_back(fn, 0);
+        };
+
+        for(size_t root = 0; root < fns.size(); root++){
+            if(order[root] != unvisited)
+                continue;
+
+            enter(root);
+            while(!frames.empty()){
+                size_t fn = frames.back().first;
+                auto &callees = static_cast<FuncDecl*>(fns[fn]->decl)->callees;
+
+                if(frames.back().second < callees.size()){
+                    auto it = indexOf.find(callees[frames.back().second++]);
+                    if(it == indexOf.end())
+                        continue;
+
+                    size_t callee = it->second;
+                    if(order[callee] == unvisited)
+                        enter(callee);
+                    else if(onStack[callee])
+                        lowlink[fn] = min(lowlink[fn], order[callee]);
+                    continue;
+                }
+
+                frames.pop_back();
+                if(!frames.empty()){
+                    size_t caller = frames.back().first;
+                    lowlink[caller] = min(lowlink[caller], lowlink[fn]);
+                }
+
+                if(lowlink[fn] == order[fn]){
+                    components.emplace_back();
+                    size_t member;
+                    do{
+                        member = stack.back();
+                        stack.pop_back();
+                        onStack[member] = false;
+                        components.back().push_back(fns[member]);
+                    }while(member != fn);
+                    reverse(components.back().begin(), components.back().end());
+                }
+            }
+        }
+        return components;
+    }
+
+
+    void TypeInferenceVisitor::inferFunctions(RootNode *n){
+        vector<FuncDeclNode*> fns;
+        auto addFunction = [&](Node *m){
+            auto *fdn = dyn_cast_or_null<FuncDeclNode>(unwrapModifiers(m));
+            if(fdn && fdn->decl && !fdn->getType())
+                fns.push_back(fdn);
+        };
+
+        // Trait impls are checked against their trait's declaration separately
+        for(auto &m : n->extensions){
+            auto *ext = dyn_cast_or_null<ExtNode>(unwrapModifiers(m.get()));
+            if(ext && !ext->trait)
+                for(Node &method : *ext->methods)
+                    addFunction(&method);
+        }
+        for(auto &m : n->funcs)
+            addFunction(m.get());
+
+        auto components = findCallGraphComponents(fns);
+        // The nursery, e.g. of a REPL line, is not safe to allocate in from several threads
+        if(compilerJobs() > 1 && components.size() > 1 && !typeArena.isNurseryOpen()){
+            inferInParallel(components);
+        }else{
+            for(auto &functions : components)
+                inferComponent(functions);
+        }
+    }
+
+
+    void TypeInferenceVisitor::inferInParallel(vector<vector<FuncDeclNode*>> const& components){
+        size_t count = components.size();
+        llvm::DenseMap<Declaration*, size_t> componentOf;
+        for(size_t i = 0; i < count; i++)
+            for(auto *fdn : components[i])
+                componentOf[fdn->decl] = i;
+
+        // Each component waits on the distinct components it calls before it may start
+        vector<vector<size_t>> dependents(count);
+        unique_ptr<atomic<size_t>[]> remainingCallees{new atomic<size_t>[count]};
+        for(size_t i = 0; i < count; i++){
+            vector<size_t> callees;
+            for(auto *fdn : components[i]){
+                for(auto *callee : static_cast<FuncDecl*>(fdn->decl)->callees){
+                    auto it = componentOf.find(callee);
+                    if(it != componentOf.end() && it->second != i)
+                        callees.push_back(it->second);
+                }
+            }
+            sort(callees.begin(), callees.end());
+            callees.erase(unique(callees.begin(), callees.end()), callees.end());
+
+            remainingCallees[i] = callees.size();
+            for(size_t callee : callees)
+                dependents[callee].push_back(i);
+        }
+
+        vector<DiagnosticBuffer> diagnostics(count);
+        typeArena.beginConcurrent();
+        {
+            ThreadPool pool{compilerJobs()};
+            function<void(size_t)> infer = [&](size_t i){
+                setDiagnosticBuffer(&diagnostics[i]);
+                tryTo([&]{
+                    TypeInferenceVisitor visitor{module};
+                    visitor.inferComponent(components[i]);
+                });
+                typeArena.flushTypeVars();
+                setDiagnosticBuffer(nullptr);
+
+                for(size_t dependent : dependents[i])
+                    if(--remainingCallees[dependent] == 0)
+                        pool.async([&, dependent]{ infer(dependent); });
+            };
+
+            for(size_t i = 0; i < count; i++)
+                if(remainingCallees[i] == 0)
+                    pool.async([&, i]{ infer(i); });
+
+            pool.wait();
+        }
+        typeArena.endConcurrent();
+
+        for(auto &buffer : diagnostics)
+            flushDiagnosticBuffer(buffer);
+    }
 
-        fillInFunctionParamsAndBodyTypes(*this, n);
+
+    void TypeInferenceVisitor::inferComponent(vector<FuncDeclNode*> const& functions){
+        llvm::DenseSet<Declaration*> members;
+        for(auto *fdn : functions)
+            members.insert(fdn->decl);
+        TMP_SET(component, &members);
+
+        // Every signature must be filled in before any body refers to it
+        for(auto *fdn : functions)
+            fillInFunctionSignature(*this, fdn);
+
+        for(auto *fdn : functions)
+            if(fdn->child)
+                fdn->child->accept(*this);
 
         // finish inference for functions early
-        ConstraintFindingVisitor step2{this->module};
         tryTo([&]{
-            n->accept(step2);
-            auto constraints = step2.getConstraints();
+            UnificationList constraints;
+            vector<size_t> constraintCounts;
+            constraintCounts.reserve(functions.size());
+
+            for(auto *fdn : functions){
+                ConstraintFindingVisitor step2{this->module};
+                fdn->accept(step2);
+                auto fnConstraints = step2.getConstraints();
+                constraintCounts.push_back(fnConstraints.size());
+                constraints.splice(constraints.end(), fnConstraints);
+            }
+
             auto substitutions = unify(constraints);
             if(!substitutions.empty()){
-                // apply typeclass constraints to function before substitution.
+                // apply typeclass constraints to each function before substitution.
                 // it may save some time for non-generic functions to apply them afterward separately.
-                auto fnTy = try_cast<AnFunctionType>(n->getType());
-                auto tcConstraints = getAllTcConstraints(fnTy, constraints, substitutions);
-                auto newFnTy = AnFunctionType::get(fnTy->retTy, fnTy->paramTys, tcConstraints,
-                        fnTy->typeTag == TT_MetaFunction);
-
-                newFnTy = cleanTypeClassConstraints(newFnTy);
-                n->setType(newFnTy);
+                auto constraint = constraints.cbegin();
+                for(size_t i = 0; i < functions.size(); i++){
+                    auto fnTy = try_cast<AnFunctionType>(functions[i]->getType());
+                    auto tcConstraints = getAllTcConstraints(fnTy, constraint, constraintCounts[i], substitutions);
+                    auto newFnTy = AnFunctionType::get(fnTy->retTy, fnTy->paramTys, tcConstraints,
+                            fnTy->typeTag == TT_MetaFunction);
+
+                    newFnTy = cleanTypeClassConstraints(newFnTy);
+                    functions[i]->setType(newFnTy);
+                }
 
-                SubstitutingVisitor::substituteIntoAst(n, substitutions, this->module);
+                SubstitutingVisitor substitutingVisitor{substitutions};
+                for(auto *fdn : functions)
+                    fdn->accept(substitutingVisitor);
             }
         });
     }
 
+
+    void TypeInferenceVisitor::visit(FuncDeclNode *n){
+        if(n->getType())
+            return;
+
+        inferComponent({n});
+    }
+
     void TypeInferenceVisitor::visit(DataDeclNode *n){
         n->setType(AnType::getUnit());
     }
@@ -390,7 +608,7 @@ namespace ante {
         for(Node &node : *n->child){
             node.accept(*this);
 
-            auto fdn = dynamic_cast<FuncDeclNode*>(&node);
+            auto fdn = dyn_cast<FuncDeclNode>(&node);
             if (fdn) {
                 auto fdty = try_cast<AnFunctionType>(fdn->getType());
                 auto traits = fdty->typeClassConstraints; // copy the vec so the old one isn't pushed to
@@ -619,7 +619,7 @@ string anTypeToStr(const AnType *t){
         }
         return n;
     }else if(auto *tvt = try_cast<AnTypeVarType>(t)){
-        return tvt->name;
+        return tvt->getName();
     }else if(auto *f = try_cast<AnFunctionType>(t)){
         string ret = "";
         for(auto &param : f->paramTys){
@@ -3,16 +3,16 @@
 #include "trait.h"
 #include "util.h"
 
-namespace ante {
-    size_t curTypeVar = 0;
+#include <llvm/ADT/SmallPtrSet.h>
 
-    AnTypeVarType* nextTypeVar(){
-        return AnTypeVarType::get('\'' + std::to_string(++curTypeVar));
+namespace ante {
+    AnTypeVarType* nextTypeVar(bool isRhoVar){
+        return AnTypeVarType::getFresh(isRhoVar);
     }
 
     template<typename T>
     std::vector<T*> copyWithNewTypeVars(std::vector<T*> tys,
-            std::unordered_map<std::string, AnTypeVarType*> &map){
+            TypeVarMap &map){
 
         return ante::applyToAll(tys, [&](T* type){
             return (T*)copyWithNewTypeVars(type, map);
@@ -20,20 +20,12 @@ namespace ante {
     }
 
     TraitImpl* copyWithNewTypeVars(TraitImpl* impl,
-            std::unordered_map<std::string, AnTypeVarType*> &map){
+            TypeVarMap &map){
 
         return new TraitImpl(impl->name, copyWithNewTypeVars(impl->typeArgs, map));
     }
 
-    void setExtsParentUnionTypeIfNotSet(AnSumType *parentUnion, std::vector<AnProductType*> &exts){
-        for(auto e : exts){
-            if(!e->parentUnionType){
-                e->parentUnionType = parentUnion;
-            }
-        }
-    }
-
-    AnType* copyWithNewTypeVars(AnType *t, std::unordered_map<std::string, AnTypeVarType*> &map){
+    AnType* copyWithNewTypeVars(AnType *t, TypeVarMap &map){
         if(!t->isGeneric)
             return t;
 
@@ -62,21 +54,16 @@ namespace ante {
             if(exts == st->tags && typeVars == st->typeArgs){
                 return st;
             }else{
-                auto ret = AnSumType::createVariant(st, exts, typeVars);
-                setExtsParentUnionTypeIfNotSet(ret, exts);
-                return ret;
+                return AnSumType::createVariant(st, exts, typeVars);
             }
 
         }else if(auto tv = try_cast<AnTypeVarType>(t)){
-            auto it = map.find(tv->name);
+            auto it = map.find(tv);
             if(it != map.end()){
                 return it->second;
             }else{
-                auto newtv = nextTypeVar();
-                if(tv->isRhoVar())
-                    newtv = AnTypeVarType::get(newtv->name + "...");
-
-                map[tv->name] = newtv;
+                auto newtv = nextTypeVar(tv->isRhoVar());
+                map[tv] = newtv;
                 return newtv;
             }
 
@@ -96,17 +83,105 @@ namespace ante {
     }
 
 
+    /**
+     * Instantiates a type scheme.  Every typevar within the scheme is quantified
+     * and is identified by its index within the scheme's typevar summary.  Since
+     * that summary is sorted by id each typevar can be replaced by binary search
+     * into a small vector of fresh typevars rather than by a hash map built while
+     * traversing the type.
+     */
+    class Instantiation {
+        llvm::ArrayRef<AnTypeVarType*> quantified;
+        llvm::SmallVector<AnTypeVarType*, 4> fresh;
+
+        AnTypeVarType* lookup(AnTypeVarType *tv) const {
+            auto it = std::lower_bound(quantified.begin(), quantified.end(), tv,
+                    [](const AnTypeVarType *l, const AnTypeVarType *r){ return l->id < r->id; });
+
+            if(it != quantified.end() && *it == tv)
+                return fresh[it - quantified.begin()];
+            return tv;
+        }
+
+        template<typename T>
+        std::vector<T*> copyAll(std::vector<T*> const& tys){
+            return ante::applyToAll(tys, [&](T *type){ return (T*)copy(type); });
+        }
+
+        TraitImpl* copy(TraitImpl *impl){
+            return new TraitImpl(impl->name, copyAll(impl->typeArgs));
+        }
+
+    public:
+        Instantiation(AnType *scheme) : quantified{scheme->getContainedTypeVars()}{
+            fresh.reserve(quantified.size());
+            for(auto *tv : quantified)
+                fresh.push_back(nextTypeVar(tv->isRhoVar()));
+        }
+
+        AnType* copy(AnType *t){
+            if(!t->isGeneric)
+                return t;
+
+            if(t->isModifierType()){
+                auto modTy = static_cast<AnModifier*>(t);
+                return (AnType*)modTy->addModifiersTo(copy((AnType*)modTy->extTy));
+            }
+
+            if(auto fn = try_cast<AnFunctionType>(t)){
+                return AnFunctionType::get(copy(fn->retTy), copyAll(fn->paramTys),
+                        ante::applyToAll(fn->typeClassConstraints, [&](TraitImpl *impl){ return copy(impl); }));
+
+            }else if(auto pt = try_cast<AnProductType>(t)){
+                auto exts = copyAll(pt->fields);
+                auto typeVars = copyAll(pt->typeArgs);
+                if(exts == pt->fields && typeVars == pt->typeArgs){
+                    return pt;
+                }else{
+                    return AnProductType::createVariant(pt, exts, typeVars);
+                }
+
+            }else if(auto st = try_cast<AnSumType>(t)){
+                auto exts = copyAll(st->tags);
+                auto typeVars = copyAll(st->typeArgs);
+                if(exts == st->tags && typeVars == st->typeArgs){
+                    return st;
+                }else{
+                    return AnSumType::createVariant(st, exts, typeVars);
+                }
+
+            }else if(auto tv = try_cast<AnTypeVarType>(t)){
+                return lookup(tv);
+
+            }else if(auto tup = try_cast<AnTupleType>(t)){
+                return AnTupleType::getAnonRecord(copyAll(tup->fields), tup->fieldNames);
+
+            }else if(auto ptr = try_cast<AnPtrType>(t)){
+                return AnPtrType::get(copy(ptr->extTy));
+
+            }else if(auto arr = try_cast<AnArrayType>(t)){
+                return AnArrayType::get(copy(arr->extTy), arr->len);
+
+            }else{
+                std::cerr << "Unknown type: " << anTypeToColoredStr(t) << std::endl;
+                ASSERT_UNREACHABLE();
+            }
+        }
+    };
+
+
     AnType* copyWithNewTypeVars(AnType *t){
         if(!t->isGeneric)
             return t;
 
-        std::unordered_map<std::string, AnTypeVarType*> map;
         auto variant = try_cast<AnProductType>(t);
         if(variant && variant->parentUnionType){
-            auto st = (AnSumType*)copyWithNewTypeVars(variant->parentUnionType, map);
+            Instantiation instantiation{variant->parentUnionType};
+            auto st = (AnSumType*)instantiation.copy(variant->parentUnionType);
             return st->getTagByName(variant->name);
         }else{
-            return copyWithNewTypeVars(t, map);
+            Instantiation instantiation{t};
+            return instantiation.copy(t);
         }
     }
 
@@ -128,6 +203,10 @@ namespace ante {
         if(!t->isGeneric)
             return t;
 
+        if(!subType->isModifierType() && subType->typeTag == TT_TypeVar
+                && !t->containsTypeVar(static_cast<AnTypeVarType*>(subType)))
+            return t;
+
         if(recursionLimit < 0){
             std::cerr << "u = " << anTypeToColoredStr(u)<< ", subType = " << anTypeToColoredStr(subType)
                       << ", t = " << anTypeToColoredStr(t) << '\n';
@@ -164,9 +243,7 @@ namespace ante {
             if(exts == st->tags && generics == st->typeArgs){
                 return st;
             }else{
-                auto ret = AnSumType::createVariant(st, exts, generics);
-                setExtsParentUnionTypeIfNotSet(ret, exts);
-                return ret;
+                return AnSumType::createVariant(st, exts, generics);
             }
 
         }else if(auto fn = try_cast<AnFunctionType>(t)){
@@ -185,239 +262,369 @@ namespace ante {
     }
 
 
-    bool containsTypeVarHelper(const AnType *t, AnTypeVarType *typeVar){
+    bool hasTypeVarNotInSet(const AnType *t, TypeVarSet &set){
         if(!t->isGeneric)
             return false;
 
-        if(t->isModifierType()){
-            auto modTy = (AnModifier*)t;
-            return containsTypeVarHelper(modTy->extTy, typeVar);
+        for(AnTypeVarType *tv : t->getContainedTypeVars()){
+            if(set.find(tv) == set.end())
+                return true;
         }
+        return false;
+    }
 
-        if(auto ptr = try_cast<AnPtrType>(t)){
-            return containsTypeVarHelper(ptr->extTy, typeVar);
+    void getAllContainedTypeVarsHelper(const TraitImpl *impl, TypeVarSet &set){
+        for(AnType *t : impl->typeArgs){
+            getAllContainedTypeVarsHelper(t, set);
+        }
+    }
 
-        }else if(auto arr = try_cast<AnArrayType>(t)){
-            return containsTypeVarHelper(arr->extTy, typeVar);
+    void getAllContainedTypeVarsHelper(const AnType *t, TypeVarSet &set){
+        if(!t->isGeneric)
+            return;
 
-        }else if(auto tv = try_cast<AnTypeVarType>(t)){
-            return tv == typeVar;
+        auto typeVars = t->getContainedTypeVars();
+        set.insert(typeVars.begin(), typeVars.end());
+    }
 
-        }else if(auto dt = try_cast<AnProductType>(t)){
-            if(ante::any(dt->typeArgs, [&](AnType *f){ return containsTypeVarHelper(f, typeVar); }))
-                return true;
+    TypeVarSet getAllContainedTypeVars(const AnType *t){
+        TypeVarSet ret;
+        getAllContainedTypeVarsHelper(t, ret);
+        return ret;
+    }
 
-            return ante::any(dt->fields, [&](AnType *f){ return containsTypeVarHelper(f, typeVar); });
 
-        }else if(auto st = try_cast<AnSumType>(t)){
-            if(ante::any(st->typeArgs, [&](AnType *f){ return containsTypeVarHelper(f, typeVar); }))
-                return true;
+    AnFunctionType* cleanTypeClassConstraints(AnFunctionType *t){
+        std::vector<TraitImpl*> c;
+        c.reserve(t->typeClassConstraints.size());
+
+        auto tEnd = t->typeClassConstraints.end();
+        for(auto it1 = t->typeClassConstraints.begin(); it1 != tEnd; ++it1){
+            auto elemit = std::find_if(it1 + 1, tEnd, [&](TraitImpl *elem){
+                return *elem == **it1;
+            });
+            if(elemit == tEnd){
+                c.push_back(*it1);
+            }
+        }
 
-            return ante::any(st->tags, [&](AnProductType *f){ return containsTypeVarHelper(f, typeVar); });
+        return AnFunctionType::get(t->retTy, t->paramTys, c);
+    }
 
-        }else if(auto fn = try_cast<AnFunctionType>(t)){
-            if(ante::any(fn->paramTys, [&](AnType *f){ return containsTypeVarHelper(f, typeVar); }))
-                return true;
 
-            if(containsTypeVarHelper(fn->retTy, typeVar))
-                return true;
+    AnType* applySubstitutions(Substitutions const& substitutions, AnType *t){
+        for(auto it = substitutions.rbegin(); it != substitutions.rend(); ++it){
+            auto variant = try_cast<AnProductType>(t);
+            if(variant && variant->parentUnionType){
+                auto st = (AnSumType*)applySubstitutions(substitutions, variant->parentUnionType);
+                t = st->getTagByName(variant->name);
+            }else{
+                t = substitute(it->second, it->first, t);
+            }
+        }
+        return t;
+    }
 
-            auto tccContainsTypeVar = [&](TraitImpl *t){
-                return ante::any(t->typeArgs, [&](AnType *t){ return containsTypeVarHelper(t, typeVar); });
-            };
+    TraitImpl* applySubstitutions(Substitutions const& substitutions, TraitImpl *t){
+        auto ret = new TraitImpl(t->name, t->typeArgs);
+        for(auto it = substitutions.rbegin(); it != substitutions.rend(); ++it){
+            ret->typeArgs = ante::applyToAll(ret->typeArgs, [it](AnType *type){
+                return substitute(it->second, it->first, type);
+            });
+        }
+        return ret;
+    }
 
-            return ante::any(fn->typeClassConstraints, tccContainsTypeVar);
+    SubstitutionMemo::SubstitutionMemo(Substitutions const& substitutions){
+        for(auto &sub : substitutions){
+            if(!sub.first->isModifierType() && sub.first->typeTag == TT_TypeVar)
+                replacements[static_cast<AnTypeVarType*>(sub.first)] = sub.second;
+        }
+    }
 
-        }else if(auto tup = try_cast<AnTupleType>(t)){
-            return ante::any(tup->fields, [&](AnType *f){ return containsTypeVarHelper(f, typeVar); });
+    bool SubstitutionMemo::isUnchanged(const AnType *t) const {
+        if(!t->isGeneric)
+            return true;
 
-        }else{
-            return false;
+        for(AnTypeVarType *tv : t->getContainedTypeVars()){
+            if(replacements.count(tv))
+                return false;
         }
+        return true;
     }
 
-    bool containsTypeVar(AnType *t, AnTypeVarType *typeVar){
-        if(t == typeVar) return false;
-        return containsTypeVarHelper(t, typeVar);
+    TraitImpl* SubstitutionMemo::apply(TraitImpl *t){
+        return new TraitImpl(t->name, ante::applyToAll(t->typeArgs, [&](AnType *typeArg){
+            return apply(typeArg);
+        }));
     }
 
-    bool hasTypeVarNotInMap(const AnType *t, llvm::StringMap<const AnTypeVarType*> &map){
-        if(!t->isGeneric)
-            return false;
+    AnType* SubstitutionMemo::applyHelper(AnType *t, int recursionLimit){
+        if(isUnchanged(t))
+            return t;
 
-        if(t->isModifierType()){
-            auto modTy = (AnModifier*)t;
-            return hasTypeVarNotInMap(modTy->extTy, map);
+        if(recursionLimit < 0){
+            std::cerr << "t = " << anTypeToColoredStr(t) << '\n';
+            ASSERT_UNREACHABLE("internal recursion limit (10,000) reached in ante::SubstitutionMemo::apply");
         }
 
-        if(auto tv = try_cast<AnTypeVarType>(t)){
-            return map.find(tv->name) == map.end();
+        auto it = results.find(t);
+        if(it != results.end())
+            return it->second;
+
+        auto applyToAll = [&](std::vector<AnType*> const& vec){
+            return ante::applyToAll(vec, [&](AnType *elem){ return applyHelper(elem, recursionLimit - 1); });
+        };
+
+        AnType *ret;
+        auto variant = try_cast<AnProductType>(t);
+
+        if(t->isModifierType()){
+            auto modTy = static_cast<AnModifier*>(t);
+            ret = (AnType*)modTy->addModifiersTo(applyHelper((AnType*)modTy->extTy, recursionLimit - 1));
+
+        }else if(variant && variant->parentUnionType){
+            auto st = (AnSumType*)applyHelper(variant->parentUnionType, recursionLimit - 1);
+            ret = st->getTagByName(variant->name);
+
+        }else if(auto tv = try_cast<AnTypeVarType>(t)){
+            ret = replacements[tv];
 
         }else if(auto ptr = try_cast<AnPtrType>(t)){
-            return hasTypeVarNotInMap(ptr->extTy, map);
+            ret = AnPtrType::get(applyHelper(ptr->extTy, recursionLimit - 1));
 
         }else if(auto arr = try_cast<AnArrayType>(t)){
-            return hasTypeVarNotInMap(arr->extTy, map);
+            ret = AnArrayType::get(applyHelper(arr->extTy, recursionLimit - 1), arr->len);
 
-        }else if(auto dt = try_cast<AnProductType>(t)){
-            return ante::any(dt->typeArgs, [&](AnType *f){ return hasTypeVarNotInMap(f, map); })
-                || ante::any(dt->fields, [&](AnType *f){ return hasTypeVarNotInMap(f, map); });
+        }else if(variant){
+            auto exts = applyToAll(variant->fields);
+            auto generics = applyToAll(variant->typeArgs);
+            if(exts == variant->fields && generics == variant->typeArgs)
+                ret = t;
+            else
+                ret = AnProductType::createVariant(variant, exts, generics);
 
         }else if(auto st = try_cast<AnSumType>(t)){
-            return ante::any(st->typeArgs, [&](AnType *f){ return hasTypeVarNotInMap(f, map); })
-                || ante::any(st->tags, [&](AnProductType *f){ return hasTypeVarNotInMap(f, map); });
+            auto exts = ante::applyToAll(st->tags, [&](AnProductType *tag){
+                return (AnProductType*)applyHelper(tag, recursionLimit - 1);
+            });
+            auto generics = applyToAll(st->typeArgs);
 
-        }else if(auto fn = try_cast<AnFunctionType>(t)){
-            auto tccContainsTypeVar = [&](TraitImpl *t){
-                return ante::any(t->typeArgs, [&](AnType *t){ return hasTypeVarNotInMap(t, map); });
-            };
+            if(exts == st->tags && generics == st->typeArgs){
+                ret = st;
+            }else{
+                ret = AnSumType::createVariant(st, exts, generics);
+            }
 
-            return ante::any(fn->paramTys, [&](AnType *f){ return hasTypeVarNotInMap(f, map); })
-                || hasTypeVarNotInMap(fn->retTy, map)
-                || ante::any(fn->typeClassConstraints, tccContainsTypeVar);
+        }else if(auto fn = try_cast<AnFunctionType>(t)){
+            auto tcc = ante::applyToAll(fn->typeClassConstraints, [&](TraitImpl *impl){ return apply(impl); });
+            ret = AnFunctionType::get(applyHelper(fn->retTy, recursionLimit - 1), applyToAll(fn->paramTys),
+                    tcc, t->typeTag == TT_MetaFunction);
 
         }else if(auto tup = try_cast<AnTupleType>(t)){
-            return ante::any(tup->fields, [&](AnType *f){ return hasTypeVarNotInMap(f, map); });
+            ret = AnTupleType::getAnonRecord(applyToAll(tup->fields), tup->fieldNames);
 
         }else{
-            return false;
+            ret = t;
         }
+
+        results[t] = ret;
+        return ret;
     }
 
-    void getAllContainedTypeVarsHelper(const AnType *t, llvm::StringMap<const AnTypeVarType*> &map);
+    enum TypeErrorKind {
+        Mismatch, InfRecursion1, InfRecursion2
+    };
 
-    void getAllContainedTypeVarsHelper(const TraitImpl *impl, llvm::StringMap<const AnTypeVarType*> &map){
-        for(AnType *t : impl->typeArgs){
-            getAllContainedTypeVarsHelper(t, map);
-        }
-    }
+    struct TypeErrorContext : public std::exception {
+        const AnType *t1, *t2;
+        const TypeErrorKind kind;
 
-    void getAllContainedTypeVarsHelper(const AnType *t, llvm::StringMap<const AnTypeVarType*> &map){
-        if(!t->isGeneric)
-            return;
+        TypeErrorContext(const AnType *t1, const AnType *t2, TypeErrorKind kind)
+            : t1{t1}, t2{t2}, kind{kind}{}
+    };
 
-        if(t->isModifierType()){
-            getAllContainedTypeVarsHelper(static_cast<const AnModifier*>(t)->extTy, map);
-            return;
-        }
 
-        if(auto fn = try_cast<AnFunctionType>(t)){
-            getAllContainedTypeVarsHelper(fn->retTy, map);
-            for(AnType *paramTy : fn->paramTys){ getAllContainedTypeVarsHelper(paramTy, map); }
-            for(TraitImpl *tcc : fn->typeClassConstraints){ getAllContainedTypeVarsHelper(tcc, map); }
+    TypeBindings::Node& TypeBindings::getNode(AnTypeVarType *tv){
+        auto it = nodes.find(tv);
+        if(it != nodes.end())
+            return it->second;
 
-        }else if(auto pt = try_cast<AnProductType>(t)){
-            for(AnType *fieldTy : pt->fields){ getAllContainedTypeVarsHelper(fieldTy, map); }
-            for(AnType *typeArg : pt->typeArgs){ getAllContainedTypeVarsHelper(typeArg, map); }
+        boundVars.push_back(tv);
+        return nodes[tv] = Node{nullptr, nullptr};
+    }
 
-        }else if(auto st = try_cast<AnSumType>(t)){
-            for(AnType *tagTy : st->tags){ getAllContainedTypeVarsHelper(tagTy, map); }
-            for(AnType *typeArg : st->typeArgs){ getAllContainedTypeVarsHelper(typeArg, map); }
+    AnTypeVarType* TypeBindings::findRoot(AnTypeVarType *tv){
+        AnTypeVarType *root = tv;
+        auto it = nodes.find(root);
+        while(it != nodes.end() && it->second.parent){
+            root = it->second.parent;
+            it = nodes.find(root);
+        }
 
-        }else if(auto tv = try_cast<AnTypeVarType>(t)){
-            map[tv->name] = tv;
+        // path compression: point each variable on the path directly at the root
+        while(tv != root){
+            auto &node = nodes[tv];
+            tv = node.parent;
+            node.parent = root;
+        }
+        return root;
+    }
 
-        }else if(auto tup = try_cast<AnTupleType>(t)){
-            for(AnType *extTy : tup->fields){ getAllContainedTypeVarsHelper(extTy, map); }
+    AnType* TypeBindings::find(AnType *t){
+        auto tv = try_cast<AnTypeVarType>(t);
+        if(!tv) return t;
 
-        }else if(auto ptr = try_cast<AnPtrType>(t)){
-            getAllContainedTypeVarsHelper(ptr->extTy, map);
+        auto root = findRoot(tv);
+        auto it = nodes.find(root);
+        if(it != nodes.end() && it->second.binding)
+            return it->second.binding;
 
-        }else if(auto arr = try_cast<AnArrayType>(t)){
-            getAllContainedTypeVarsHelper(arr->extTy, map);
+        return root == tv ? t : root;
+    }
 
+    void TypeBindings::bind(AnTypeVarType *root, AnType *t){
+        // Variables are always linked left to right to keep the
+        // direction of each binding identical to a substitution 'root -> t
+        if(auto tv = try_cast<AnTypeVarType>(t)){
+            getNode(root).parent = tv;
         }else{
-            std::cerr << "Unknown type: " << anTypeToColoredStr(t) << std::endl;
-            ASSERT_UNREACHABLE();
+            getNode(root).binding = t;
         }
     }
 
-    llvm::StringMap<const AnTypeVarType*> getAllContainedTypeVars(const AnType *t){
-        llvm::StringMap<const AnTypeVarType*> ret;
-        getAllContainedTypeVarsHelper(t, ret);
-        return ret;
-    }
+    bool TypeBindings::occurs(AnTypeVarType *root, AnType *t){
+        if(!t->isGeneric)
+            return false;
 
+        // Only the typevars within t and those within their bindings need
+        // to be checked, so the structure of each type is never traversed.
+        llvm::SmallVector<AnType*, 8> worklist{t};
+        llvm::SmallPtrSet<AnType*, 8> visited;
 
-    AnFunctionType* cleanTypeClassConstraints(AnFunctionType *t){
-        std::vector<TraitImpl*> c;
-        c.reserve(t->typeClassConstraints.size());
+        while(!worklist.empty()){
+            AnType *cur = worklist.pop_back_val();
 
-        auto tEnd = t->typeClassConstraints.end();
-        for(auto it1 = t->typeClassConstraints.begin(); it1 != tEnd; ++it1){
-            auto elemit = std::find_if(it1 + 1, tEnd, [&](TraitImpl *elem){
-                return *elem == **it1;
-            });
-            if(elemit == tEnd){
-                c.push_back(*it1);
+            for(AnTypeVarType *tv : cur->getContainedTypeVars()){
+                AnType *bound = find(tv);
+                if(bound == root)
+                    return true;
+
+                if(bound != tv && bound->isGeneric && visited.insert(bound).second)
+                    worklist.push_back(bound);
             }
         }
+        return false;
+    }
 
-        return AnFunctionType::get(t->retTy, t->paramTys, c);
+    template<class T>
+    std::vector<T*> resolveAll(TypeBindings &bindings, std::vector<T*> const& vec){
+        return ante::applyToAll(vec, [&](T *elem){
+            return (T*)bindings.resolve(elem);
+        });
     }
 
+    TraitImpl* TypeBindings::resolve(TraitImpl *impl){
+        return new TraitImpl(impl->name, resolveAll(*this, impl->typeArgs));
+    }
 
-    AnType* applySubstitutions(Substitutions const& substitutions, AnType *t){
-        for(auto it = substitutions.rbegin(); it != substitutions.rend(); ++it){
-            auto variant = try_cast<AnProductType>(t);
-            if(variant && variant->parentUnionType){
-                auto st = (AnSumType*)applySubstitutions(substitutions, variant->parentUnionType);
-                t = st->getTagByName(variant->name);
+    AnType* TypeBindings::resolveHelper(AnType *t){
+        if(!t->isGeneric)
+            return t;
+
+        if(t->isModifierType()){
+            auto modTy = static_cast<AnModifier*>(t);
+            return (AnType*)modTy->addModifiersTo(resolveHelper((AnType*)modTy->extTy));
+        }
+
+        if(auto ptr = try_cast<AnPtrType>(t)){
+            return AnPtrType::get(resolveHelper(ptr->extTy));
+
+        }else if(auto arr = try_cast<AnArrayType>(t)){
+            return AnArrayType::get(resolveHelper(arr->extTy), arr->len);
+
+        }else if(auto tv = try_cast<AnTypeVarType>(t)){
+            auto bound = find(tv);
+            return bound == tv ? tv : resolveHelper(bound);
+
+        }else if(auto dt = try_cast<AnProductType>(t)){
+            auto exts = ante::applyToAll(dt->fields, [&](AnType *f){ return resolveHelper(f); });
+            auto generics = ante::applyToAll(dt->typeArgs, [&](AnType *f){ return resolveHelper(f); });
+
+            if(exts == dt->fields && generics == dt->typeArgs)
+                return t;
+            else
+                return AnProductType::createVariant(dt, exts, generics);
+
+        }else if(auto st = try_cast<AnSumType>(t)){
+            auto exts = ante::applyToAll(st->tags, [&](AnProductType *f){ return (AnProductType*)resolveHelper(f); });
+            auto generics = ante::applyToAll(st->typeArgs, [&](AnType *f){ return resolveHelper(f); });
+
+            if(exts == st->tags && generics == st->typeArgs){
+                return st;
             }else{
-                t = substitute(it->second, it->first, t);
+                return AnSumType::createVariant(st, exts, generics);
             }
+
+        }else if(auto fn = try_cast<AnFunctionType>(t)){
+            auto exts = ante::applyToAll(fn->paramTys, [&](AnType *f){ return resolveHelper(f); });
+            auto rett = resolveHelper(fn->retTy);
+            auto tcc  = ante::applyToAll(fn->typeClassConstraints, [&](TraitImpl *f){ return resolve(f); });
+            return AnFunctionType::get(rett, exts, tcc, t->typeTag == TT_MetaFunction);
+
+        }else if(auto tup = try_cast<AnTupleType>(t)){
+            auto exts = ante::applyToAll(tup->fields, [&](AnType *f){ return resolveHelper(f); });
+            return AnTupleType::getAnonRecord(exts, tup->fieldNames);
+
+        }else{
+            return t;
         }
-        return t;
     }
 
-    TraitImpl* applySubstitutions(Substitutions const& substitutions, TraitImpl *t){
-        auto ret = new TraitImpl(t->name, t->typeArgs);
-        for(auto it = substitutions.rbegin(); it != substitutions.rend(); ++it){
-            ret->typeArgs = ante::applyToAll(ret->typeArgs, [it](AnType *type){
-                return substitute(it->second, it->first, type);
-            });
+    AnType* TypeBindings::resolve(AnType *t){
+        auto variant = try_cast<AnProductType>(t);
+        if(variant && variant->parentUnionType){
+            auto st = (AnSumType*)resolveHelper(variant->parentUnionType);
+            return st->getTagByName(variant->name);
         }
-        return ret;
+        return resolveHelper(t);
     }
 
-    enum TypeErrorKind {
-        Mismatch, InfRecursion1, InfRecursion2
-    };
-
-    struct TypeErrorContext : public std::exception {
-        const AnType *t1, *t2;
-        const TypeErrorKind kind;
-        Substitutions subs;
+    Substitutions TypeBindings::getSubstitutions(){
+        Substitutions ret;
+        for(AnTypeVarType *tv : boundVars){
+            auto t = resolve(tv);
+            if(t != tv){
+                ret.emplace_back(tv, t);
+            }
+        }
+        return ret;
+    }
 
-        TypeErrorContext(const AnType *t1, const AnType *t2, TypeErrorKind kind)
-            : t1{t1}, t2{t2}, kind{kind}, subs{}{}
-    };
 
-    Substitutions unify(UnificationList const& list, UnificationList::const_reverse_iterator cur, bool isTopLevel);
+    using Worklist = std::vector<std::pair<AnType*, AnType*>>;
 
     /**
-     * Helper for a recursive call to unify.
-     * Supplies arguments needed for good error messages.
+     * Push each pair of types onto the worklist in reverse so that
+     * they are popped, and thus unified, from left to right.
      */
-    Substitutions unifyRecursive(UnificationList const& list){
-        return unify(list, list.rbegin(), false);
+    template<class T>
+    void pushExts(Worklist &worklist, std::vector<T*> const& exts1, std::vector<T*> const& exts2, size_t len){
+        for(size_t i = len; i > 0; i--)
+            worklist.emplace_back(exts1[i - 1], exts2[i - 1]);
     }
 
     template<class T>
-    Substitutions unifyExts(std::vector<T*> const& exts1, std::vector<T*> const& exts2,
-            const AnType *t1, const AnType *t2, TypeError const& err){
+    void unifyExts(Worklist &worklist, std::vector<T*> const& exts1, std::vector<T*> const& exts2,
+            const AnType *t1, const AnType *t2){
 
         if(exts1.size() != exts2.size()){
             throw TypeErrorContext(t1, t2, Mismatch);
         }
-
-        UnificationList ret;
-        for(size_t i = 0; i < exts1.size(); i++)
-            ret.emplace_back(exts1[i], exts2[i], err);
-        return unifyRecursive(ret);
+        pushExts(worklist, exts1, exts2, exts1.size());
     }
 
-    Substitutions unifyTuple(AnTupleType *tup1, AnTupleType *tup2, TypeError const& err){
+    void unifyTuple(Worklist &worklist, AnTupleType *tup1, AnTupleType *tup2){
         auto len1 = tup1->fields.size();
         auto len2 = tup2->fields.size();
         if(tup1->hasRhoVar()) len1--;
@@ -438,125 +645,129 @@ namespace ante {
                 }
             }
         }
-
-        UnificationList ret;
-        for(size_t i = 0; i < len1; i++)
-            ret.emplace_back(tup1->fields[i], tup2->fields[i], err);
-        return unifyRecursive(ret);
+        pushExts(worklist, tup1->fields, tup2->fields, len1);
     }
 
 
-    Substitutions unifyOne(AnType *t1, AnType *t2, TypeError const& err){
-        auto tv1 = try_cast<AnTypeVarType>(t1);
-        auto tv2 = try_cast<AnTypeVarType>(t2);
-
-        if(tv1){
-            if(containsTypeVar(t2, tv1)){
-                throw TypeErrorContext(t1, t2, InfRecursion1);
-            }
-            return {{tv1, t2}};
-        }else if(tv2){
-            if(containsTypeVar(t1, tv2)){
-                throw TypeErrorContext(t1, t2, InfRecursion2);
+    /**
+     * Unify t1 and t2 along with each pair of their contained types.
+     * Contained types are kept in an explicit worklist rather than
+     * recursed upon so that the stack usage of unification is bounded
+     * regardless of how large the types involved are.
+     */
+    void TypeBindings::unify(AnType *a, AnType *b){
+        Worklist worklist;
+        worklist.emplace_back(a, b);
+
+        while(!worklist.empty()){
+            auto t1 = find(worklist.back().first);
+            auto t2 = find(worklist.back().second);
+            worklist.pop_back();
+
+            auto tv1 = try_cast<AnTypeVarType>(t1);
+            auto tv2 = try_cast<AnTypeVarType>(t2);
+
+            if(tv1 && tv1 == tv2){
+                continue;
+            }else if(tv1){
+                if(occurs(tv1, t2)){
+                    throw TypeErrorContext(t1, t2, InfRecursion1);
+                }
+                bind(tv1, t2);
+                continue;
+            }else if(tv2){
+                if(occurs(tv2, t1)){
+                    throw TypeErrorContext(t1, t2, InfRecursion2);
+                }
+                bind(tv2, t1);
+                continue;
             }
-            return {{tv2, t1}};
-        }
-
-        if(t1->typeTag != t2->typeTag){
-            throw TypeErrorContext(t1, t2, Mismatch);
-        }
 
-        UnificationList ret;
-
-        if(!t1->isGeneric && !t2->isGeneric){
-            if(!t1->approxEq(t2)){
+            if(t1->typeTag != t2->typeTag){
                 throw TypeErrorContext(t1, t2, Mismatch);
             }
-            return {};
-        }
 
-        if(auto ptr1 = try_cast<AnPtrType>(t1)){
-            auto ptr2 = try_cast<AnPtrType>(t2);
-            ret.emplace_back(ptr1->extTy, ptr2->extTy, err);
-            return unifyRecursive(ret);
+            if(!t1->isGeneric && !t2->isGeneric){
+                if(!t1->approxEq(t2)){
+                    throw TypeErrorContext(t1, t2, Mismatch);
+                }
+                continue;
+            }
 
-        }else if(auto arr1 = try_cast<AnArrayType>(t1)){
-            auto arr2 = try_cast<AnArrayType>(t2);
-            ret.emplace_back(arr1->extTy, arr2->extTy, err);
-            return unifyRecursive(ret);
+            if(auto ptr1 = try_cast<AnPtrType>(t1)){
+                auto ptr2 = try_cast<AnPtrType>(t2);
+                worklist.emplace_back(ptr1->extTy, ptr2->extTy);
 
-        }else if(auto pt1 = try_cast<AnProductType>(t1)){
-            auto pt2 = try_cast<AnProductType>(t2);
-            return unifyExts(pt1->typeArgs, pt2->typeArgs, pt1, pt2, err);
+            }else if(auto arr1 = try_cast<AnArrayType>(t1)){
+                auto arr2 = try_cast<AnArrayType>(t2);
+                worklist.emplace_back(arr1->extTy, arr2->extTy);
 
-        }else if(auto st1 = try_cast<AnSumType>(t1)){
-            auto st2 = try_cast<AnSumType>(t2);
-            return unifyExts(st1->typeArgs, st2->typeArgs, st1, st2, err);
+            }else if(auto pt1 = try_cast<AnProductType>(t1)){
+                auto pt2 = try_cast<AnProductType>(t2);
+                unifyExts(worklist, pt1->typeArgs, pt2->typeArgs, pt1, pt2);
 
-        }else if(auto fn1 = try_cast<AnFunctionType>(t1)){
-            auto fn2 = try_cast<AnFunctionType>(t2);
-            if(fn1->paramTys.size() != fn2->paramTys.size()){
-                throw TypeErrorContext(t1, t2, Mismatch);
-            }
+            }else if(auto st1 = try_cast<AnSumType>(t1)){
+                auto st2 = try_cast<AnSumType>(t2);
+                unifyExts(worklist, st1->typeArgs, st2->typeArgs, st1, st2);
 
-            for(size_t i = 0; i < fn1->paramTys.size(); i++)
-                ret.emplace_back(fn1->paramTys[i], fn2->paramTys[i], err);
+            }else if(auto fn1 = try_cast<AnFunctionType>(t1)){
+                auto fn2 = try_cast<AnFunctionType>(t2);
+                if(fn1->paramTys.size() != fn2->paramTys.size()){
+                    throw TypeErrorContext(t1, t2, Mismatch);
+                }
 
-            ret.emplace_back(fn1->retTy, fn2->retTy, err);
-            return unifyRecursive(ret);
+                worklist.emplace_back(fn1->retTy, fn2->retTy);
+                pushExts(worklist, fn1->paramTys, fn2->paramTys, fn1->paramTys.size());
 
-        }else if(auto tup1 = try_cast<AnTupleType>(t1)){
-            auto tup2 = try_cast<AnTupleType>(t2);
-            return unifyTuple(tup1, tup2, err);
+            }else if(auto tup1 = try_cast<AnTupleType>(t1)){
+                auto tup2 = try_cast<AnTupleType>(t2);
+                unifyTuple(worklist, tup1, tup2);
+            }
+        }
+    }
 
-        }else{
-            return {};
+
+    Substitutions unifyOne(AnType *t1, AnType *t2, TypeError const& err){
+        TypeBindings bindings;
+        try{
+            bindings.unify(t1, t2);
+        }catch(TypeErrorContext&){
+            err.show(bindings.resolve(t1), bindings.resolve(t2));
+            throw CtError();
         }
+        return bindings.getSubstitutions();
     }
 
 
-    Substitutions unify(UnificationList const& list, UnificationList::const_reverse_iterator cur, bool isTopLevel){
-        if(cur == list.rend()){
-            return {};
-        }else{
-            auto &p = *cur;
-            auto t2 = unify(list, ++cur, isTopLevel);
+    /**
+     * Solve each equality constraint in order.  Each failing constraint
+     * issues its own error, after which solving continues with the rest
+     * of the list to report as many errors as possible.
+     */
+    Substitutions unify(UnificationList const& list){
+        TypeBindings bindings;
 
+        for(auto &p : list){
             if(!p.isEqConstraint()){
-                return t2;
+                continue;
             }
 
             try{
                 auto eq = p.asEqConstraint();
 
-                Substitutions t1;
                 try {
-                    t1 = unifyOne(applySubstitutions(t2, eq.first),
-                                  applySubstitutions(t2, eq.second), p.error);
+                    bindings.unify(eq.first, eq.second);
                 }catch(TypeErrorContext& e){
-                    e.subs.insert(e.subs.end(), t2.begin(), t2.end());
-                    if(!isTopLevel){
-                        throw e;
-                    }
-
-                    p.error.show(applySubstitutions(e.subs, eq.first), applySubstitutions(e.subs, eq.second));
+                    p.error.show(bindings.resolve(eq.first), bindings.resolve(eq.second));
                     if(e.kind == InfRecursion1)
-                        showError(anTypeToColoredStr(e.t1) + " occurs inside " + anTypeToColoredStr(e.t2), p.error.loc, ErrorType::Note);
+                        showError(anTypeToColoredStr(bindings.resolve((AnType*)e.t1)) + " occurs inside "
+                                + anTypeToColoredStr(bindings.resolve((AnType*)e.t2)), p.error.loc, ErrorType::Note);
                     if(e.kind == InfRecursion2)
-                        showError(anTypeToColoredStr(e.t2) + " occurs inside " + anTypeToColoredStr(e.t1), p.error.loc, ErrorType::Note);
-                    return {};
+                        showError(anTypeToColoredStr(bindings.resolve((AnType*)e.t2)) + " occurs inside "
+                                + anTypeToColoredStr(bindings.resolve((AnType*)e.t1)), p.error.loc, ErrorType::Note);
                 }
-
-                Substitutions ret = t1;
-                ret.insert(ret.end(), t2.begin(), t2.end());
-                return ret;
-            }catch(CtError e){
-                return t2;
-            }
+            }catch(CtError e){}
         }
-    }
-
-    Substitutions unify(UnificationList const& cur){
-        return unify(cur, cur.rbegin(), true);
+        return bindings.getSubstitutions();
     }
 }
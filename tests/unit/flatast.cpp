@@ -0,0 +1,136 @@
+#include "unittest.h"
+#include "ptree.h"
+#include "flatast.h"
+#include "substitutingvisitor.h"
+using namespace ante;
+using namespace ante::parser;
+using namespace std;
+
+/**
+ * if 1 < 2 then 3 else 4
+ * 5
+ */
+TEST_CASE("A FlatAst numbers each node's children consecutively", "[parser]"){
+    LOC_TY loc;
+    auto *cond = new BinOpNode(loc, '<', new IntLitNode(loc, "1", TT_I32), new IntLitNode(loc, "2", TT_I32));
+    auto *ifNode = new IfNode(loc, cond, new IntLitNode(loc, "3", TT_I32), new IntLitNode(loc, "4", TT_I32));
+    auto *seq = new SeqNode(loc);
+    seq->sequence.emplace_back(ifNode);
+    seq->sequence.emplace_back(new IntLitNode(loc, "5", TT_I32));
+
+    FlatAst flat{seq};
+    REQUIRE(flat.size() == 8);
+    REQUIRE(flat.getKind(0) == NodeKind::Seq);
+    REQUIRE(flat.getParent(0) == FlatAst::noParent);
+
+    //The sequence's children come first, then the if's, then the comparison's
+    REQUIRE(flat.childrenBegin(0) == 1);
+    REQUIRE(flat.childrenEnd(0) == 3);
+    REQUIRE(flat.getNode(1) == ifNode);
+    REQUIRE(flat.getKind(1) == NodeKind::If);
+    REQUIRE(flat.childrenBegin(1) == 3);
+    REQUIRE(flat.childrenEnd(1) == 6);
+    REQUIRE(flat.getNode(3) == cond);
+    REQUIRE(flat.getKind(3) == NodeKind::BinOp);
+    REQUIRE(flat.childrenBegin(3) == 6);
+    REQUIRE(flat.childrenEnd(3) == 8);
+
+    for(NodeId id = 0; id < flat.size(); id++)
+        for(NodeId child = flat.childrenBegin(id); child < flat.childrenEnd(id); child++)
+            REQUIRE(flat.getParent(child) == id);
+
+    flat.setType(1, AnType::getI32());
+    REQUIRE(!ifNode->getType());
+    flat.storeTypes();
+    REQUIRE(ifNode->getType() == AnType::getI32());
+    REQUIRE(!cond->getType());
+    delete seq;
+}
+
+/** Build the same tree each time, typing each node with the typevars given */
+static Node* makeTypedTree(vector<AnType*> const& tvs){
+    LOC_TY loc;
+    auto lit = [&](string const& v){
+        auto *n = new IntLitNode(loc, v, TT_I32);
+        n->setType(AnType::getI32());
+        return n;
+    };
+
+    auto *cond = new BinOpNode(loc, '<', lit("1"), lit("2"));
+    cond->setType(tvs[0]);
+
+    vector<unique_ptr<Node>> pairElems;
+    pairElems.emplace_back(lit("3"));
+    pairElems.emplace_back(lit("4"));
+    auto *pair = new TupleNode(loc, pairElems);
+    pair->setType(tvs[1]);
+
+    vector<unique_ptr<Node>> noElems;
+    auto *unit = new TupleNode(loc, noElems);
+    unit->setType(tvs[2]);
+
+    vector<unique_ptr<Node>> arrayElems;
+    arrayElems.emplace_back(pair);
+    arrayElems.emplace_back(unit);
+    auto *array = new ArrayNode(loc, arrayElems);
+    array->setType(tvs[3]);
+
+    auto *ifNode = new IfNode(loc, cond, array, lit("5"));
+    ifNode->setType(tvs[4]);
+
+    auto *seq = new SeqNode(loc);
+    seq->sequence.emplace_back(ifNode);
+    seq->sequence.emplace_back(new IfNode(loc, lit("6"), lit("7"), nullptr));
+    seq->sequence.back()->setType(tvs[1]);
+    seq->setType(tvs[4]);
+    return seq;
+}
+
+/** Return the type of every node of the tree in the order they are flattened */
+static vector<AnType*> typesOf(Node *n){
+    FlatAst flat{n};
+    vector<AnType*> types;
+    for(NodeId id = 0; id < flat.size(); id++)
+        types.push_back(flat.getNode(id)->getType());
+    return types;
+}
+
+TEST_CASE("Substituting over a FlatAst matches the tree walk", "[parser]"){
+    auto&& c = Compiler(nullptr);
+    vector<AnType*> tvs;
+    for(int i = 0; i < 5; i++)
+        tvs.push_back(nextTypeVar());
+
+    LOC_TY loc;
+    TypeError noErr{"", loc};
+    UnificationList constraints;
+    constraints.emplace_back(tvs[0], AnType::getBool(), noErr);
+    constraints.emplace_back(tvs[1], AnTupleType::get({AnType::getI32(), tvs[0]}), noErr);
+    constraints.emplace_back(tvs[3], AnArrayType::get(tvs[1], 2), noErr);
+    constraints.emplace_back(tvs[4], AnPtrType::get(tvs[3]), noErr);
+    auto subs = ante::unify(constraints);
+
+    Node *walked = makeTypedTree(tvs);
+    Node *flattened = makeTypedTree(tvs);
+    SubstitutingVisitor::substituteIntoAst(walked, subs);
+    {
+        FlatAst flat{flattened};
+        SubstitutingVisitor v{subs};
+        v.substitute(flat);
+    }
+
+    auto expected = typesOf(walked);
+    auto actual = typesOf(flattened);
+    REQUIRE(expected.size() == actual.size());
+    for(size_t i = 0; i < expected.size(); i++){
+        INFO("Node " << i);
+        REQUIRE(actual[i] == expected[i]);
+    }
+
+    //Empty tuples and ifs without an else keep their typevar
+    REQUIRE(contains(actual, tvs[2]));
+    REQUIRE(contains(actual, tvs[1]));
+    REQUIRE(!contains(actual, tvs[4]));
+    delete walked;
+    delete flattened;
+}
@@ -0,0 +1,33 @@
+#include "unittest.h"
+#include "lexer.h"
+#include <algorithm>
+using namespace ante;
+using namespace std;
+
+TEST_CASE("Keywords are lexed as their token", "[lexer]"){
+    yy::parser::location_type loc;
+
+    for(int tok = Tok_Ident; tok <= Tok_Where; tok++){
+        string src = Lexer::getTokStr(tok);
+        bool isKeyword = islower(src[0]) && all_of(src.begin(), src.end(), [](char c){
+            return IS_ALPHANUM(c);
+        });
+
+        if(isKeyword){
+            INFO("Keyword: " << src);
+            Lexer lexer{src};
+            REQUIRE(lexer.next(&loc) == tok);
+
+            //A longer identifier starting with a keyword is not a keyword
+            string longer = src + "x";
+            Lexer longerLexer{longer};
+            REQUIRE(longerLexer.next(&loc) == Tok_Ident);
+        }
+    }
+
+    for(string src : {"i", "i128", "whale", "wher", "wheres", "continues", "x_"}){
+        INFO("Identifier: " << src);
+        Lexer lexer{src};
+        REQUIRE(lexer.next(&loc) == Tok_Ident);
+    }
+}
@@ -0,0 +1,60 @@
+#include "unittest.h"
+#include "lexer.h"
+#include "lexerkernels.h"
+#include "scopeguard.h"
+using namespace ante;
+using namespace std;
+
+/**
+ * Check each kernel returns the same position as the scalar kernels
+ * when starting from every alignment within a run of the given text.
+ */
+static void checkKernelsAgree(string const& text){
+    auto &scalar = LexerKernels::scalar;
+    const char *s = text.c_str();
+
+    for(auto *kernels : LexerKernels::supported()){
+        INFO("Kernels: " << kernels->name);
+        for(size_t i = 0; i < text.size(); i++){
+            REQUIRE(kernels->scanIdentifier(s + i) == scalar.scanIdentifier(s + i));
+            REQUIRE(kernels->scanSpaces(s + i) == scalar.scanSpaces(s + i));
+            REQUIRE(kernels->scanLineEnd(s + i) == scalar.scanLineEnd(s + i));
+            REQUIRE(kernels->scanStrLit(s + i) == scalar.scanStrLit(s + i));
+        }
+    }
+}
+
+TEST_CASE("Lexer kernels agree with the scalar kernels", "[lexer]"){
+    checkKernelsAgree("a_long_identifier_that_spans_several_blocks_0123456789_ABCDEFGHIJKLMNOPQRSTUVWXYZ + x");
+    checkKernelsAgree("                                                                  y");
+    checkKernelsAgree("// a comment longer than one block, with \"quotes\" and \\ escapes\nnext");
+    checkKernelsAgree("\"a string literal long enough to span more than one 32 byte block\\n\" rest");
+    checkKernelsAgree("@[`{/:\x7f\x80\xff unicode \xce\xbb identifiers stop at non ascii bytes");
+    checkKernelsAgree("ends_without_any_delimiter_at_all_before_the_terminator_is_reached");
+}
+
+/**
+ * Lex a generated source file once with each set of kernels.
+ * Run with: antetests "[benchmark]"
+ */
+TEST_CASE("Lexer kernel benchmark", "[.][benchmark]"){
+    string src;
+    for(int i = 0; i < 50000; i++){
+        src += "fn_" + to_string(i) + " some_argument another_argument =\n";
+        src += "    let long_variable_name = some_function_call some_argument  // trailing comment on this line\n";
+        src += "    print \"a string literal with a reasonable amount of text in it\" long_variable_name\n\n";
+    }
+
+    for(auto *kernels : LexerKernels::supported()){
+        TMP_SET(lexerKernels, kernels);
+        size_t tokens = 0;
+
+        BENCHMARK(string("Lex ") + to_string(src.size() / 1024) + "KB with " + kernels->name + " kernels"){
+            Lexer lexer{src};
+            yy::parser::location_type loc;
+            while(lexer.next(&loc))
+                tokens++;
+        }
+        REQUIRE(tokens > 0);
+    }
+}
@@ -1,5 +1,7 @@
 #include "unittest.h"
 #include "module.h"
+#include "antype.h"
+#include "trait.h"
 using namespace ante;
 
 #define LOOP_CHECK(file) \
@@ -72,3 +74,109 @@ TEST_CASE("ModulePaths treat both / and \\ as directory separators", "[ModulePat
     REQUIRE(pathStr(winPath) == "D1.D2.D3.File4");
     REQUIRE(pathStr(unixPath) == "D4.D5.D6.File7");
 }
+
+TEST_CASE("Names declared by imports are visible", "[Module]"){
+    Module first{"First"}, second{"Second"}, importer{"Importer"};
+    LOC_TY loc;
+    Symbol a = Symbol::get("ImportIndexA"), b = Symbol::get("ImportIndexB");
+
+    first.userTypes.try_emplace(a, TypeDecl{AnType::getI32(), loc});
+    second.userTypes.try_emplace(a, TypeDecl{AnType::getBool(), loc});
+    second.userTypes.try_emplace(b, TypeDecl{AnType::getBool(), loc});
+
+    TraitDecl trait{"ImportIndexTrait", {}};
+    second.traitDecls.try_emplace(b, &trait);
+
+    importer.addImport(&first);
+    importer.addImport(&second);
+    REQUIRE(importer.imports.size() == 2);
+
+    //The first module imported is searched first
+    REQUIRE(importer.lookupType(a) == AnType::getI32());
+    REQUIRE(importer.lookupType(b) == AnType::getBool());
+    REQUIRE(importer.lookupTraitDecl(b) == &trait);
+    REQUIRE(!importer.lookupTraitDecl(a));
+    REQUIRE(!importer.lookupFunction(a));
+
+    //Local declarations shadow imported ones
+    importer.userTypes.try_emplace(b, TypeDecl{AnType::getUnit(), loc});
+    REQUIRE(importer.lookupType(b) == AnType::getUnit());
+}
+
+TEST_CASE("Resolved trait impls are invalidated by new impls", "[Module]"){
+    Module lib{"Lib"}, importer{"Importer"};
+    Symbol print = Symbol::get("ResolvedImplPrint");
+    auto i32 = AnType::getI32();
+    auto boolTy = AnType::getBool();
+
+    TraitImpl printAny{"ResolvedImplPrint", {AnTypeVarType::get("'t")}};
+    TraitImpl printI32{"ResolvedImplPrint", {i32}};
+    TraitImpl printBool{"ResolvedImplPrint", {boolTy}};
+
+    REQUIRE(!importer.lookupTraitImpl(print, {boolTy}));
+    importer.addTraitImpl(print, &printBool);
+    REQUIRE(importer.lookupTraitImpl(print, {boolTy}) == &printBool);
+
+    lib.addTraitImpl(print, &printAny);
+    importer.addImport(&lib);
+    REQUIRE(importer.lookupTraitImpl(print, {i32}) == &printAny);
+    REQUIRE(importer.lookupTraitImpl(print, {i32}) == &printAny);
+
+    //Impls in the module itself are searched before imported ones
+    importer.addTraitImpl(print, &printI32);
+    REQUIRE(importer.lookupTraitImpl(print, {i32}) == &printI32);
+    REQUIRE(importer.lookupTraitImpl(print, {boolTy}) == &printBool);
+
+    //Impls without an ExtNode have no methods
+    REQUIRE(!importer.lookupTraitMethod(print, {i32}, Symbol::get("print")));
+
+    //Concrete args resolve to one memoized impl, generic args are never memoized
+    auto *resolved = importer.resolveTraitImpl(print, {i32});
+    REQUIRE(resolved);
+    REQUIRE(resolved->impl == &printI32);
+    REQUIRE(importer.resolveTraitImpl(print, {i32}) == resolved);
+    REQUIRE(!importer.resolveTraitImpl(print, {AnTypeVarType::get("'t")}));
+}
+
+TEST_CASE("Conflicting imports are found by the earliest import", "[Module]"){
+    Module first{"First"}, second{"Second"}, importer{"Importer"};
+    Module both{"Both"}, fnOnly{"FnOnly"}, unrelated{"Unrelated"};
+    LOC_TY loc;
+    Symbol a = Symbol::get("ImportConflictA"), b = Symbol::get("ImportConflictB");
+
+    first.userTypes.try_emplace(a, TypeDecl{AnType::getI32(), loc});
+    second.userTypes.try_emplace(a, TypeDecl{AnType::getBool(), loc});
+    second.fnDecls.try_emplace(b, nullptr);
+    both.userTypes.try_emplace(a, TypeDecl{AnType::getI32(), loc});
+    both.fnDecls.try_emplace(b, nullptr);
+    fnOnly.fnDecls.try_emplace(b, nullptr);
+    unrelated.userTypes.try_emplace(Symbol::get("ImportConflictC"), TypeDecl{AnType::getI32(), loc});
+
+    importer.addImport(&first);
+    importer.addImport(&second);
+
+    Symbol name;
+    REQUIRE(importer.findImportConflict(&both, name) == 0);
+    REQUIRE(name == a);
+    REQUIRE(importer.findImportConflict(&fnOnly, name) == 1);
+    REQUIRE(name == b);
+    REQUIRE(importer.findImportConflict(&unrelated, name) == importer.imports.size());
+
+    REQUIRE(importer.findImport("Second") == 1);
+    REQUIRE(importer.findImport("Unrelated") == importer.imports.size());
+}
+
+TEST_CASE("Submodules of imports are found through the import index", "[Module]"){
+    Module first{"First"}, second{"Second"}, importer{"Importer"};
+    Module &firstSub = first.addChild("Sub");
+    second.addChild("Sub");
+    Module &other = second.addChild("Other");
+
+    importer.addImport(&first);
+    importer.addImport(&second);
+
+    //The first import with a submodule of the given name is used
+    REQUIRE(importer.findImportedSubmodule("Sub") == &firstSub);
+    REQUIRE(importer.findImportedSubmodule("Other") == &other);
+    REQUIRE(!importer.findImportedSubmodule("First"));
+}
@@ -1,6 +1,7 @@
 #include "unittest.h"
 #include "ptree.h"
 #include "nameresolution.h"
+#include <thread>
 
 using namespace ante;
 using namespace parser;
@@ -150,6 +151,128 @@ TEST_CASE("Shadowing Resolution", "[nameResolution]"){
 }
 
 
+/**
+ * block
+ *     let var1 = 1
+ *     var1
+ * block
+ *     let var1 = 2
+ *     var1
+ */
+TEST_CASE("Sibling Scope Resolution", "[nameResolution]"){
+    LOC_TY loc;
+    auto seq = new SeqNode(loc);
+    VarNode *decls[2], *refs[2];
+
+    for(int i = 0; i < 2; i++){
+        auto innerSeq = new SeqNode(loc);
+        decls[i] = new VarNode(loc, "var1");
+        refs[i] = new VarNode(loc, "var1");
+
+        auto decl = new VarAssignNode(loc, decls[i], new IntLitNode(loc, std::to_string(i + 1), TT_I32), false);
+        decl->modifiers.emplace_back(new ModNode(loc, Tok_Let, nullptr));
+
+        innerSeq->sequence.emplace_back(decl);
+        innerSeq->sequence.emplace_back(refs[i]);
+        seq->sequence.emplace_back(new BlockNode(loc, innerSeq));
+    }
+
+    NameResolutionVisitor v{"SiblingScopeResolutionTest"};
+    seq->accept(v);
+
+    // Exiting the first block unbinds its var1, so the second may declare its own
+    REQUIRE(decls[0]->decl);
+    REQUIRE(decls[1]->decl);
+    REQUIRE(refs[0]->decl == decls[0]->decl);
+    REQUIRE(refs[1]->decl == decls[1]->decl);
+    REQUIRE(decls[0]->decl != decls[1]->decl);
+    delete seq;
+}
+
+/**
+ * let x = 1
+ * let y = 1
+ * block
+ *     let x = 2
+ *     block
+ *         let x = 3
+ *         let y = 3
+ *         x
+ *         y
+ *     x
+ *     y
+ *     block
+ *         let y = 4
+ *         y
+ *     y
+ * x
+ * y
+ */
+TEST_CASE("Nested Shadowing Restores Outer Bindings", "[nameResolution]"){
+    LOC_TY loc;
+    auto let = [&](SeqNode *seq, std::string const& name){
+        auto var = new VarNode(loc, name);
+        auto decl = new VarAssignNode(loc, var, new IntLitNode(loc, "0", TT_I32), false);
+        decl->modifiers.emplace_back(new ModNode(loc, Tok_Let, nullptr));
+        seq->sequence.emplace_back(decl);
+        return var;
+    };
+    auto ref = [&](SeqNode *seq, std::string const& name){
+        auto var = new VarNode(loc, name);
+        seq->sequence.emplace_back(var);
+        return var;
+    };
+
+    auto outer = new SeqNode(loc);
+    auto middle = new SeqNode(loc);
+    auto inner = new SeqNode(loc);
+    auto sibling = new SeqNode(loc);
+
+    auto x1 = let(outer, "x");
+    auto y1 = let(outer, "y");
+    outer->sequence.emplace_back(new BlockNode(loc, middle));
+    auto xOuter = ref(outer, "x");
+    auto yOuter = ref(outer, "y");
+
+    auto x2 = let(middle, "x");
+    middle->sequence.emplace_back(new BlockNode(loc, inner));
+    auto xMiddle = ref(middle, "x");
+    auto yMiddle = ref(middle, "y");
+    middle->sequence.emplace_back(new BlockNode(loc, sibling));
+    auto yAfterSibling = ref(middle, "y");
+
+    auto x3 = let(inner, "x");
+    auto y3 = let(inner, "y");
+    auto xInner = ref(inner, "x");
+    auto yInner = ref(inner, "y");
+
+    auto y4 = let(sibling, "y");
+    auto ySibling = ref(sibling, "y");
+
+    NameResolutionVisitor v{"NestedShadowingTest"};
+    outer->accept(v);
+
+    REQUIRE(xInner->decl == x3->decl);
+    REQUIRE(yInner->decl == y3->decl);
+
+    // Exiting the inner block pops its bindings, restoring those of the enclosing blocks
+    REQUIRE(xMiddle->decl == x2->decl);
+    REQUIRE(yMiddle->decl == y1->decl);
+
+    // A sibling block may shadow the same name again once the first is exited
+    REQUIRE(ySibling->decl == y4->decl);
+    REQUIRE(y4->decl != y3->decl);
+    REQUIRE(yAfterSibling->decl == y1->decl);
+
+    REQUIRE(xOuter->decl == x1->decl);
+    REQUIRE(yOuter->decl == y1->decl);
+
+    REQUIRE(x1->decl != x2->decl);
+    REQUIRE(x2->decl != x3->decl);
+    REQUIRE(y1->decl != y3->decl);
+    delete outer;
+}
+
 /**
  * fun func: i32 param1 param2 =
  *     if true then param1
@@ -176,7 +299,7 @@ TEST_CASE("Function Resolution", "[nameResolution]"){
 
     auto ifn = new IfNode(loc, cond, p1b, p2b);
 
-    auto fdn = new FuncDeclNode(loc, "func", nullptr, p1a, {}, ifn);
+    auto fdn = new FuncDeclNode(loc, Symbol::get("func"), nullptr, p1a, {}, ifn);
 
     root->funcs.emplace_back(fdn);
     auto funcA = new VarNode(loc, "func");
@@ -255,3 +378,62 @@ TEST_CASE("Array Type Resolution", "[typeResolution]"){
     /** Name resolution should not do unnecessary deep-resolving */
     REQUIRE(uszPtr->getType() == nullptr);
 }
+
+
+TEST_CASE("Symbol Interning", "[nameResolution]"){
+    Symbol a = Symbol::get("symbolInterningTest");
+    Symbol b = Symbol::get(std::string("symbolInterning") + "Test");
+    Symbol c = Symbol::get("symbolInterningTest2");
+
+    REQUIRE(a == b);
+    REQUIRE(a != c);
+    REQUIRE(a.c_str() == b.c_str());
+    REQUIRE(a.str() == "symbolInterningTest");
+    REQUIRE(c.c_str()[c.ref().size()] == '\0');
+
+    //The interned copy maps back to its symbol without being hashed again
+    REQUIRE(Symbol::fromInterned(a.c_str()) == a);
+    REQUIRE(Symbol::fromInterned(c.c_str()) == c);
+}
+
+
+TEST_CASE("Concurrent Symbol Interning", "[nameResolution]"){
+    const size_t threadCount = 8;
+    const size_t symbolCount = 4096;
+    std::vector<std::vector<Symbol>> symbols(threadCount);
+    std::vector<std::thread> threads;
+
+    for(size_t t = 0; t < threadCount; t++){
+        threads.emplace_back([&, t]{
+            for(size_t i = 0; i < symbolCount; i++)
+                symbols[t].push_back(Symbol::get("concurrentSymbol" + std::to_string(i)));
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+
+    //Each string is given one id no matter which shard or thread interned it first
+    for(size_t i = 0; i < symbolCount; i++){
+        for(size_t t = 1; t < threadCount; t++)
+            REQUIRE(symbols[t][i] == symbols[0][i]);
+        REQUIRE(symbols[0][i].str() == "concurrentSymbol" + std::to_string(i));
+    }
+}
+
+
+TEST_CASE("Import Scanning", "[nameResolution]"){
+    std::string src =
+        "import Vec\n"
+        "import Tests.Integration.FnDecl  // trailing comment\n"
+        "    import \"tests/integration/moduleLib.an\"\n"
+        "importer = 3\n"
+        "imports Vec\n"
+        "print \"import Str\"\n"
+        "import";
+
+    auto imports = scanImports(src.data(), src.data() + src.size());
+    REQUIRE(imports.size() == 3);
+    REQUIRE(imports[0] == "vec.an");
+    REQUIRE(imports[1] == "tests/integration/fnDecl.an");
+    REQUIRE(imports[2] == "tests/integration/moduleLib.an");
+}
@@ -0,0 +1,72 @@
+#include "unittest.h"
+#include "ptree.h"
+#include "nodearena.h"
+#include "sourcebuffer.h"
+#include "scopeguard.h"
+using namespace ante;
+using namespace ante::parser;
+using namespace std;
+
+/** Link count IntLitNodes into one list through their next pointers */
+static Node* makeList(size_t count){
+    LOC_TY loc;
+    Node *head = new IntLitNode(loc, "0", TT_I32);
+    Node *last = head;
+    for(size_t i = 1; i < count; i++){
+        last->next.reset(new IntLitNode(loc, to_string(i), TT_I32));
+        last = last->next.get();
+    }
+    return head;
+}
+
+/**
+ * A list this long overflowed the stack when each Node
+ * destroyed the rest of its list recursively.
+ */
+TEST_CASE("Long node lists are destroyed without recursion", "[parser]"){
+    const size_t count = 1000000;
+
+    SECTION("On the heap"){
+        delete makeList(count);
+    }
+
+    SECTION("In an arena"){
+        NodeArena arena;
+        {
+            TMP_SET(currentNodeArena, &arena);
+            delete makeList(count);
+        }
+        REQUIRE(arena.getBytesAllocated() >= count * sizeof(IntLitNode));
+    }
+}
+
+TEST_CASE("Each file's nodes are freed with its own arena", "[parser]"){
+    string firstSrc = "first x =\n    y = x + 1\n    y * 2\n";
+    string secondSrc = "second a b =\n    a + b\n";
+
+    ParseContext first{new Lexer(SourceBuffer::create("first.an", firstSrc))};
+    ParseContext second{new Lexer(SourceBuffer::create("second.an", secondSrc))};
+    REQUIRE(first.parse() == PE_OK);
+    REQUIRE(second.parse() == PE_OK);
+
+    RootNode *firstRoot = first.root;
+    RootNode *secondRoot = second.root;
+    REQUIRE(firstRoot->arena);
+    REQUIRE(secondRoot->arena);
+    REQUIRE(firstRoot->arena != secondRoot->arena);
+    REQUIRE(firstRoot->arena->getBytesAllocated() > 0);
+    REQUIRE(secondRoot->arena->getBytesAllocated() > 0);
+
+    //Nodes created outside of a parse are on the heap
+    REQUIRE(!currentNodeArena);
+
+    delete firstRoot;
+
+    //The second file's tree is untouched by freeing the first
+    REQUIRE(secondRoot->funcs.size() == 1);
+    auto *fn = dyn_cast<FuncDeclNode>(secondRoot->funcs[0].get());
+    REQUIRE(fn);
+    REQUIRE(fn->name == Symbol::get("second"));
+    REQUIRE(SourceBuffer::find(fn->loc.begin)->getName() == "second.an");
+    delete secondRoot;
+}
@@ -0,0 +1,127 @@
+#include "unittest.h"
+#include "ptree.h"
+using namespace ante;
+using namespace ante::parser;
+using namespace std;
+
+/** Require dyn_cast and isa to agree with dynamic_cast for the given class */
+template<typename T>
+static void checkCast(Node *n){
+    REQUIRE(dyn_cast<T>(n) == dynamic_cast<T*>(n));
+    REQUIRE(isa<T>(n) == (dynamic_cast<T*>(n) != nullptr));
+}
+
+template<typename... Ts>
+static void checkCasts(Node *n){
+    int checked[] = {(checkCast<Ts>(n), 0)...};
+    (void)checked;
+}
+
+TEST_CASE("dyn_cast agrees with dynamic_cast for every node class", "[parser]"){
+    LOC_TY loc;
+    vector<unique_ptr<Node>> nodes;
+    vector<unique_ptr<Node>> elems, noElems;
+    vector<unique_ptr<MatchBranchNode>> branches;
+    elems.emplace_back(new IntLitNode(loc, "0", TT_I32));
+
+    nodes.emplace_back(new RootNode(loc));
+    nodes.emplace_back(new IntLitNode(loc, "1", TT_I32));
+    nodes.emplace_back(new FltLitNode(loc, "1.0", TT_F64));
+    nodes.emplace_back(new BoolLitNode(loc, true));
+    nodes.emplace_back(new CharLitNode(loc, 'c'));
+    nodes.emplace_back(new StrLitNode(loc, "str"));
+    nodes.emplace_back(new ArrayNode(loc, elems));
+    nodes.emplace_back(new TupleNode(loc, noElems));
+    nodes.emplace_back(new UnOpNode(loc, '-', nullptr));
+    nodes.emplace_back(new BinOpNode(loc, '+', nullptr, nullptr));
+    nodes.emplace_back(new SeqNode(loc));
+    nodes.emplace_back(new BlockNode(loc, nullptr));
+    nodes.emplace_back(new ModNode(loc, Tok_Mut, nullptr));
+    nodes.emplace_back(new TypeNode(loc, TT_I32, "", nullptr));
+    nodes.emplace_back(new TypeCastNode(loc, nullptr, nullptr));
+    nodes.emplace_back(new RetNode(loc, nullptr));
+    nodes.emplace_back(new NamedValNode(loc, "x", nullptr));
+    nodes.emplace_back(new VarNode(loc, "x"));
+    nodes.emplace_back(new VarAssignNode(loc, nullptr, nullptr, false));
+    nodes.emplace_back(new ExtNode(loc, nullptr, nullptr, nullptr));
+    nodes.emplace_back(new ImportNode(loc, nullptr));
+    nodes.emplace_back(new JumpNode(loc, Tok_Break, nullptr));
+    nodes.emplace_back(new WhileNode(loc, nullptr, nullptr));
+    nodes.emplace_back(new ForNode(loc, nullptr, nullptr, nullptr));
+    nodes.emplace_back(new MatchBranchNode(loc, nullptr, nullptr));
+    nodes.emplace_back(new MatchNode(loc, nullptr, branches));
+    nodes.emplace_back(new IfNode(loc, nullptr, nullptr, nullptr));
+    nodes.emplace_back(new FuncDeclNode(loc, Symbol::get("f"), nullptr, nullptr, nullptr, nullptr));
+    nodes.emplace_back(new DataDeclNode(loc, "D", nullptr, 0, false));
+    nodes.emplace_back(new TraitNode(loc, Symbol::get("T"), {}, nullptr));
+
+    //One node of each kind
+    REQUIRE(nodes.size() == (size_t)NodeKind::Trait + 1);
+    for(size_t i = 0; i < nodes.size(); i++)
+        for(size_t j = 0; j < i; j++)
+            REQUIRE(nodes[i]->getKind() != nodes[j]->getKind());
+
+    for(auto &node : nodes){
+        INFO("Kind: " << (int)node->getKind());
+        checkCasts<RootNode, IntLitNode, FltLitNode, BoolLitNode, CharLitNode, StrLitNode,
+            ArrayNode, TupleNode, UnOpNode, BinOpNode, SeqNode, BlockNode, ModNode,
+            ModifiableNode, TypeNode, TypeCastNode, RetNode, NamedValNode, VarNode,
+            VarAssignNode, ExtNode, ImportNode, JumpNode, WhileNode, ForNode,
+            MatchBranchNode, MatchNode, IfNode, FuncDeclNode, DataDeclNode, TraitNode>(node.get());
+    }
+}
+
+/** Classify a pattern the way handlePattern does, by RTTI or by the node's kind */
+template<bool useKinds>
+static int classifyPattern(Node *pattern){
+    if(useKinds){
+        if(isa<TupleNode>(pattern)) return 0;
+        if(isa<TypeCastNode>(pattern)) return 1;
+        if(isa<TypeNode>(pattern)) return 2;
+        if(isa<VarNode>(pattern)) return 3;
+        if(isa<IntLitNode>(pattern)) return 4;
+        if(isa<FltLitNode>(pattern)) return 5;
+        if(isa<StrLitNode>(pattern)) return 6;
+    }else{
+        if(dynamic_cast<TupleNode*>(pattern)) return 0;
+        if(dynamic_cast<TypeCastNode*>(pattern)) return 1;
+        if(dynamic_cast<TypeNode*>(pattern)) return 2;
+        if(dynamic_cast<VarNode*>(pattern)) return 3;
+        if(dynamic_cast<IntLitNode*>(pattern)) return 4;
+        if(dynamic_cast<FltLitNode*>(pattern)) return 5;
+        if(dynamic_cast<StrLitNode*>(pattern)) return 6;
+    }
+    return -1;
+}
+
+/**
+ * Classify the patterns of a large generated match expression.
+ * Run with: antetests "[benchmark]"
+ */
+TEST_CASE("Node kind dispatch benchmark", "[.][benchmark]"){
+    LOC_TY loc;
+    vector<unique_ptr<Node>> patterns;
+    for(int i = 0; i < 100000; i++){
+        switch(i % 4){
+            case 0: patterns.emplace_back(new StrLitNode(loc, "str")); break;
+            case 1: patterns.emplace_back(new FltLitNode(loc, "1.0", TT_F64)); break;
+            case 2: patterns.emplace_back(new IntLitNode(loc, "1", TT_I32)); break;
+            case 3: patterns.emplace_back(new VarNode(loc, "x")); break;
+        }
+    }
+
+    for(auto &p : patterns)
+        REQUIRE(classifyPattern<true>(p.get()) == classifyPattern<false>(p.get()));
+
+    long rttiSum = 0, kindSum = 0;
+    BENCHMARK("Classify 100k patterns with dynamic_cast"){
+        for(auto &p : patterns)
+            rttiSum += classifyPattern<false>(p.get());
+    }
+
+    BENCHMARK("Classify 100k patterns with isa"){
+        for(auto &p : patterns)
+            kindSum += classifyPattern<true>(p.get());
+    }
+    REQUIRE(rttiSum == kindSum);
+}
@@ -0,0 +1,103 @@
+#include "unittest.h"
+#include "threadpool.h"
+#include "ptree.h"
+#include "sourcebuffer.h"
+#include "nameresolution.h"
+#include "typeinference.h"
+#include <atomic>
+using namespace ante;
+using namespace ante::parser;
+using namespace std;
+
+namespace ante { extern AnTypeContainer typeArena; }
+
+TEST_CASE("ThreadPool runs every task before wait returns", "[threadPool]"){
+    ThreadPool pool{4};
+    REQUIRE(pool.size() == 4);
+
+    atomic<size_t> ran{0};
+    for(size_t i = 0; i < 100; i++)
+        pool.async([&]{ ran++; });
+    pool.wait();
+    REQUIRE(ran == 100);
+
+    //Tasks queued from within a task are waited on as well
+    atomic<size_t> nested{0};
+    for(size_t i = 0; i < 10; i++){
+        pool.async([&]{
+            for(size_t j = 0; j < 10; j++)
+                pool.async([&]{ nested++; });
+        });
+    }
+    pool.wait();
+    REQUIRE(nested == 100);
+
+    //Waiting with nothing queued returns immediately
+    pool.wait();
+}
+
+TEST_CASE("ThreadPool finishes queued tasks when destroyed", "[threadPool]"){
+    atomic<size_t> ran{0};
+    {
+        ThreadPool pool{3};
+        for(size_t i = 0; i < 50; i++)
+            pool.async([&]{ ran++; });
+    }
+    REQUIRE(ran == 50);
+}
+
+/** Name resolve and type check the source with the given number of jobs,
+ *  returning every diagnostic issued in the order it would be shown */
+static string typeCheck(string const& src, size_t jobs){
+    ParseContext parseCtxt{new Lexer(SourceBuffer::create("parallel.an", src))};
+    REQUIRE(parseCtxt.parse() == PE_OK);
+    RootNode *root = parseCtxt.root;
+
+    DiagnosticBuffer buffer;
+    setDiagnosticBuffer(&buffer);
+    setCompilerJobs(jobs);
+    try{
+        NameResolutionVisitor v{"parallel"};
+        v.visit(root);
+        TypeInferenceVisitor::infer(root, v.compUnit);
+    }catch(CtError const&){}
+    setCompilerJobs(1);
+    setDiagnosticBuffer(nullptr);
+    delete root;
+    return buffer.out.str();
+}
+
+/**
+ * Many independent call graph components, some calling each other,
+ * some mutually recursive and some with type errors.
+ */
+TEST_CASE("Diagnostics are identical with and without -j", "[typeInference]"){
+    string src;
+    for(size_t k = 0; k < 16; k++){
+        string i = to_string(k);
+        src += "add" + i + " x = x + " + i + "\n\n";
+        src += "even" + i + " n = if n == 0 then true else odd" + i + " (n - 1)\n\n";
+        src += "odd" + i + " n = if n == 0 then false else even" + i + " (n - 1)\n\n";
+        src += "bad" + i + " () = not (add" + i + " " + i + ")\n\n";
+    }
+
+    string serial = typeCheck(src, 1);
+    REQUIRE(!serial.empty());
+    for(size_t jobs : {2, 4, 8}){
+        INFO("Jobs: " << jobs);
+        REQUIRE(typeCheck(src, jobs) == serial);
+    }
+}
+
+/** A REPL line defining independent functions is inferred with its nursery open */
+TEST_CASE("Functions are inferred serially while the nursery is open", "[typeInference]"){
+    string src = "first x = x + 1\n\nsecond y = not y\n\nthird z = first z\n\n";
+    string serial = typeCheck(src, 1);
+
+    typeArena.openNursery();
+    string withNursery = typeCheck(src, 4);
+    REQUIRE(typeArena.isNurseryOpen());
+    typeArena.collectNursery();
+
+    REQUIRE(withNursery == serial);
+}
@@ -0,0 +1,102 @@
+#include "unittest.h"
+#include "ptree.h"
+#include "antype.h"
+#include "sourcebuffer.h"
+#include <thread>
+using namespace ante;
+using namespace ante::parser;
+using namespace std;
+
+namespace ante { extern AnTypeContainer typeArena; }
+
+TEST_CASE("Separate files can be parsed concurrently", "[parser]"){
+    const size_t fileCount = 8;
+    vector<string> fileNames, sources;
+    for(size_t i = 0; i < fileCount; i++){
+        string src;
+        for(size_t j = 0; j <= i; j++){
+            string name = "fn" + to_string(i) + "_" + to_string(j);
+            src += name + " x y =\n    z = x + y\n    print \"" + name + "\" z\n\n";
+        }
+        fileNames.push_back("file" + to_string(i) + ".an");
+        sources.push_back(src);
+    }
+
+    vector<unique_ptr<ParseContext>> contexts;
+    for(size_t i = 0; i < fileCount; i++)
+        contexts.emplace_back(new ParseContext(new Lexer(SourceBuffer::create(fileNames[i], sources[i]))));
+
+    //Parameters without type annotations are given fresh typevars while parsing
+    vector<int> flags(fileCount);
+    vector<thread> threads;
+    typeArena.beginConcurrent();
+    for(size_t i = 0; i < fileCount; i++){
+        threads.emplace_back([&, i]{
+            flags[i] = contexts[i]->parse();
+            typeArena.flushTypeVars();
+        });
+    }
+    for(auto &t : threads)
+        t.join();
+    typeArena.endConcurrent();
+
+    for(size_t i = 0; i < fileCount; i++){
+        INFO("File: " << fileNames[i]);
+        REQUIRE(flags[i] == PE_OK);
+
+        RootNode *root = contexts[i]->root;
+        REQUIRE(root);
+        REQUIRE(root->funcs.size() == i + 1);
+        REQUIRE(contexts[i]->roots.empty());
+
+        for(size_t j = 0; j <= i; j++){
+            auto *fn = dyn_cast<FuncDeclNode>(root->funcs[j].get());
+            REQUIRE(fn);
+            REQUIRE(fn->name.str() == "fn" + to_string(i) + "_" + to_string(j));
+            REQUIRE(SourceBuffer::find(fn->loc.begin)->getName() == fileNames[i]);
+        }
+        delete root;
+    }
+}
+
+TEST_CASE("Source locations are traced back to their line and column", "[parser]"){
+    string src = "a = 1\n\n  bc = \"two\nlines\"\n";
+    SourceBuffer *source = SourceBuffer::create("locations.an", src);
+    Lexer lexer{source};
+
+    vector<pair<LineAndColumn, LineAndColumn>> idents;
+    yy::parser::location_type loc;
+    int tok;
+    while((tok = lexer.next(&loc))){
+        if(tok == Tok_Ident || tok == Tok_StrLit){
+            REQUIRE(SourceBuffer::find(loc.begin) == source);
+            idents.emplace_back(source->getLineAndColumn(loc.begin), source->getLineAndColumn(loc.end));
+        }
+    }
+
+    REQUIRE(idents.size() == 3);
+    REQUIRE(idents[0].first.line == 1);   REQUIRE(idents[0].first.column == 1);
+    REQUIRE(idents[1].first.line == 3);   REQUIRE(idents[1].first.column == 3);
+    REQUIRE(idents[1].second.column == 4);
+    REQUIRE(idents[2].first.line == 3);   REQUIRE(idents[2].second.line == 4);
+    REQUIRE(source->getLine(3) == "  bc = \"two");
+    REQUIRE(!SourceBuffer::find(SourceLoc()));
+}
+
+TEST_CASE("Released source buffers are no longer found", "[parser]"){
+    SourceBuffer *kept = SourceBuffer::create("kept.an", "a = 1\n");
+    SourceBuffer *line = SourceBuffer::create("", "b = 2\n");
+    SourceLoc keptLoc = kept->getLoc(kept->begin() + 1);
+    SourceLoc lineLoc = line->getLoc(line->begin() + 1);
+    REQUIRE(SourceBuffer::find(lineLoc) == line);
+
+    SourceBuffer::release(line);
+    REQUIRE(!SourceBuffer::find(lineLoc));
+    REQUIRE(SourceBuffer::find(keptLoc) == kept);
+
+    //Locations of a released buffer are never given to a new one
+    SourceBuffer *next = SourceBuffer::create("", "c = 3\n");
+    REQUIRE(!SourceBuffer::find(lineLoc));
+    REQUIRE(SourceBuffer::find(next->getLoc(next->begin())) == next);
+    SourceBuffer::release(next);
+}
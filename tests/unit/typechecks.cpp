@@ -1,6 +1,10 @@
 #include "unittest.h"
 #include "types.h"
 #include "unification.h"
+#include "trait.h"
+#include "traitimplindex.h"
+#include "module.h"
+#include "promotingvisitor.h"
 using namespace ante;
 using namespace std;
 
@@ -62,6 +66,30 @@ TEST_CASE("Type Checks", "[typeEq]"){
 
         //REQUIRE(mytype_isz == mytype_isz2);
     }
+
+    SECTION("'a = ref 't, 't = 'u, 'u = isz"){
+        auto a = AnTypeVarType::get("'a");
+        LOC_TY loc;
+
+        UnificationList unificationList;
+        TypeError noErr{"", loc};
+        unificationList.emplace_back(a, AnPtrType::get(t), noErr);
+        unificationList.emplace_back(t, u, noErr);
+        unificationList.emplace_back(u, intTy, noErr);
+        auto subs = ante::unify(unificationList);
+
+        // Each substitution should be fully resolved regardless of the order they were found in
+        REQUIRE(subs.size() == 3);
+
+        std::pair<AnType*,AnType*> expected = {a, intPtr};
+        REQUIRE(std::find(subs.begin(), subs.end(), expected) != subs.end());
+
+        std::pair<AnType*,AnType*> expected2 = {t, intTy};
+        REQUIRE(std::find(subs.begin(), subs.end(), expected2) != subs.end());
+
+        std::pair<AnType*,AnType*> expected3 = {u, intTy};
+        REQUIRE(std::find(subs.begin(), subs.end(), expected3) != subs.end());
+    }
 }
 
 TEST_CASE("Type Uniqueness", "[typeEq]"){
@@ -84,6 +112,192 @@ TEST_CASE("Type Uniqueness", "[typeEq]"){
     REQUIRE(empty_t != empty_u);
 
     REQUIRE(empty_t == empty_t2);
+
+    auto fn = AnFunctionType::get(AnType::getBool(), {t, AnType::getIsz()}, {});
+    REQUIRE(fn == AnFunctionType::get(AnType::getBool(), {t, AnType::getIsz()}, {}));
+    REQUIRE(fn != AnFunctionType::get(AnType::getBool(), {t, AnType::getIsz()}, {}, true));
+
+    auto tup = AnTupleType::get({fn, u});
+    REQUIRE(tup == AnTupleType::get({fn, u}));
+    REQUIRE(tup != AnTupleType::get({u, fn}));
+}
+
+TEST_CASE("Typevar Names", "[typeEq]"){
+    auto&& c = Compiler(nullptr);
+    auto fresh = AnTypeVarType::getFresh();
+    auto rho = AnTypeVarType::getFresh(true);
+
+    // A typevar written by the user with the name a fresh typevar would be given
+    string generated = "'" + to_string(fresh->id);
+    auto written = AnTypeVarType::get(generated);
+    REQUIRE(written != fresh);
+
+    // Naming the fresh typevar must not replace or share the user's name
+    REQUIRE(fresh->getName() != written->getName());
+    REQUIRE(AnTypeVarType::get(generated) == written);
+    REQUIRE(AnTypeVarType::get(fresh->getName()) == fresh);
+
+    // Names are stable once given and distinct between typevars
+    auto &name = fresh->getName();
+    REQUIRE(fresh->getName() == name);
+    REQUIRE(rho->getName() == "'" + to_string(rho->id) + "...");
+    REQUIRE(rho->getName() != name);
+    REQUIRE(AnTypeVarType::getFresh()->getName() != name);
+}
+
+TEST_CASE("Substitution Memo", "[typeEq]"){
+    auto&& c = Compiler(nullptr);
+    auto t = AnTypeVarType::get("'t");
+    auto u = AnTypeVarType::get("'u");
+    LOC_TY loc;
+    TypeError noErr{"", loc};
+
+    UnificationList unificationList;
+    unificationList.emplace_back(t, AnPtrType::get(u), noErr);
+    unificationList.emplace_back(u, AnType::getIsz(), noErr);
+    auto subs = ante::unify(unificationList);
+
+    SubstitutionMemo memo{subs};
+    auto fn = AnFunctionType::get(AnTupleType::get({t, u}), {t}, {});
+    REQUIRE(memo.apply(fn) == applySubstitutions(subs, fn));
+    REQUIRE(memo.apply(fn) == memo.apply(fn));
+
+    // Types without any substituted typevars are returned unchanged
+    auto v = AnTypeVarType::get("'v");
+    auto untouched = AnPtrType::get(v);
+    REQUIRE(memo.apply(untouched) == untouched);
+}
+
+/**
+ * Instantiate  (InstPair 't 'u, InstPair 'u 't, *'t) -> InstPair (InstPair 't 't) 'u
+ * where each typevar appears several times and within nested generic types.
+ */
+TEST_CASE("Instantiation By Typevar Summary", "[typeEq]"){
+    auto&& c = Compiler(nullptr);
+    auto a = AnTypeVarType::get("'instA");
+    auto b = AnTypeVarType::get("'instB");
+    auto t = AnTypeVarType::get("'t");
+    auto u = AnTypeVarType::get("'u");
+    auto i32 = AnType::getI32();
+
+    auto pair = AnProductType::create("InstPair", {a, b}, {a, b});
+    auto pair_tu = AnProductType::createVariant(pair, {t, u}, {t, u});
+    auto pair_ut = AnProductType::createVariant(pair, {u, t}, {u, t});
+    auto pair_tt = AnProductType::createVariant(pair, {t, t}, {t, t});
+    auto outer = AnProductType::createVariant(pair, {pair_tt, u}, {pair_tt, u});
+    auto fn = AnFunctionType::get(outer, {pair_tu, pair_ut, AnPtrType::get(t), i32}, {});
+    REQUIRE(fn->getContainedTypeVars().size() == 2);
+
+    auto inst = try_cast<AnFunctionType>(copyWithNewTypeVars(fn));
+    REQUIRE(inst);
+    auto t2 = try_cast<AnTypeVarType>(try_cast<AnPtrType>(inst->paramTys[2])->extTy);
+    auto u2 = try_cast<AnTypeVarType>(try_cast<AnProductType>(inst->paramTys[0])->typeArgs[1]);
+    REQUIRE(t2);
+    REQUIRE(u2);
+    REQUIRE(t2 != t);
+    REQUIRE(u2 != u);
+    REQUIRE(t2 != u2);
+
+    // Each occurrence of a typevar is replaced by the same fresh typevar
+    REQUIRE(inst == applySubstitutions({{t, t2}, {u, u2}}, fn));
+    REQUIRE(inst->getContainedTypeVars().size() == 2);
+    REQUIRE(inst->paramTys[3] == i32);
+
+    // Each instantiation gets its own typevars
+    auto inst2 = copyWithNewTypeVars(fn);
+    REQUIRE(inst2 != inst);
+    REQUIRE(inst2->getContainedTypeVars().size() == 2);
+
+    // Types without typevars, and the parts of a generic type without any, are kept
+    auto mixed = AnProductType::createVariant(pair, {i32, pair_tt}, {i32, pair_tt});
+    REQUIRE(copyWithNewTypeVars(i32) == i32);
+    REQUIRE(try_cast<AnProductType>(copyWithNewTypeVars(mixed))->typeArgs[0] == i32);
+}
+
+namespace ante { extern AnTypeContainer typeArena; }
+
+TEST_CASE("Nursery Collection", "[typeEq]"){
+    auto&& c = Compiler(nullptr);
+    auto intPtr = AnPtrType::get(AnType::getIsz());
+
+    typeArena.openNursery();
+    auto fn = AnFunctionType::get(AnTypeVarType::getFresh(), {intPtr}, {});
+    auto tup = AnTupleType::get({fn, intPtr});
+    AnTupleType::get({intPtr, fn});
+    typeArena.promote(tup);
+    typeArena.collectNursery();
+
+    // Promoted types and types created before the nursery was opened are still interned
+    REQUIRE(AnPtrType::get(AnType::getIsz()) == intPtr);
+    REQUIRE(AnTupleType::get({fn, intPtr}) == tup);
+    REQUIRE(AnFunctionType::get(fn->retTy, {intPtr}, {}) == fn);
+}
+
+TEST_CASE("Trait Impl Index", "[typeEq]"){
+    auto&& c = Compiler(nullptr);
+    auto t = AnTypeVarType::get("'t");
+    auto i32 = AnType::getI32();
+    auto boolTy = AnType::getBool();
+
+    auto index = AnProductType::create("Index", {}, {t});
+    auto index_i32 = AnProductType::createVariant(index, {}, {i32});
+
+    TraitImpl printI32{"Print", {i32}};
+    TraitImpl printIndex{"Print", {index}};
+    TraitImpl printAny{"Print", {t}};
+    TraitImpl printIndexI32{"Print", {index_i32}};
+
+    TraitImplIndex impls;
+    impls.add(&printI32);
+    impls.add(&printIndex);
+    impls.add(&printAny);
+    impls.add(&printIndexI32);
+
+    // The earliest impl added wins, as with a linear search
+    REQUIRE(impls.find({i32}) == &printI32);
+    REQUIRE(impls.find({index_i32}) == &printIndex);
+    REQUIRE(impls.find({boolTy}) == &printAny);
+    REQUIRE(impls.find({AnPtrType::get(boolTy)}) == &printAny);
+
+    // Argument lists of a different length never match
+    REQUIRE(impls.find({}) == nullptr);
+    REQUIRE(impls.find({i32, i32}) == nullptr);
+    REQUIRE(impls.getImpls().size() == 4);
+}
+
+/**
+ * Resolve an impl for a nursery type on one REPL line, collect the line's
+ * types, then look up impls for new types which may reuse its address.
+ */
+TEST_CASE("Resolved Impls Across Nursery Collection", "[typeEq]"){
+    auto&& c = Compiler(nullptr);
+    auto t = AnTypeVarType::get("'t");
+    auto box = AnProductType::create("ReplBox", {}, {t});
+    auto crate = AnProductType::create("ReplCrate", {}, {t});
+
+    Module module{"ReplImpls"};
+    TraitImpl printBox{"Print", {box}};
+    module.addTraitImpl(Symbol::get("Print"), &printBox);
+
+    typeArena.openNursery();
+    auto arg = AnTupleType::get({AnType::getU8(), AnPtrType::get(AnType::getIsz())});
+    auto boxArg = AnProductType::createVariant(box, {}, {arg});
+    REQUIRE(module.lookupTraitImpl("Print", {boxArg}) == &printBox);
+    PromotingVisitor::promoteModule(module);
+    typeArena.collectNursery();
+
+    // The memoized args were promoted so they are still interned
+    REQUIRE(AnProductType::createVariant(box, {}, {arg}) == boxArg);
+    REQUIRE(module.lookupTraitImpl("Print", {boxArg}) == &printBox);
+
+    typeArena.openNursery();
+    for(int i = 0; i < 64; i++){
+        auto elem = AnTupleType::get({AnType::getU8(), AnType::getI32(), AnType::getIsz()});
+        auto crateArg = AnProductType::createVariant(crate, {}, {AnArrayType::get(elem, i)});
+        REQUIRE(module.lookupTraitImpl("Print", {crateArg}) == nullptr);
+    }
+    PromotingVisitor::promoteModule(module);
+    typeArena.collectNursery();
 }
 
 /*
@@ -118,3 +332,34 @@ TEST_CASE("Datatype partial bindings"){
     REQUIRE(ta_tb->generics.size() == 1);
 }
  */
+
+/**
+ * Generate a module-sized list of 100,000 constraints of the form
+ * 'v1 = 'v0, 'v2 = 'v1, ..., 'v0 = i32 and check they are solved
+ * without exhausting the stack.
+ */
+TEST_CASE("Unification Stress", "[typeEq][stress]"){
+    auto&& c = Compiler(nullptr);
+    const size_t constraintCount = 100000;
+    LOC_TY loc;
+    TypeError noErr{"", loc};
+
+    std::vector<AnTypeVarType*> typeVars;
+    typeVars.reserve(constraintCount);
+    for(size_t i = 0; i < constraintCount; i++){
+        typeVars.push_back(nextTypeVar());
+    }
+
+    UnificationList unificationList;
+    for(size_t i = 1; i < constraintCount; i++){
+        unificationList.emplace_back(typeVars[i], typeVars[i - 1], noErr);
+    }
+    unificationList.emplace_back(typeVars[0], AnType::getI32(), noErr);
+
+    auto subs = ante::unify(unificationList);
+
+    REQUIRE(subs.size() == constraintCount);
+    for(auto &sub : subs){
+        REQUIRE(sub.second == AnType::getI32());
+    }
+}
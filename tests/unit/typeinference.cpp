@@ -0,0 +1,87 @@
+#include "unittest.h"
+#include "ptree.h"
+#include "sourcebuffer.h"
+#include "nameresolution.h"
+#include "typeinference.h"
+using namespace ante;
+using namespace ante::parser;
+using namespace std;
+
+/** Parse and name resolve the given source, returning its root and each of its top-level functions */
+static RootNode* resolve(string const& src, Module *&module, vector<FuncDeclNode*> &fns){
+    ParseContext parseCtxt{new Lexer(SourceBuffer::create("components.an", src))};
+    REQUIRE(parseCtxt.parse() == PE_OK);
+    RootNode *root = parseCtxt.root;
+
+    NameResolutionVisitor v{"components"};
+    v.visit(root);
+    module = v.compUnit;
+
+    for(auto &fn : root->funcs)
+        if(auto *fdn = dyn_cast<FuncDeclNode>(fn.get()))
+            fns.push_back(fdn);
+    return root;
+}
+
+/** Return the index of the component containing the function with the given name */
+static size_t componentOf(vector<vector<FuncDeclNode*>> const& components, string const& name){
+    for(size_t i = 0; i < components.size(); i++)
+        for(auto *fdn : components[i])
+            if(fdn->name.ref() == name)
+                return i;
+    FAIL("No component contains " << name);
+    return 0;
+}
+
+const string callGraphSrc =
+    "main () = useStr ()\n\n"
+    "useStr () = ping \"two\" 3\n\n"
+    "useInt () = ping (leaf 1) 3\n\n"
+    "ping x n = if n == 0 then x else pong x (n - 1)\n\n"
+    "pong x n = ping x n\n\n"
+    "leaf y = y\n\n";
+
+TEST_CASE("Call graph components are ordered callees first", "[typeInference]"){
+    auto&& c = Compiler(nullptr);
+    Module *module;
+    vector<FuncDeclNode*> fns;
+    RootNode *root = resolve(callGraphSrc, module, fns);
+    REQUIRE(fns.size() == 6);
+
+    auto components = findCallGraphComponents(fns);
+    REQUIRE(components.size() == 5);
+
+    size_t ping = componentOf(components, "ping");
+    REQUIRE(componentOf(components, "pong") == ping);
+    REQUIRE(components[ping].size() == 2);
+
+    REQUIRE(ping < componentOf(components, "useStr"));
+    REQUIRE(ping < componentOf(components, "useInt"));
+    REQUIRE(componentOf(components, "leaf") < componentOf(components, "useInt"));
+    REQUIRE(componentOf(components, "useStr") < componentOf(components, "main"));
+    delete root;
+}
+
+TEST_CASE("Mutually recursive functions are generalized together", "[typeInference]"){
+    auto&& c = Compiler(nullptr);
+    Module *module;
+    vector<FuncDeclNode*> fns;
+    RootNode *root = resolve(callGraphSrc, module, fns);
+
+    size_t errors = errorCount();
+    TypeInferenceVisitor::infer(root, module);
+    REQUIRE(errorCount() == errors);
+
+    // ping and pong are used at both Str and i32 so each must be generic in x
+    for(auto *fdn : fns){
+        if(fdn->name == Symbol::get("ping") || fdn->name == Symbol::get("pong")){
+            INFO("Function: " << fdn->name);
+            auto *fnTy = try_cast<AnFunctionType>(fdn->decl->tval.type);
+            REQUIRE(fnTy);
+            REQUIRE(fnTy->paramTys.size() == 2);
+            REQUIRE(try_cast<AnTypeVarType>(fnTy->paramTys[0]));
+            REQUIRE(fnTy->retTy == fnTy->paramTys[0]);
+        }
+    }
+    delete root;
+}